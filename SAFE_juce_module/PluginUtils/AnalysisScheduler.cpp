@@ -0,0 +1,52 @@
+AnalysisScheduler::AnalysisScheduler()
+    : pool (SAFE_ANALYSIS_SCHEDULER_THREADS > 0 ? SAFE_ANALYSIS_SCHEDULER_THREADS 
+                                                : jmax (1, SystemStats::getNumCpus())),
+      maxNumJobs (SAFE_ANALYSIS_SCHEDULER_MAX_JOBS)
+{
+}
+
+AnalysisScheduler::~AnalysisScheduler()
+{
+    pool.removeAllJobs (true, 4000);
+}
+
+bool AnalysisScheduler::addJob (ThreadPoolJob *job)
+{
+    const ScopedLock lock (queueLock);
+
+    if (pool.getNumJobs() >= maxNumJobs)
+    {
+        return false;
+    }
+
+    pool.addJob (job, false);
+
+    return true;
+}
+
+bool AnalysisScheduler::removeJob (ThreadPoolJob *job, int timeOutMilliseconds)
+{
+    return pool.removeJob (job, true, timeOutMilliseconds);
+}
+
+bool AnalysisScheduler::isJobPending (ThreadPoolJob *job) const
+{
+    return pool.contains (job);
+}
+
+CriticalSection& AnalysisScheduler::getFileLock (const File &file)
+{
+    const ScopedLock lock (fileLocksLock);
+
+    String path = file.getFullPathName();
+    int index = lockedFiles.indexOf (path);
+
+    if (index < 0)
+    {
+        lockedFiles.add (path);
+        fileLocks.add (new CriticalSection);
+        index = lockedFiles.size() - 1;
+    }
+
+    return *fileLocks [index];
+}
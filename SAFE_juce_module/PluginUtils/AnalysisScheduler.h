@@ -0,0 +1,66 @@
+#ifndef __ANALYSISSCHEDULER__
+#define __ANALYSISSCHEDULER__
+
+/**
+ *  A process-wide scheduler for saving analysed data.
+ *
+ *  Plug-ins hand their save jobs to this scheduler rather than each locking
+ *  out every other instance while they save. Jobs are run on a fixed number of
+ *  worker threads and the queue is bounded so a flood of saves can't pile up
+ *  indefinitely.
+ *
+ *  The number of workers and the size of the queue are set with the
+ *  SAFE_ANALYSIS_SCHEDULER_THREADS and SAFE_ANALYSIS_SCHEDULER_MAX_JOBS flags.
+ *
+ *  Use it through a SharedResourcePointer so all plug-in instances share it.
+ */
+class AnalysisScheduler
+{
+public:
+    /** Create a new scheduler. */
+    AnalysisScheduler();
+
+    /** Destructor */
+    ~AnalysisScheduler();
+
+    /** Add a job to the queue.
+     *
+     *  Returns false if the queue is already full, in which case the job will
+     *  not be run. The job is not deleted by the scheduler.
+     *
+     *  @param job  the job to run
+     */
+    bool addJob (ThreadPoolJob *job);
+
+    /** Remove a job from the queue, waiting for it to finish if it is running.
+     *
+     *  @param job                   the job to remove
+     *  @param timeOutMilliseconds   how long to wait for a running job to finish
+     */
+    bool removeJob (ThreadPoolJob *job, int timeOutMilliseconds);
+
+    /** Returns true if a job is waiting in the queue or being run. */
+    bool isJobPending (ThreadPoolJob *job) const;
+
+    /** Returns a lock to hold while writing to a file.
+     *
+     *  Jobs writing to different files can run at the same time, jobs writing
+     *  to the same file should hold this lock while they do.
+     *
+     *  @param file  the file which is going to be written to
+     */
+    CriticalSection& getFileLock (const File &file);
+
+private:
+    ThreadPool pool;
+    int maxNumJobs;
+    CriticalSection queueLock;
+
+    StringArray lockedFiles;
+    OwnedArray <CriticalSection> fileLocks;
+    CriticalSection fileLocksLock;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalysisScheduler)
+};
+
+#endif // __ANALYSISSCHEDULER__
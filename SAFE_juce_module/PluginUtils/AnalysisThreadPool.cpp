@@ -0,0 +1,30 @@
+AnalysisThreadPool::AnalysisThreadPool()
+    : pool (jmax (1, SystemStats::getNumCpus()))
+{
+}
+
+AnalysisThreadPool::~AnalysisThreadPool()
+{
+    pool.removeAllJobs (true, 4000);
+}
+
+void AnalysisThreadPool::runJobsAndWait (const OwnedArray <ThreadPoolJob> &jobs)
+{
+    int numJobs = jobs.size();
+
+    if (numJobs == 1)
+    {
+        jobs [0]->runJob();
+        return;
+    }
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        pool.addJob (jobs [i], false);
+    }
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        pool.waitForJobToFinish (jobs [i], -1);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef __ANALYSISTHREADPOOL__
+#define __ANALYSISTHREADPOOL__
+
+/**
+ *  A pool of threads shared by all the feature extractors in a process.
+ *
+ *  Use it through a SharedResourcePointer so every plug-in instance ends up
+ *  sharing the same set of threads rather than each spinning up its own.
+ */
+class AnalysisThreadPool
+{
+public:
+    /** Create a pool with one thread for each CPU. */
+    AnalysisThreadPool();
+
+    /** Destructor */
+    ~AnalysisThreadPool();
+
+    /** Run a batch of jobs on the pool and wait for them all to finish.
+     *
+     *  The jobs are run in parallel where there are threads free to run them.
+     *  A batch with a single job in it is just run on the calling thread.
+     *
+     *  This must not be called from one of the pool's own threads.
+     *
+     *  @param jobs  the jobs to run - these are still owned by the caller
+     */
+    void runJobsAndWait (const OwnedArray <ThreadPoolJob> &jobs);
+
+private:
+    ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalysisThreadPool)
+};
+
+#endif // __ANALYSISTHREADPOOL__
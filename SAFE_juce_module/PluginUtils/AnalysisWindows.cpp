@@ -0,0 +1,152 @@
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+AnalysisWindows::AnalysisWindows()
+    : type (Hann),
+      kaiserBeta (8.6),
+      windowingFunction (nullptr)
+{
+}
+
+AnalysisWindows::~AnalysisWindows()
+{
+}
+
+//==========================================================================
+//      Setup
+//==========================================================================
+void AnalysisWindows::setType (Type newType, double newKaiserBeta)
+{
+    // use setCustomFunction() for custom windows
+    jassert (newType != Custom || windowingFunction != nullptr);
+
+    type = newType;
+    kaiserBeta = newKaiserBeta;
+}
+
+void AnalysisWindows::setCustomFunction (void (*newWindowingFunction) (float*, int))
+{
+    windowingFunction = newWindowingFunction;
+    type = Custom;
+}
+
+//==========================================================================
+//      Getting Windows
+//==========================================================================
+const float* AnalysisWindows::getWindow (int size)
+{
+    const ScopedLock lock (tablesLock);
+
+    for (int i = 0; i < tables.size(); ++i)
+    {
+        WindowTable *table = tables [i];
+
+        if (table->type == type && table->size == size)
+        {
+            if ((type == Kaiser && table->kaiserBeta != kaiserBeta) ||
+                (type == Custom && table->windowingFunction != windowingFunction))
+            {
+                continue;
+            }
+
+            return table->data;
+        }
+    }
+
+    WindowTable *newTable = tables.add (new WindowTable);
+    newTable->type = type;
+    newTable->size = size;
+    newTable->kaiserBeta = kaiserBeta;
+    newTable->windowingFunction = windowingFunction;
+    newTable->data.allocate (size, false);
+
+    fillTable (*newTable);
+
+    return newTable->data;
+}
+
+void AnalysisWindows::applyWindow (float *data, const float *window, int numSamples)
+{
+    FloatVectorOperations::multiply (data, window, numSamples);
+}
+
+//==========================================================================
+//      Window Calculations
+//==========================================================================
+void AnalysisWindows::fillTable (WindowTable &table)
+{
+    float *data = table.data;
+    int size = table.size;
+    double denominator = jmax (1, size - 1);
+
+    switch (table.type)
+    {
+        case Hann:
+            for (int i = 0; i < size; ++i)
+            {
+                data [i] = (float) (0.5 * (1 - cos (2 * double_Pi * i / denominator)));
+            }
+
+            break;
+
+        case Hamming:
+            for (int i = 0; i < size; ++i)
+            {
+                data [i] = (float) (0.54 - 0.46 * cos (2 * double_Pi * i / denominator));
+            }
+
+            break;
+
+        case BlackmanHarris:
+            for (int i = 0; i < size; ++i)
+            {
+                double phase = 2 * double_Pi * i / denominator;
+
+                data [i] = (float) (0.35875 - 0.48829 * cos (phase)
+                                            + 0.14128 * cos (2 * phase)
+                                            - 0.01168 * cos (3 * phase));
+            }
+
+            break;
+
+        case Kaiser:
+        {
+            double normalisation = besselI0 (table.kaiserBeta);
+
+            for (int i = 0; i < size; ++i)
+            {
+                double position = 2 * i / denominator - 1;
+
+                data [i] = (float) (besselI0 (table.kaiserBeta * sqrt (1 - position * position)) / normalisation);
+            }
+
+            break;
+        }
+
+        case Custom:
+            FloatVectorOperations::fill (data, 1.0f, size);
+            table.windowingFunction (data, size);
+            break;
+    }
+}
+
+double AnalysisWindows::besselI0 (double x)
+{
+    // power series for the zeroth order modified bessel function of the first kind
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x / 2;
+
+    for (int k = 1; k < 50; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+
+        if (term < sum * 1.0e-12)
+        {
+            break;
+        }
+    }
+
+    return sum;
+}
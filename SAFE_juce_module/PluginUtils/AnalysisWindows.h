@@ -0,0 +1,97 @@
+#ifndef __ANALYSISWINDOWS__
+#define __ANALYSISWINDOWS__
+
+/**
+ *  A cache of window functions for the spectral analysis.
+ *
+ *  Rather than evaluating a window function on every frame the window is worked
+ *  out once for each frame size and kept in a table. Applying the window is then
+ *  just a vectorised multiply.
+ */
+class AnalysisWindows
+{
+public:
+    /** The types of window available. */
+    enum Type
+    {
+        Hann,
+        Hamming,
+        BlackmanHarris,
+        Kaiser,
+        Custom /**< a window given by a function passed to setCustomFunction() */
+    };
+
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a new window cache, using a Hann window. */
+    AnalysisWindows();
+
+    /** Destructor */
+    ~AnalysisWindows();
+
+    //==========================================================================
+    //      Setup
+    //==========================================================================
+    /** Set the type of window to use.
+     *
+     *  @param newType        the type of window
+     *  @param newKaiserBeta  the beta parameter for Kaiser windows
+     */
+    void setType (Type newType, double newKaiserBeta = 8.6);
+
+    /** Use a custom windowing function.
+     *
+     *  The function is run once over a frame of ones for each frame size
+     *  to build a table, so it should apply a window by multiplying the samples
+     *  it is given.
+     *
+     *  @param newWindowingFunction  the function to use - it should apply a window
+     *                               of length numSamples to the audioData
+     */
+    void setCustomFunction (void (*newWindowingFunction) (float*, int));
+
+    //==========================================================================
+    //      Getting Windows
+    //==========================================================================
+    /** Returns a table holding the current window for a given frame size.
+     *
+     *  The table is built the first time a size is asked for and stays valid
+     *  for the lifetime of this object.
+     *
+     *  @param size  the length of the window in samples
+     */
+    const float* getWindow (int size);
+
+    /** Apply a window from getWindow() to some audio.
+     *
+     *  @param data        the audio to apply the window to
+     *  @param window      the window to apply
+     *  @param numSamples  the length of the audio and the window
+     */
+    static void applyWindow (float *data, const float *window, int numSamples);
+
+private:
+    Type type;
+    double kaiserBeta;
+    void (*windowingFunction) (float*, int);
+
+    struct WindowTable
+    {
+        Type type;
+        int size;
+        double kaiserBeta;
+        void (*windowingFunction) (float*, int);
+        HeapBlock <float> data;
+    };
+
+    OwnedArray <WindowTable> tables;
+    CriticalSection tablesLock;
+
+    void fillTable (WindowTable &table);
+    static double besselI0 (double x);
+
+    JUCE_DECLARE_NON_COPYABLE (AnalysisWindows)
+};
+
+#endif // __ANALYSISWINDOWS__
@@ -0,0 +1,670 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace AudioFeatureBinaryFormatHelpers
+{
+    static const char magicNumber [4] = {'S', 'A', 'F', 'F'};
+    static const int headerSize = 16;
+
+    // version 2 added the padding which lines the columns up for memory mapped readers
+    static const int firstAlignedVersion = 2;
+
+    // version 3 added compressed values
+    static const int firstCompressedVersion = 3;
+
+    static int getPadding (int64 numBytes, int alignment)
+    {
+        return (int) ((alignment - numBytes % alignment) % alignment);
+    }
+
+    /** Returns false if a stream of known length has less than this left in it. */
+    static bool hasBytesRemaining (InputStream &stream, int64 numBytes)
+    {
+        const int64 numBytesRemaining = stream.getNumBytesRemaining();
+        return numBytesRemaining < 0 || numBytes <= numBytesRemaining;
+    }
+
+    /** The fewest bytes a column can take up, so a corrupt count can be caught
+     *  before anything is allocated for it. Compressed values take at least a
+     *  bit each.
+     */
+    static int64 getMinimumColumnSize (int numFeatures, int numValues, int valueType)
+    {
+        if (numFeatures == 0)
+        {
+            return 0;
+        }
+
+        const int64 indexSize = (3 * (int64) numFeatures + 1) * sizeof (int);
+
+        if (valueType == AudioFeatureBinaryFormat::CompressedValues)
+        {
+            return indexSize + sizeof (double) + sizeof (int) + numValues / 8;
+        }
+
+        return indexSize + (int64) numValues * AudioFeatureBinaryFormat::getValueSize (static_cast <AudioFeatureBinaryFormat::ValueType> (valueType));
+    }
+
+    /** The offsets have to start at 0, end at the number of values and never go backwards. */
+    static bool areValueOffsetsValid (const int *valueOffsets, int numFeatures, int numValues)
+    {
+        if (valueOffsets [0] != 0 || valueOffsets [numFeatures] != numValues)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < numFeatures; ++i)
+        {
+            if (valueOffsets [i + 1] < valueOffsets [i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool writePadding (OutputStream &stream, int numBytes)
+    {
+        static const char zeros [8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+        jassert (numBytes <= (int) sizeof (zeros));
+        return numBytes == 0 || stream.write (zeros, numBytes);
+    }
+
+    static bool writeInts (OutputStream &stream, const int *data, int numInts)
+    {
+       #if JUCE_LITTLE_ENDIAN
+        return stream.write (data, numInts * sizeof (int));
+       #else
+        for (int i = 0; i < numInts; ++i)
+        {
+            if (! stream.writeInt (data [i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+       #endif
+    }
+
+    static bool readInts (InputStream &stream, int *data, int numInts)
+    {
+        int numBytes = numInts * sizeof (int);
+
+        if (stream.read (data, numBytes) != numBytes)
+        {
+            return false;
+        }
+
+       #if JUCE_BIG_ENDIAN
+        for (int i = 0; i < numInts; ++i)
+        {
+            data [i] = (int) ByteOrder::swap ((uint32) data [i]);
+        }
+       #endif
+
+        return true;
+    }
+
+    static bool writeValues (OutputStream &stream, const double *values, int numValues, AudioFeatureBinaryFormat::ValueType valueType)
+    {
+        if (valueType == AudioFeatureBinaryFormat::Float64Values)
+        {
+           #if JUCE_LITTLE_ENDIAN
+            return stream.write (values, numValues * sizeof (double));
+           #else
+            for (int i = 0; i < numValues; ++i)
+            {
+                if (! stream.writeDouble (values [i]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+           #endif
+        }
+
+        // convert to floats a chunk at a time
+        const int chunkSize = 1024;
+        float chunk [chunkSize];
+
+        for (int start = 0; start < numValues; start += chunkSize)
+        {
+            int numInChunk = jmin (chunkSize, numValues - start);
+
+            for (int i = 0; i < numInChunk; ++i)
+            {
+                chunk [i] = (float) values [start + i];
+            }
+
+           #if JUCE_LITTLE_ENDIAN
+            if (! stream.write (chunk, numInChunk * sizeof (float)))
+            {
+                return false;
+            }
+           #else
+            for (int i = 0; i < numInChunk; ++i)
+            {
+                if (! stream.writeFloat (chunk [i]))
+                {
+                    return false;
+                }
+            }
+           #endif
+        }
+
+        return true;
+    }
+
+    static bool readValues (InputStream &stream, double *values, int numValues, AudioFeatureBinaryFormat::ValueType valueType)
+    {
+        if (valueType == AudioFeatureBinaryFormat::Float64Values)
+        {
+            int numBytes = numValues * sizeof (double);
+
+            if (stream.read (values, numBytes) != numBytes)
+            {
+                return false;
+            }
+
+           #if JUCE_BIG_ENDIAN
+            for (int i = 0; i < numValues; ++i)
+            {
+                uint64 swapped = ByteOrder::swap (*reinterpret_cast <uint64*> (values + i));
+                memcpy (values + i, &swapped, sizeof (double));
+            }
+           #endif
+
+            return true;
+        }
+
+        const int chunkSize = 1024;
+        float chunk [chunkSize];
+
+        for (int start = 0; start < numValues; start += chunkSize)
+        {
+            int numInChunk = jmin (chunkSize, numValues - start);
+            int numBytes = numInChunk * sizeof (float);
+
+            if (stream.read (chunk, numBytes) != numBytes)
+            {
+                return false;
+            }
+
+            for (int i = 0; i < numInChunk; ++i)
+            {
+               #if JUCE_BIG_ENDIAN
+                uint32 swapped = ByteOrder::swap (*reinterpret_cast <uint32*> (chunk + i));
+                memcpy (chunk + i, &swapped, sizeof (float));
+               #endif
+
+                values [start + i] = chunk [i];
+            }
+        }
+
+        return true;
+    }
+}
+
+int AudioFeatureBinaryFormat::getValueSize (ValueType valueType)
+{
+    // compressed values don't have a fixed size
+    jassert (valueType != CompressedValues);
+
+    return valueType == Float64Values ? (int) sizeof (double) : (int) sizeof (float);
+}
+
+//==========================================================================
+//      Feature Set Info
+//==========================================================================
+AudioFeatureBinaryFormat::FeatureSetInfo::FeatureSetInfo()
+    : frameSize (0),
+      stepSize (0),
+      channel (-1),
+      precision (0.0)
+{
+}
+
+File AudioFeatureBinaryFormat::getMetaDataFile (const File &featureFile)
+{
+    return featureFile.withFileExtension ("xml");
+}
+
+//==========================================================================
+//      Writer
+//==========================================================================
+AudioFeatureBinaryFormat::Writer::Writer()
+{
+}
+
+void AudioFeatureBinaryFormat::Writer::addFeatureSet (const FeatureSetInfo &info, const AudioFeatureColumn &features)
+{
+    featureSetInfos.add (info);
+    featureSets.add (features);
+}
+
+bool AudioFeatureBinaryFormat::Writer::write (OutputStream &stream, ValueType valueType) const
+{
+    using namespace AudioFeatureBinaryFormatHelpers;
+
+    int numFeatureSets = featureSets.size();
+    int64 numBytesWritten = headerSize;
+
+    // header
+    bool ok = stream.write (magicNumber, sizeof (magicNumber))
+           && stream.writeInt (currentVersion)
+           && stream.writeInt (valueType)
+           && stream.writeInt (numFeatureSets);
+
+    // dictionary
+    for (int i = 0; ok && i < numFeatureSets; ++i)
+    {
+        const FeatureSetInfo &info = featureSetInfos.getReference (i);
+        const AudioFeatureColumn &features = featureSets.getReference (i);
+        const int numFeatures = features.size();
+
+        const char *name = info.name.toRawUTF8();
+        int nameLength = (int) info.name.getNumBytesAsUTF8();
+        int namePadding = getPadding (nameLength, 4);
+
+        ok = stream.writeInt (nameLength)
+          && stream.write (name, nameLength)
+          && writePadding (stream, namePadding)
+          && stream.writeInt (info.frameSize)
+          && stream.writeInt (info.stepSize)
+          && stream.writeInt (info.channel)
+          && stream.writeInt (numFeatures)
+          && stream.writeInt (numFeatures > 0 ? features.getValueOffsets() [numFeatures] : 0);
+
+        numBytesWritten += 6 * sizeof (int) + nameLength + namePadding;
+    }
+
+    // columns
+    for (int i = 0; ok && i < numFeatureSets; ++i)
+    {
+        const AudioFeatureColumn &features = featureSets.getReference (i);
+        const int numFeatures = features.size();
+
+        if (numFeatures == 0)
+        {
+            continue;
+        }
+
+        const int numValues = features.getValueOffsets() [numFeatures];
+
+        // the values start on an 8 byte boundary
+        numBytesWritten += (3 * numFeatures + 1) * sizeof (int);
+        const int valuePadding = getPadding (numBytesWritten, 8);
+
+        ok = writeInts (stream, features.getTimeStamps(), numFeatures)
+          && writeInts (stream, features.getDurations(), numFeatures)
+          && writeInts (stream, features.getValueOffsets(), numFeatures + 1)
+          && writePadding (stream, valuePadding);
+
+        numBytesWritten += valuePadding;
+
+        if (valueType != CompressedValues)
+        {
+            ok = ok && writeValues (stream, features.getValues (0), numValues, valueType);
+            numBytesWritten += numValues * getValueSize (valueType);
+            continue;
+        }
+
+        // compressed values have their quantisation step and size first
+        const double step = getQuantisationStep (i);
+        const MemoryOutputStream *compressed = getCompressedValues (i);
+        const int numValueBytes = compressed != nullptr ? (int) compressed->getDataSize() : numValues * (int) sizeof (float);
+        const int compressedPadding = getPadding (numValueBytes, 4);
+
+        ok = ok && stream.writeDouble (step)
+                && stream.writeInt (numValueBytes)
+                && (compressed != nullptr ? stream.write (compressed->getData(), compressed->getDataSize())
+                                          : writeValues (stream, features.getValues (0), numValues, Float32Values))
+                && writePadding (stream, compressedPadding);
+
+        numBytesWritten += sizeof (double) + sizeof (int) + numValueBytes + compressedPadding;
+    }
+
+    return ok;
+}
+
+int64 AudioFeatureBinaryFormat::Writer::getNumBytes (ValueType valueType) const
+{
+    using namespace AudioFeatureBinaryFormatHelpers;
+
+    // magic number, version, value type and number of feature sets
+    int64 numBytes = headerSize;
+
+    for (int i = 0; i < featureSets.size(); ++i)
+    {
+        // dictionary entry
+        const int nameLength = (int) featureSetInfos.getReference (i).name.getNumBytesAsUTF8();
+        numBytes += 6 * sizeof (int) + nameLength + getPadding (nameLength, 4);
+    }
+
+    for (int i = 0; i < featureSets.size(); ++i)
+    {
+        const AudioFeatureColumn &features = featureSets.getReference (i);
+        const int numFeatures = features.size();
+
+        if (numFeatures == 0)
+        {
+            continue;
+        }
+
+        const int numValues = features.getValueOffsets() [numFeatures];
+
+        numBytes += (3 * numFeatures + 1) * sizeof (int);
+        numBytes += getPadding (numBytes, 8);
+
+        if (valueType != CompressedValues)
+        {
+            numBytes += numValues * getValueSize (valueType);
+            continue;
+        }
+
+        const MemoryOutputStream *compressed = getCompressedValues (i);
+        const int numValueBytes = compressed != nullptr ? (int) compressed->getDataSize() : numValues * (int) sizeof (float);
+
+        numBytes += sizeof (double) + sizeof (int) + numValueBytes + getPadding (numValueBytes, 4);
+    }
+
+    return numBytes;
+}
+
+double AudioFeatureBinaryFormat::Writer::getQuantisationStep (int index) const
+{
+    // rounding to the nearest step keeps the error within half a step
+    return 2.0 * jmax (0.0, featureSetInfos.getReference (index).precision);
+}
+
+const MemoryOutputStream* AudioFeatureBinaryFormat::Writer::getCompressedValues (int index) const
+{
+    const double step = getQuantisationStep (index);
+
+    if (step <= 0.0)
+    {
+        return nullptr;
+    }
+
+    // the values are compressed the first time they are asked for, which is
+    // usually when the size of the features is needed before they are written
+    while (compressedValues.size() <= index)
+    {
+        compressedValues.add (nullptr);
+    }
+
+    if (compressedValues [index] == nullptr)
+    {
+        MemoryOutputStream *compressed = new MemoryOutputStream();
+        FeatureValueCodec::encode (featureSets.getReference (index), step, *compressed);
+        compressedValues.set (index, compressed);
+    }
+
+    return compressedValues [index];
+}
+
+bool AudioFeatureBinaryFormat::Writer::writeToFile (const File &file, ValueType valueType, const XmlElement *metaData) const
+{
+    file.deleteFile();
+
+    {
+        FileOutputStream stream (file);
+
+        if (stream.failedToOpen() || ! write (stream, valueType))
+        {
+            return false;
+        }
+
+        stream.flush();
+    }
+
+    if (metaData != nullptr)
+    {
+        return metaData->writeToFile (getMetaDataFile (file), String::empty);
+    }
+
+    return true;
+}
+
+//==========================================================================
+//      Reader
+//==========================================================================
+AudioFeatureBinaryFormat::Reader::Reader()
+{
+}
+
+bool AudioFeatureBinaryFormat::Reader::read (InputStream &stream)
+{
+    using namespace AudioFeatureBinaryFormatHelpers;
+
+    clear();
+
+    // header
+    char magic [4];
+
+    if (stream.read (magic, sizeof (magic)) != sizeof (magic) || memcmp (magic, magicNumber, sizeof (magic)) != 0)
+    {
+        return false;
+    }
+
+    int version = stream.readInt();
+    int valueType = stream.readInt();
+    int numFeatureSets = stream.readInt();
+
+    if (version < 1 || version > currentVersion 
+        || (valueType != Float32Values && valueType != Float64Values
+            && (valueType != CompressedValues || version < firstCompressedVersion))
+        || numFeatureSets < 0 || stream.isExhausted())
+    {
+        return false;
+    }
+
+    // older versions have no padding
+    const bool aligned = version >= firstAlignedVersion;
+    int64 numBytesRead = headerSize;
+
+    // dictionary
+    Array <int> numFeatures, numValues;
+    int64 minimumColumnsSize = 0;
+
+    for (int i = 0; i < numFeatureSets; ++i)
+    {
+        int nameLength = stream.readInt();
+
+        if (nameLength < 0 || stream.isExhausted() || ! hasBytesRemaining (stream, nameLength))
+        {
+            clear();
+            return false;
+        }
+
+        HeapBlock <char> nameData ((size_t) nameLength + 1, true);
+
+        if (stream.read (nameData, nameLength) != nameLength)
+        {
+            clear();
+            return false;
+        }
+
+        FeatureSetInfo info;
+
+        if (aligned)
+        {
+            stream.skipNextBytes (getPadding (nameLength, 4));
+        }
+
+        info.name = String::fromUTF8 (nameData, nameLength);
+        info.frameSize = stream.readInt();
+        info.stepSize = stream.readInt();
+        info.channel = stream.readInt();
+
+        int setNumFeatures = stream.readInt();
+        int setNumValues = stream.readInt();
+
+        // the values of a column have to fit in an int's worth of bytes
+        if (setNumFeatures < 0 || setNumValues < 0 || stream.isExhausted()
+            || setNumValues > std::numeric_limits <int>::max() / (int) sizeof (double)
+            || (setNumFeatures == 0 && setNumValues != 0))
+        {
+            clear();
+            return false;
+        }
+
+        // don't trust the counts until there's room in the stream for them
+        minimumColumnsSize += getMinimumColumnSize (setNumFeatures, setNumValues, valueType);
+
+        if (! hasBytesRemaining (stream, minimumColumnsSize))
+        {
+            clear();
+            return false;
+        }
+
+        numBytesRead += 6 * sizeof (int) + nameLength + (aligned ? getPadding (nameLength, 4) : 0);
+
+        featureSetInfos.add (info);
+        numFeatures.add (setNumFeatures);
+        numValues.add (setNumValues);
+
+        int valuesPerFeature = setNumFeatures > 0 ? (int) (((int64) setNumValues + setNumFeatures - 1) / setNumFeatures) : 0;
+        store.addColumn (setNumFeatures, valuesPerFeature);
+    }
+
+    store.allocate();
+
+    // columns - these are read straight into the store
+    for (int i = 0; i < numFeatureSets; ++i)
+    {
+        int setNumFeatures = numFeatures [i];
+        int setNumValues = numValues [i];
+
+        AudioFeatureStore::ColumnData column = store.fillColumn (i, setNumFeatures, setNumValues);
+
+        if (setNumFeatures == 0)
+        {
+            continue;
+        }
+
+        numBytesRead += (3 * setNumFeatures + 1) * sizeof (int);
+        const int valuePadding = aligned ? getPadding (numBytesRead, 8) : 0;
+
+        bool ok = readInts (stream, column.timeStamps, setNumFeatures)
+               && readInts (stream, column.durations, setNumFeatures)
+               && readInts (stream, column.valueOffsets, setNumFeatures + 1)
+               && areValueOffsetsValid (column.valueOffsets, setNumFeatures, setNumValues);
+
+        if (ok)
+        {
+            stream.skipNextBytes (valuePadding);
+            numBytesRead += valuePadding;
+
+            if (valueType == CompressedValues)
+            {
+                ok = readCompressedValues (stream, i, column, setNumFeatures, numBytesRead);
+            }
+            else
+            {
+                ok = readValues (stream, column.values, setNumValues, static_cast <ValueType> (valueType));
+                numBytesRead += setNumValues * getValueSize (static_cast <ValueType> (valueType));
+            }
+        }
+
+        if (! ok)
+        {
+            clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AudioFeatureBinaryFormat::Reader::readCompressedValues (InputStream &stream, int index,
+                                                             const AudioFeatureStore::ColumnData &column, int numFeatures,
+                                                             int64 &numBytesRead)
+{
+    using namespace AudioFeatureBinaryFormatHelpers;
+
+    const double step = stream.readDouble();
+    const int numValueBytes = stream.readInt();
+    const int numValues = column.valueOffsets [numFeatures];
+
+    if (! (step >= 0.0) || numValueBytes < 0 || numValueBytes > stream.getNumBytesRemaining())
+    {
+        return false;
+    }
+
+    featureSetInfos.getReference (index).precision = step / 2.0;
+
+    bool ok;
+
+    if (step == 0.0)
+    {
+        // values without a precision are kept as floats
+        ok = numValueBytes == numValues * (int) sizeof (float)
+          && readValues (stream, column.values, numValues, Float32Values);
+    }
+    else
+    {
+        HeapBlock <char> compressed ((size_t) numValueBytes);
+
+        ok = stream.read (compressed, numValueBytes) == numValueBytes
+          && FeatureValueCodec::decode (compressed, (size_t) numValueBytes, step,
+                                        column.valueOffsets, numFeatures, column.values);
+    }
+
+    stream.skipNextBytes (getPadding (numValueBytes, 4));
+    numBytesRead += sizeof (double) + sizeof (int) + numValueBytes + getPadding (numValueBytes, 4);
+
+    return ok;
+}
+
+bool AudioFeatureBinaryFormat::Reader::readFromFile (const File &file)
+{
+    {
+        FileInputStream stream (file);
+
+        if (stream.failedToOpen() || ! read (stream))
+        {
+            return false;
+        }
+    }
+
+    File metaDataFile = getMetaDataFile (file);
+
+    if (metaDataFile.existsAsFile())
+    {
+        metaData = XmlDocument::parse (metaDataFile);
+    }
+
+    return true;
+}
+
+int AudioFeatureBinaryFormat::Reader::getNumFeatureSets() const
+{
+    return featureSetInfos.size();
+}
+
+const AudioFeatureBinaryFormat::FeatureSetInfo& AudioFeatureBinaryFormat::Reader::getFeatureSetInfo (int index) const
+{
+    return featureSetInfos.getReference (index);
+}
+
+AudioFeatureColumn AudioFeatureBinaryFormat::Reader::getFeatures (int index) const
+{
+    return store.getColumn (index);
+}
+
+const XmlElement* AudioFeatureBinaryFormat::Reader::getMetaData() const
+{
+    return metaData;
+}
+
+void AudioFeatureBinaryFormat::Reader::clear()
+{
+    featureSetInfos.clear();
+    store.removeAllColumns();
+    metaData = nullptr;
+}
@@ -0,0 +1,189 @@
+#ifndef __AUDIOFEATUREBINARYFORMAT__
+#define __AUDIOFEATUREBINARYFORMAT__
+
+/**
+ *  A compact binary format for extracted audio features.
+ *
+ *  A file starts with a header, then a dictionary describing each feature set,
+ *  then the raw columns of each feature set in the same order as the dictionary.
+ *  Everything is little endian.
+ *
+ *  Header:
+ *      4 bytes     magic number "SAFF"
+ *      int32       format version
+ *      int32       value type - 0 for float32 values, 1 for float64 values,
+ *                  2 for compressed values
+ *      int32       number of feature sets
+ *
+ *  Dictionary entry:
+ *      int32       length of the name in bytes, followed by the name in UTF-8
+ *                  padded to a 4 byte boundary
+ *      int32       frame size
+ *      int32       step size
+ *      int32       channel number, -1 for features not tied to a channel
+ *      int32       number of features
+ *      int32       total number of values
+ *
+ *  Columns:
+ *      int32       time stamps in milliseconds, one per feature
+ *      int32       durations in milliseconds, one per feature
+ *      int32       value offsets, one per feature plus one for the end
+ *      padding up to an 8 byte boundary from the start of the header
+ *      float       values, as float32 or float64
+ *
+ *  Compressed values, which replace the values above:
+ *      float64     quantisation step, 0 if the values are stored as float32
+ *      int32       size of the values in bytes
+ *      the values compressed with a FeatureValueCodec, or as float32
+ *      padding up to a 4 byte boundary
+ *
+ *  The padding, added in version 2, keeps every column aligned so the format
+ *  can be read in place from a memory mapped file. Version 1 had no padding.
+ *  Compressed values were added in version 3. They can't be read in place.
+ *
+ *  Any metadata goes in an xml sidecar file next to the binary file.
+ */
+class AudioFeatureBinaryFormat
+{
+public:
+    /** The types the values can be stored as. */
+    enum ValueType
+    {
+        Float32Values = 0,
+        Float64Values = 1,
+        CompressedValues = 2    /**< values are compressed to the precision of their feature set */
+    };
+
+    /** The version of the format written. */
+    static const int currentVersion = 3;
+
+    /** Returns the number of bytes each value takes up, for the uncompressed types. */
+    static int getValueSize (ValueType valueType);
+
+    /** A description of a set of features. */
+    struct FeatureSetInfo
+    {
+        FeatureSetInfo();
+
+        String name;
+        int frameSize;
+        int stepSize;
+        int channel;
+
+        /** The largest error allowed in compressed values, 0 keeps them as float32. */
+        double precision;
+    };
+
+    /** Returns the xml sidecar file which goes with a feature file. */
+    static File getMetaDataFile (const File &featureFile);
+
+    //==========================================================================
+    //      Writer
+    //==========================================================================
+    /** Writes features in the binary format. */
+    class Writer
+    {
+    public:
+        /** Create a writer with no features. */
+        Writer();
+
+        /** Add a set of features to write.
+         *
+         *  The features are not copied so the store they belong to must not
+         *  change until they have been written.
+         *
+         *  @param info      a description of the features
+         *  @param features  the features
+         */
+        void addFeatureSet (const FeatureSetInfo &info, const AudioFeatureColumn &features);
+
+        /** Write the features to a stream.
+         *
+         *  With CompressedValues each feature set is compressed to the precision
+         *  in its FeatureSetInfo. The compression is only done once, the first
+         *  time write() or getNumBytes() needs it.
+         *
+         *  @param stream     the stream to write to
+         *  @param valueType  the type to store the values as
+         *
+         *  @return true if everything was written successfully
+         */
+        bool write (OutputStream &stream, ValueType valueType = Float64Values) const;
+
+        /** Returns the number of bytes write() will produce.
+         *
+         *  @param valueType  the type the values will be stored as
+         */
+        int64 getNumBytes (ValueType valueType = Float64Values) const;
+
+        /** Write the features to a file.
+         *
+         *  @param file       the file to write to - this will be replaced
+         *  @param valueType  the type to store the values as
+         *  @param metaData   some metadata to write to the xml sidecar file, or
+         *                    nullptr for no sidecar
+         *
+         *  @return true if everything was written successfully
+         */
+        bool writeToFile (const File &file, ValueType valueType = Float64Values, const XmlElement *metaData = nullptr) const;
+
+    private:
+        Array <FeatureSetInfo> featureSetInfos;
+        Array <AudioFeatureColumn> featureSets;
+        mutable OwnedArray <MemoryOutputStream> compressedValues;
+
+        double getQuantisationStep (int index) const;
+        const MemoryOutputStream* getCompressedValues (int index) const;
+
+        JUCE_DECLARE_NON_COPYABLE (Writer)
+    };
+
+    //==========================================================================
+    //      Reader
+    //==========================================================================
+    /** Reads features in the binary format. */
+    class Reader
+    {
+    public:
+        /** Create a reader with no features. */
+        Reader();
+
+        /** Read features from a stream.
+         *
+         *  @return false if the stream didn't hold valid features
+         */
+        bool read (InputStream &stream);
+
+        /** Read features from a file, along with the xml sidecar if there is one.
+         *
+         *  @return false if the file didn't hold valid features
+         */
+        bool readFromFile (const File &file);
+
+        /** Returns the number of feature sets read. */
+        int getNumFeatureSets() const;
+
+        /** Returns the description of a feature set. */
+        const FeatureSetInfo& getFeatureSetInfo (int index) const;
+
+        /** Returns the features in a feature set. */
+        AudioFeatureColumn getFeatures (int index) const;
+
+        /** Returns the metadata from the xml sidecar, or nullptr if there wasn't one. */
+        const XmlElement* getMetaData() const;
+
+    private:
+        Array <FeatureSetInfo> featureSetInfos;
+        AudioFeatureStore store;
+        ScopedPointer <XmlElement> metaData;
+
+        bool readCompressedValues (InputStream &stream, int index,
+                                   const AudioFeatureStore::ColumnData &column, int numFeatures,
+                                   int64 &numBytesRead);
+        void clear();
+
+        JUCE_DECLARE_NON_COPYABLE (Reader)
+    };
+};
+
+#endif // __AUDIOFEATUREBINARYFORMAT__
@@ -0,0 +1,245 @@
+//==========================================================================
+//      Column Views
+//==========================================================================
+AudioFeatureColumn::AudioFeatureColumn()
+    : numFeatures (0),
+      timeStamps (nullptr),
+      durations (nullptr),
+      valueOffsets (nullptr),
+      values (nullptr)
+{
+}
+
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+AudioFeatureStore::AudioFeatureStore()
+{
+}
+
+AudioFeatureStore::~AudioFeatureStore()
+{
+}
+
+//==========================================================================
+//      Setup
+//==========================================================================
+void AudioFeatureStore::removeAllColumns()
+{
+    columns.clear();
+    blocks.clear();
+}
+
+int AudioFeatureStore::addColumn (int expectedNumFeatures, int valuesPerFeature)
+{
+    Column newColumn;
+    newColumn.expectedNumFeatures = jmax (1, expectedNumFeatures);
+    newColumn.valuesPerFeature = jmax (1, valuesPerFeature);
+    newColumn.numFeatures = 0;
+    newColumn.featureCapacity = 0;
+    newColumn.valueCapacity = 0;
+    newColumn.timeStamps = nullptr;
+    newColumn.durations = nullptr;
+    newColumn.valueOffsets = nullptr;
+    newColumn.values = nullptr;
+
+    // columns added after the store has been allocated can be used straight away
+    if (blocks.size() > 0)
+    {
+        allocateColumn (newColumn, newColumn.expectedNumFeatures, newColumn.expectedNumFeatures * newColumn.valuesPerFeature);
+    }
+
+    columns.add (newColumn);
+
+    return columns.size() - 1;
+}
+
+void AudioFeatureStore::allocate()
+{
+    size_t totalSize = 0;
+
+    for (int i = 0; i < columns.size(); ++i)
+    {
+        const Column &column = columns.getReference (i);
+        totalSize += getColumnSize (column.expectedNumFeatures, column.expectedNumFeatures * column.valuesPerFeature);
+    }
+
+    blocks.clear();
+
+    Block *firstBlock = blocks.add (new Block);
+    firstBlock->data.allocate (totalSize, false);
+    firstBlock->size = totalSize;
+    firstBlock->used = 0;
+
+    clear();
+}
+
+int AudioFeatureStore::getNumColumns() const
+{
+    return columns.size();
+}
+
+//==========================================================================
+//      Features
+//==========================================================================
+void AudioFeatureStore::clear()
+{
+    resetArena();
+
+    for (int i = 0; i < columns.size(); ++i)
+    {
+        Column &column = columns.getReference (i);
+        allocateColumn (column, column.expectedNumFeatures, column.expectedNumFeatures * column.valuesPerFeature);
+    }
+}
+
+double* AudioFeatureStore::addFeature (int column, int timeStamp, int duration, int numValues)
+{
+    Column &currentColumn = columns.getReference (column);
+    int index = currentColumn.numFeatures;
+    int valueOffset = currentColumn.valueOffsets [index];
+
+    if (index == currentColumn.featureCapacity || valueOffset + numValues > currentColumn.valueCapacity)
+    {
+        growColumn (currentColumn, valueOffset + numValues);
+    }
+
+    currentColumn.timeStamps [index] = timeStamp;
+    currentColumn.durations [index] = duration;
+    currentColumn.valueOffsets [index + 1] = valueOffset + numValues;
+    ++currentColumn.numFeatures;
+
+    return currentColumn.values + valueOffset;
+}
+
+AudioFeatureColumn AudioFeatureStore::getColumn (int column) const
+{
+    const Column &currentColumn = columns.getReference (column);
+
+    AudioFeatureColumn view;
+    view.numFeatures = currentColumn.numFeatures;
+    view.timeStamps = currentColumn.timeStamps;
+    view.durations = currentColumn.durations;
+    view.valueOffsets = currentColumn.valueOffsets;
+    view.values = currentColumn.values;
+
+    return view;
+}
+
+AudioFeatureStore::ColumnData AudioFeatureStore::fillColumn (int column, int numFeatures, int numValues)
+{
+    Column &currentColumn = columns.getReference (column);
+
+    if (numFeatures > currentColumn.featureCapacity || numValues > currentColumn.valueCapacity)
+    {
+        allocateColumn (currentColumn, jmax (1, numFeatures), jmax (1, numValues));
+    }
+
+    currentColumn.numFeatures = numFeatures;
+
+    ColumnData data;
+    data.timeStamps = currentColumn.timeStamps;
+    data.durations = currentColumn.durations;
+    data.valueOffsets = currentColumn.valueOffsets;
+    data.values = currentColumn.values;
+
+    return data;
+}
+
+//==========================================================================
+//      Arena
+//==========================================================================
+void* AudioFeatureStore::allocateFromArena (size_t numBytes)
+{
+    // keep everything aligned for the doubles
+    numBytes = (numBytes + 15) & ~((size_t) 15);
+
+    Block *currentBlock = blocks.getLast();
+
+    if (currentBlock == nullptr || currentBlock->used + numBytes > currentBlock->size)
+    {
+        size_t newBlockSize = numBytes;
+
+        if (currentBlock != nullptr)
+        {
+            newBlockSize = jmax (numBytes, currentBlock->size);
+        }
+
+        currentBlock = blocks.add (new Block);
+        currentBlock->data.allocate (newBlockSize, false);
+        currentBlock->size = newBlockSize;
+        currentBlock->used = 0;
+    }
+
+    void *memory = currentBlock->data + currentBlock->used;
+    currentBlock->used += numBytes;
+
+    return memory;
+}
+
+void AudioFeatureStore::resetArena()
+{
+    // if the first block wasn't big enough last time replace all the blocks
+    // with one that is
+    if (blocks.size() > 1)
+    {
+        size_t totalSize = 0;
+
+        for (int i = 0; i < blocks.size(); ++i)
+        {
+            totalSize += blocks [i]->size;
+        }
+
+        blocks.clear();
+
+        Block *newBlock = blocks.add (new Block);
+        newBlock->data.allocate (totalSize, false);
+        newBlock->size = totalSize;
+    }
+
+    if (blocks.size() > 0)
+    {
+        blocks [0]->used = 0;
+    }
+}
+
+void AudioFeatureStore::allocateColumn (Column &column, int featureCapacity, int valueCapacity)
+{
+    column.timeStamps = static_cast <int*> (allocateFromArena (featureCapacity * sizeof (int)));
+    column.durations = static_cast <int*> (allocateFromArena (featureCapacity * sizeof (int)));
+    column.valueOffsets = static_cast <int*> (allocateFromArena ((featureCapacity + 1) * sizeof (int)));
+    column.values = static_cast <double*> (allocateFromArena (valueCapacity * sizeof (double)));
+
+    column.numFeatures = 0;
+    column.featureCapacity = featureCapacity;
+    column.valueCapacity = valueCapacity;
+    column.valueOffsets [0] = 0;
+}
+
+void AudioFeatureStore::growColumn (Column &column, int minimumValueCapacity)
+{
+    Column oldColumn = column;
+
+    int newFeatureCapacity = column.featureCapacity * 2;
+    int newValueCapacity = jmax (column.valueCapacity * 2, minimumValueCapacity);
+
+    allocateColumn (column, newFeatureCapacity, newValueCapacity);
+
+    int numFeatures = oldColumn.numFeatures;
+    int numValues = oldColumn.valueOffsets [numFeatures];
+
+    memcpy (column.timeStamps, oldColumn.timeStamps, numFeatures * sizeof (int));
+    memcpy (column.durations, oldColumn.durations, numFeatures * sizeof (int));
+    memcpy (column.valueOffsets, oldColumn.valueOffsets, (numFeatures + 1) * sizeof (int));
+    memcpy (column.values, oldColumn.values, numValues * sizeof (double));
+
+    column.numFeatures = numFeatures;
+}
+
+size_t AudioFeatureStore::getColumnSize (int featureCapacity, int valueCapacity)
+{
+    // allow for the padding added by allocateFromArena()
+    return (featureCapacity * sizeof (int) + 15) * 2 
+         + ((featureCapacity + 1) * sizeof (int) + 15) 
+         + (valueCapacity * sizeof (double) + 15);
+}
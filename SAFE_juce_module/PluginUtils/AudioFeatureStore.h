@@ -0,0 +1,179 @@
+#ifndef __AUDIOFEATURESTORE__
+#define __AUDIOFEATURESTORE__
+
+/**
+ *  A read only view of one column of an AudioFeatureStore.
+ *
+ *  Views are cheap to copy and stay valid until the store they came from is
+ *  cleared or has more features added to the column.
+ */
+class AudioFeatureColumn
+{
+public:
+    /** Create an empty column. */
+    AudioFeatureColumn();
+
+    /** Returns the number of features in the column. */
+    int size() const                                { return numFeatures; }
+
+    /** Returns the time stamp of a feature in milliseconds. */
+    int getTimeStamp (int index) const              { return timeStamps [index]; }
+
+    /** Returns the duration of a feature in milliseconds. */
+    int getDuration (int index) const               { return durations [index]; }
+
+    /** Returns the number of values a feature has. */
+    int getNumValues (int index) const              { return valueOffsets [index + 1] - valueOffsets [index]; }
+
+    /** Returns the values of a feature. */
+    const double* getValues (int index) const       { return values + valueOffsets [index]; }
+
+    /** Returns the time stamps of all the features in the column. */
+    const int* getTimeStamps() const                { return timeStamps; }
+
+    /** Returns the durations of all the features in the column. */
+    const int* getDurations() const                 { return durations; }
+
+    /** Returns the offsets of each feature's values, with one extra for the end. */
+    const int* getValueOffsets() const              { return valueOffsets; }
+
+private:
+    friend class AudioFeatureStore;
+
+    int numFeatures;
+    const int *timeStamps;
+    const int *durations;
+    const int *valueOffsets;
+    const double *values;
+};
+
+//==========================================================================
+/**
+ *  A store for audio features.
+ *
+ *  Features are kept in columns - one for each feature on each channel. Each
+ *  column keeps its time stamps, durations and values in contiguous arrays. The
+ *  arrays are carved out of a single arena which is sized up front from the
+ *  number of frames expected, so gathering features doesn't hit the heap for
+ *  every frame.
+ *
+ *  A store should only be written to by one thread at a time.
+ */
+class AudioFeatureStore
+{
+public:
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create an empty store. */
+    AudioFeatureStore();
+
+    /** Destructor */
+    ~AudioFeatureStore();
+
+    //==========================================================================
+    //      Setup
+    //==========================================================================
+    /** Remove all the columns from the store. */
+    void removeAllColumns();
+
+    /** Add a new column to the store.
+     *
+     *  If the store has already been allocated the column gets its memory from
+     *  the arena straight away, otherwise it waits for allocate().
+     *
+     *  @param expectedNumFeatures  the number of features expected in the column
+     *  @param valuesPerFeature     the number of values expected for each feature
+     *
+     *  @return the index of the new column
+     */
+    int addColumn (int expectedNumFeatures, int valuesPerFeature);
+
+    /** Allocate the memory for the columns which have been added. 
+     *
+     *  This also clears any features in the store.
+     */
+    void allocate();
+
+    /** Returns the number of columns in the store. */
+    int getNumColumns() const;
+
+    //==========================================================================
+    //      Features
+    //==========================================================================
+    /** Remove all the features from the store without freeing any memory. */
+    void clear();
+
+    /** Add a feature to a column.
+     *
+     *  If the column is full it grows, falling back on the heap if the arena
+     *  has run out.
+     *
+     *  @param column     the column to add the feature to
+     *  @param timeStamp  the time stamp of the feature in milliseconds
+     *  @param duration   the duration of the feature in milliseconds
+     *  @param numValues  the number of values the feature has
+     *
+     *  @return a pointer to write the feature's values to
+     */
+    double* addFeature (int column, int timeStamp, int duration, int numValues);
+
+    /** Returns a view of a column. */
+    AudioFeatureColumn getColumn (int column) const;
+
+    /** Raw pointers to the arrays of a column. */
+    struct ColumnData
+    {
+        int *timeStamps;
+        int *durations;
+        int *valueOffsets;  /**< numFeatures + 1 offsets into the values */
+        double *values;
+    };
+
+    /** Fill in a whole column in one go.
+     *
+     *  The column is cleared and made big enough to hold the given number of
+     *  features and values, all of which must then be written to the arrays
+     *  returned.
+     *
+     *  @param column       the column to fill in
+     *  @param numFeatures  the number of features the column will hold
+     *  @param numValues    the total number of values the features will have
+     */
+    ColumnData fillColumn (int column, int numFeatures, int numValues);
+
+private:
+    struct Column
+    {
+        int expectedNumFeatures, valuesPerFeature;
+
+        int numFeatures, featureCapacity, valueCapacity;
+        int *timeStamps;
+        int *durations;
+        int *valueOffsets;
+        double *values;
+    };
+
+    Array <Column> columns;
+
+    // the arena - any memory needed beyond the first block goes into extra
+    // blocks which are merged into the first when the store is next cleared
+    struct Block
+    {
+        HeapBlock <char> data;
+        size_t size, used;
+    };
+
+    OwnedArray <Block> blocks;
+
+    void* allocateFromArena (size_t numBytes);
+    void resetArena();
+    void allocateColumn (Column &column, int featureCapacity, int valueCapacity);
+    void growColumn (Column &column, int minimumValueCapacity);
+
+    static size_t getColumnSize (int featureCapacity, int valueCapacity);
+
+    JUCE_DECLARE_NON_COPYABLE (AudioFeatureStore)
+};
+
+#endif // __AUDIOFEATURESTORE__
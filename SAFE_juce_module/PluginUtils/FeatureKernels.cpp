@@ -0,0 +1,295 @@
+void FeatureKernels::magnitudeSpectrum (const float *interleavedSpectrum, double *magnitudes, int numBins)
+{
+    int bin = 0;
+
+   #if SAFE_USE_SSE_INTRINSICS
+    for (; bin <= numBins - 4; bin += 4)
+    {
+        __m128 lowBins = _mm_loadu_ps (interleavedSpectrum + 2 * bin);
+        __m128 highBins = _mm_loadu_ps (interleavedSpectrum + 2 * bin + 4);
+
+        lowBins = _mm_mul_ps (lowBins, lowBins);
+        highBins = _mm_mul_ps (highBins, highBins);
+
+        // separate the squared real and imaginary parts and add them
+        __m128 realParts = _mm_shuffle_ps (lowBins, highBins, _MM_SHUFFLE (2, 0, 2, 0));
+        __m128 imagParts = _mm_shuffle_ps (lowBins, highBins, _MM_SHUFFLE (3, 1, 3, 1));
+        __m128 binMagnitudes = _mm_sqrt_ps (_mm_add_ps (realParts, imagParts));
+
+        _mm_storeu_pd (magnitudes + bin, _mm_cvtps_pd (binMagnitudes));
+        _mm_storeu_pd (magnitudes + bin + 2, _mm_cvtps_pd (_mm_movehl_ps (binMagnitudes, binMagnitudes)));
+    }
+   #elif SAFE_USE_NEON_INTRINSICS
+    for (; bin <= numBins - 4; bin += 4)
+    {
+        // vld2q splits the real and imaginary parts for us
+        float32x4x2_t bins = vld2q_f32 (interleavedSpectrum + 2 * bin);
+
+        float32x4_t powers = vmulq_f32 (bins.val [0], bins.val [0]);
+        powers = vmlaq_f32 (powers, bins.val [1], bins.val [1]);
+        float32x4_t binMagnitudes = vsqrtq_f32 (powers);
+
+        vst1q_f64 (magnitudes + bin, vcvt_f64_f32 (vget_low_f32 (binMagnitudes)));
+        vst1q_f64 (magnitudes + bin + 2, vcvt_high_f64_f32 (binMagnitudes));
+    }
+   #endif
+
+    for (; bin < numBins; ++bin)
+    {
+        float realPart = interleavedSpectrum [2 * bin];
+        float imagPart = interleavedSpectrum [2 * bin + 1];
+
+        magnitudes [bin] = std::sqrt (realPart * realPart + imagPart * imagPart);
+    }
+}
+
+void FeatureKernels::temporalStatistics (const float *data, int numSamples, TemporalStatistics &results)
+{
+    double sum = 0, sumOfSquares = 0;
+    float peak = 0;
+    int numZeroCrossings = 0;
+
+    if (numSamples > 0)
+    {
+        sum = data [0];
+        sumOfSquares = (double) data [0] * data [0];
+        peak = std::abs (data [0]);
+    }
+
+    // each sample is compared with the one before it for the zero crossings
+    int i = 1;
+
+   #if SAFE_USE_SSE_INTRINSICS
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signMask = _mm_set1_ps (-0.0f);
+    __m128d sumLow = _mm_setzero_pd(), sumHigh = _mm_setzero_pd();
+    __m128d squaresLow = _mm_setzero_pd(), squaresHigh = _mm_setzero_pd();
+    __m128 peaks = _mm_setzero_ps();
+    __m128i crossings = _mm_setzero_si128();
+
+    for (; i <= numSamples - 4; i += 4)
+    {
+        __m128 samples = _mm_loadu_ps (data + i);
+        __m128 previousSamples = _mm_loadu_ps (data + i - 1);
+
+        __m128d low = _mm_cvtps_pd (samples);
+        __m128d high = _mm_cvtps_pd (_mm_movehl_ps (samples, samples));
+
+        sumLow = _mm_add_pd (sumLow, low);
+        sumHigh = _mm_add_pd (sumHigh, high);
+        squaresLow = _mm_add_pd (squaresLow, _mm_mul_pd (low, low));
+        squaresHigh = _mm_add_pd (squaresHigh, _mm_mul_pd (high, high));
+
+        peaks = _mm_max_ps (peaks, _mm_andnot_ps (signMask, samples));
+
+        // a crossing is where the signs differ and neither sample is zero
+        __m128 signsDiffer = _mm_xor_ps (_mm_cmplt_ps (samples, zero), _mm_cmplt_ps (previousSamples, zero));
+        __m128 nonZero = _mm_and_ps (_mm_cmpneq_ps (samples, zero), _mm_cmpneq_ps (previousSamples, zero));
+
+        // the comparison masks are -1 where true
+        crossings = _mm_sub_epi32 (crossings, _mm_castps_si128 (_mm_and_ps (signsDiffer, nonZero)));
+    }
+
+    double sums [2], squares [2];
+    float peakLanes [4];
+    int crossingLanes [4];
+
+    _mm_storeu_pd (sums, _mm_add_pd (sumLow, sumHigh));
+    _mm_storeu_pd (squares, _mm_add_pd (squaresLow, squaresHigh));
+    _mm_storeu_ps (peakLanes, peaks);
+    _mm_storeu_si128 ((__m128i*) crossingLanes, crossings);
+
+    sum += sums [0] + sums [1];
+    sumOfSquares += squares [0] + squares [1];
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        peak = jmax (peak, peakLanes [lane]);
+        numZeroCrossings += crossingLanes [lane];
+    }
+   #elif SAFE_USE_NEON_INTRINSICS
+    const float32x4_t zero = vdupq_n_f32 (0.0f);
+    float64x2_t sumLow = vdupq_n_f64 (0.0), sumHigh = vdupq_n_f64 (0.0);
+    float64x2_t squaresLow = vdupq_n_f64 (0.0), squaresHigh = vdupq_n_f64 (0.0);
+    float32x4_t peaks = zero;
+    uint32x4_t crossings = vdupq_n_u32 (0);
+
+    for (; i <= numSamples - 4; i += 4)
+    {
+        float32x4_t samples = vld1q_f32 (data + i);
+        float32x4_t previousSamples = vld1q_f32 (data + i - 1);
+
+        float64x2_t low = vcvt_f64_f32 (vget_low_f32 (samples));
+        float64x2_t high = vcvt_high_f64_f32 (samples);
+
+        sumLow = vaddq_f64 (sumLow, low);
+        sumHigh = vaddq_f64 (sumHigh, high);
+        squaresLow = vfmaq_f64 (squaresLow, low, low);
+        squaresHigh = vfmaq_f64 (squaresHigh, high, high);
+
+        peaks = vmaxq_f32 (peaks, vabsq_f32 (samples));
+
+        // a crossing is where the signs differ and neither sample is zero
+        uint32x4_t signsDiffer = veorq_u32 (vcltq_f32 (samples, zero), vcltq_f32 (previousSamples, zero));
+        uint32x4_t nonZero = vandq_u32 (vmvnq_u32 (vceqq_f32 (samples, zero)),
+                                        vmvnq_u32 (vceqq_f32 (previousSamples, zero)));
+
+        // the comparison masks are all ones where true
+        crossings = vsubq_u32 (crossings, vandq_u32 (signsDiffer, nonZero));
+    }
+
+    sum += vaddvq_f64 (vaddq_f64 (sumLow, sumHigh));
+    sumOfSquares += vaddvq_f64 (vaddq_f64 (squaresLow, squaresHigh));
+    peak = jmax (peak, vmaxvq_f32 (peaks));
+    numZeroCrossings += (int) vaddvq_u32 (crossings);
+   #endif
+
+    for (; i < numSamples; ++i)
+    {
+        float sample = data [i];
+        float previousSample = data [i - 1];
+
+        sum += sample;
+        sumOfSquares += (double) sample * sample;
+        peak = jmax (peak, std::abs (sample));
+
+        if ((sample < 0) != (previousSample < 0) && sample != 0 && previousSample != 0)
+        {
+            ++numZeroCrossings;
+        }
+    }
+
+    if (numSamples == 0)
+    {
+        results.mean = results.variance = results.standardDeviation = 0;
+        results.rmsAmplitude = results.zeroCrossingRate = 0;
+        results.peak = 0;
+        return;
+    }
+
+    results.mean = sum / numSamples;
+
+    // libxtract uses the sample variance
+    double sumOfSquaredDeviations = jmax (0.0, sumOfSquares - sum * results.mean);
+    results.variance = numSamples > 1 ? sumOfSquaredDeviations / (numSamples - 1) : 0;
+
+    results.standardDeviation = std::sqrt (results.variance);
+    results.rmsAmplitude = std::sqrt (sumOfSquares / numSamples);
+    results.zeroCrossingRate = (double) numZeroCrossings / numSamples;
+    results.peak = peak;
+}
+
+void FeatureKernels::spectralMoments (const double *spectrum, int numBins, SpectralMoments &results)
+{
+    const double *amplitudes = spectrum;
+    const double *frequencies = spectrum + numBins;
+
+    // sums of amplitude * frequency ^ n for n = 0 to 4
+    double sums [5] = {0, 0, 0, 0, 0};
+    int bin = 0;
+
+   #if SAFE_USE_SSE_INTRINSICS
+    __m128d powerSums [5];
+
+    for (int i = 0; i < 5; ++i)
+    {
+        powerSums [i] = _mm_setzero_pd();
+    }
+
+    for (; bin <= numBins - 2; bin += 2)
+    {
+        __m128d amplitude = _mm_loadu_pd (amplitudes + bin);
+        __m128d frequency = _mm_loadu_pd (frequencies + bin);
+
+        __m128d term = amplitude;
+        powerSums [0] = _mm_add_pd (powerSums [0], term);
+
+        for (int i = 1; i < 5; ++i)
+        {
+            term = _mm_mul_pd (term, frequency);
+            powerSums [i] = _mm_add_pd (powerSums [i], term);
+        }
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+        double lanes [2];
+        _mm_storeu_pd (lanes, powerSums [i]);
+        sums [i] = lanes [0] + lanes [1];
+    }
+   #elif SAFE_USE_NEON_INTRINSICS
+    float64x2_t powerSums [5];
+
+    for (int i = 0; i < 5; ++i)
+    {
+        powerSums [i] = vdupq_n_f64 (0.0);
+    }
+
+    for (; bin <= numBins - 2; bin += 2)
+    {
+        float64x2_t amplitude = vld1q_f64 (amplitudes + bin);
+        float64x2_t frequency = vld1q_f64 (frequencies + bin);
+
+        float64x2_t term = amplitude;
+        powerSums [0] = vaddq_f64 (powerSums [0], term);
+
+        for (int i = 1; i < 5; ++i)
+        {
+            term = vmulq_f64 (term, frequency);
+            powerSums [i] = vaddq_f64 (powerSums [i], term);
+        }
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+        sums [i] = vaddvq_f64 (powerSums [i]);
+    }
+   #endif
+
+    for (; bin < numBins; ++bin)
+    {
+        double term = amplitudes [bin];
+        sums [0] += term;
+
+        for (int i = 1; i < 5; ++i)
+        {
+            term *= frequencies [bin];
+            sums [i] += term;
+        }
+    }
+
+    // libxtract gives a centroid of zero for an empty spectrum
+    double centroid = sums [0] == 0 ? 0 : sums [1] / sums [0];
+    double centroid2 = centroid * centroid;
+    double centroid3 = centroid2 * centroid;
+    double centroid4 = centroid3 * centroid;
+
+    // expand the central moments in terms of the power sums
+    double secondMoment = sums [2] - 2 * centroid * sums [1] + centroid2 * sums [0];
+    double thirdMoment = sums [3] - 3 * centroid * sums [2] + 3 * centroid2 * sums [1] - centroid3 * sums [0];
+    double fourthMoment = sums [4] - 4 * centroid * sums [3] + 6 * centroid2 * sums [2] 
+                        - 4 * centroid3 * sums [1] + centroid4 * sums [0];
+
+    results.centroid = centroid;
+
+    // the expansion cancels the large power sums against each other, so when all the
+    // energy is at one frequency, as in a peak spectrum with a single peak, the second
+    // moment comes out as rounding noise either side of zero rather than zero itself
+    if (sums [0] == 0 || secondMoment <= 1.0e-12 * sums [2])
+    {
+        results.variance = 0;
+        results.standardDeviation = 0;
+        results.skewness = 0;
+        results.kurtosis = 0;
+        return;
+    }
+
+    results.variance = secondMoment / sums [0];
+    results.standardDeviation = std::sqrt (results.variance);
+
+    // like libxtract, the higher moments aren't normalised by the total amplitude
+    double standardDeviation3 = results.standardDeviation * results.variance;
+
+    results.skewness = thirdMoment / standardDeviation3;
+    results.kurtosis = fourthMoment / (results.variance * results.variance) - 3.0;
+}
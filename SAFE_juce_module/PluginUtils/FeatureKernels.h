@@ -0,0 +1,75 @@
+#ifndef __FEATUREKERNELS__
+#define __FEATUREKERNELS__
+
+/**
+ *  Vectorised kernels for the heavy lifting in the feature extraction.
+ *
+ *  SSE2 is used on Intel machines and NEON on 64 bit ARM machines, anything
+ *  else falls back on plain C++.
+ */
+class FeatureKernels
+{
+public:
+    /** Calculate the magnitude of each bin in a complex spectrum.
+     *
+     *  @param interleavedSpectrum  the spectrum as interleaved real and imaginary
+     *                              parts, as given by FFT::performRealOnlyForwardTransform()
+     *  @param magnitudes           an array to write numBins magnitudes to
+     *  @param numBins              the number of bins to find the magnitude of
+     */
+    static void magnitudeSpectrum (const float *interleavedSpectrum, double *magnitudes, int numBins);
+
+    /** The results of temporalStatistics(). */
+    struct TemporalStatistics
+    {
+        double mean;
+        double variance;
+        double standardDeviation;
+        double rmsAmplitude;
+        double zeroCrossingRate;
+        float peak;
+    };
+
+    /** Calculate the basic statistics of a frame of audio in a single pass.
+     *
+     *  The results match those of xtract_mean, xtract_variance, xtract_standard_deviation,
+     *  xtract_rms_amplitude and xtract_zcr, but are worked out from float data so
+     *  the frame doesn't need converting to doubles first. The sums are kept as
+     *  doubles to hold on to the precision.
+     *
+     *  @param data        the audio to analyse
+     *  @param numSamples  the number of samples of audio
+     *  @param results     the structure to write the results to
+     */
+    static void temporalStatistics (const float *data, int numSamples, TemporalStatistics &results);
+
+    /** The results of spectralMoments(). */
+    struct SpectralMoments
+    {
+        double centroid;
+        double variance;
+        double standardDeviation;
+        double skewness;
+        double kurtosis;
+    };
+
+    /** Calculate the moments of a spectrum in a single pass.
+     *
+     *  The results match those of xtract_spectral_centroid, xtract_spectral_variance,
+     *  xtract_spectral_standard_deviation, xtract_spectral_skewness and
+     *  xtract_spectral_kurtosis. The power sums are gathered together and the
+     *  central moments are worked out from them at the end.
+     *
+     *  A spectrum with no spread, such as a peak spectrum with a single peak,
+     *  has a variance, standard deviation, skewness and kurtosis of zero, where
+     *  libxtract divides zero by zero for the last two.
+     *
+     *  @param spectrum  a spectrum in the libxtract layout, numBins amplitudes
+     *                   followed by numBins frequencies
+     *  @param numBins   the number of bins in the spectrum
+     *  @param results   the structure to write the results to
+     */
+    static void spectralMoments (const double *spectrum, int numBins, SpectralMoments &results);
+};
+
+#endif // __FEATUREKERNELS__
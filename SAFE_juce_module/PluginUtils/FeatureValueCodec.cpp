@@ -0,0 +1,366 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace FeatureValueCodecHelpers
+{
+    // residuals which would need more leading ones than this are written out in full
+    static const int maxUnaryLength = 24;
+
+    // quantised values have to stay inside the range a double holds exactly
+    static const double maxQuantisedValue = 4503599627370496.0;
+
+    static uint64 getLowBits (uint64 value, int numBits)
+    {
+        return numBits < 64 ? value & ((((uint64) 1) << numBits) - 1) : value;
+    }
+
+    /** Maps small negative and positive numbers onto small positive numbers. */
+    static uint64 zigzagEncode (int64 value)
+    {
+        return (((uint64) value) << 1) ^ (uint64) (value >> 63);
+    }
+
+    static int64 zigzagDecode (uint64 value)
+    {
+        return (int64) (value >> 1) ^ -(int64) (value & 1);
+    }
+
+    //==========================================================================
+    /** Writes bits to a stream, least significant first. */
+    class BitWriter
+    {
+    public:
+        BitWriter (MemoryOutputStream &outputStream)
+            : stream (outputStream),
+              bits (0),
+              numBits (0)
+        {
+        }
+
+        void write (uint64 value, int numValueBits)
+        {
+            // the buffer only has room for 32 new bits at a time
+            if (numValueBits > 32)
+            {
+                write (value, 32);
+                write (value >> 32, numValueBits - 32);
+                return;
+            }
+
+            bits |= getLowBits (value, numValueBits) << numBits;
+            numBits += numValueBits;
+
+            if (numBits >= 32)
+            {
+                stream.writeInt ((int) (uint32) bits);
+                bits >>= 32;
+                numBits -= 32;
+            }
+        }
+
+        void flush()
+        {
+            for (; numBits > 0; numBits -= 8)
+            {
+                stream.writeByte ((char) (bits & 0xff));
+                bits >>= 8;
+            }
+
+            bits = 0;
+            numBits = 0;
+        }
+
+    private:
+        MemoryOutputStream &stream;
+        uint64 bits;
+        int numBits;
+    };
+
+    /** Reads bits written by a BitWriter. */
+    class BitReader
+    {
+    public:
+        BitReader (const void *data, size_t size)
+            : bytes (static_cast <const uint8*> (data)),
+              numBytes (size),
+              position (0),
+              bits (0),
+              numBits (0),
+              overrun (false)
+        {
+        }
+
+        uint64 read (int numValueBits)
+        {
+            if (numValueBits > 32)
+            {
+                uint64 lowBits = read (32);
+                return lowBits | (read (numValueBits - 32) << 32);
+            }
+
+            while (numBits < numValueBits)
+            {
+                if (position < numBytes)
+                {
+                    bits |= ((uint64) bytes [position++]) << numBits;
+                }
+                else
+                {
+                    overrun = true;
+                }
+
+                numBits += 8;
+            }
+
+            uint64 value = getLowBits (bits, numValueBits);
+            bits >>= numValueBits;
+            numBits -= numValueBits;
+
+            return value;
+        }
+
+        int readUnary (int maxLength)
+        {
+            int length = 0;
+
+            while (length < maxLength && read (1) == 1)
+            {
+                ++length;
+            }
+
+            return length;
+        }
+
+        bool hasOverrun() const
+        {
+            return overrun;
+        }
+
+    private:
+        const uint8 *bytes;
+        size_t numBytes, position;
+        uint64 bits;
+        int numBits;
+        bool overrun;
+    };
+
+    //==========================================================================
+    /** Picks the Rice parameter from the average size of the recent tokens. */
+    class RiceParameter
+    {
+    public:
+        RiceParameter()
+            : total (4),
+              count (1)
+        {
+        }
+
+        int get() const
+        {
+            int parameter = 0;
+
+            while (parameter < 60 && (count << parameter) < total)
+            {
+                ++parameter;
+            }
+
+            return parameter;
+        }
+
+        void update (uint64 token)
+        {
+            total += token;
+            ++count;
+
+            // halving keeps the average following the signal
+            if (count == 64)
+            {
+                total >>= 1;
+                count >>= 1;
+            }
+        }
+
+    private:
+        uint64 total, count;
+    };
+
+    /** Tokens are the zigzagged residuals plus one, 0 means a value stored in full. */
+    static void writeToken (BitWriter &writer, RiceParameter &riceParameter, uint64 token)
+    {
+        const int parameter = riceParameter.get();
+        const uint64 unaryLength = token >> parameter;
+
+        if (unaryLength < (uint64) maxUnaryLength)
+        {
+            // ones followed by a zero
+            writer.write ((((uint64) 1) << unaryLength) - 1, (int) unaryLength + 1);
+            writer.write (token, parameter);
+        }
+        else
+        {
+            writer.write ((((uint64) 1) << maxUnaryLength) - 1, maxUnaryLength);
+            writer.write (token, 64);
+        }
+
+        riceParameter.update (token);
+    }
+
+    static uint64 readToken (BitReader &reader, RiceParameter &riceParameter)
+    {
+        const int parameter = riceParameter.get();
+        const int unaryLength = reader.readUnary (maxUnaryLength);
+        uint64 token;
+
+        if (unaryLength < maxUnaryLength)
+        {
+            token = (((uint64) unaryLength) << parameter) | reader.read (parameter);
+        }
+        else
+        {
+            token = reader.read (64);
+        }
+
+        riceParameter.update (token);
+
+        return token;
+    }
+
+    /** Values are predicted from the same value in the previous feature, or the
+     *  value before them if the previous feature didn't have as many.
+     */
+    static int64 getPrediction (const int64 *previous, int numPrevious, const int64 *current, int index)
+    {
+        if (index < numPrevious)
+        {
+            return previous [index];
+        }
+
+        return index > 0 ? current [index - 1] : 0;
+    }
+}
+
+//==========================================================================
+//      Encoding
+//==========================================================================
+void FeatureValueCodec::encode (const AudioFeatureColumn &features, double step, MemoryOutputStream &stream)
+{
+    using namespace FeatureValueCodecHelpers;
+
+    jassert (step > 0.0);
+
+    const int numFeatures = features.size();
+    int maxNumValues = 1;
+
+    for (int i = 0; i < numFeatures; ++i)
+    {
+        maxNumValues = jmax (maxNumValues, features.getNumValues (i));
+    }
+
+    HeapBlock <int64> previous ((size_t) maxNumValues), current ((size_t) maxNumValues);
+    int numPrevious = 0;
+
+    BitWriter writer (stream);
+    RiceParameter riceParameter;
+
+    for (int feature = 0; feature < numFeatures; ++feature)
+    {
+        const double *values = features.getValues (feature);
+        const int numValues = features.getNumValues (feature);
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            const int64 prediction = getPrediction (previous, numPrevious, current, i);
+            const double scaledValue = values [i] / step;
+            uint64 token = 0;
+
+            // this is false for NaNs and infinities too
+            if (std::abs (scaledValue) < maxQuantisedValue)
+            {
+                current [i] = (int64) std::floor (scaledValue + 0.5);
+                token = zigzagEncode (current [i] - prediction) + 1;
+            }
+            else
+            {
+                current [i] = prediction;
+            }
+
+            writeToken (writer, riceParameter, token);
+
+            if (token == 0)
+            {
+                uint64 rawValue;
+                memcpy (&rawValue, values + i, sizeof (rawValue));
+                writer.write (rawValue, 64);
+            }
+        }
+
+        previous.swapWith (current);
+        numPrevious = numValues;
+    }
+
+    writer.flush();
+}
+
+//==========================================================================
+//      Decoding
+//==========================================================================
+bool FeatureValueCodec::decode (const void *data, size_t numBytes, double step,
+                                const int *valueOffsets, int numFeatures, double *values)
+{
+    using namespace FeatureValueCodecHelpers;
+
+    int maxNumValues = 1;
+
+    for (int i = 0; i < numFeatures; ++i)
+    {
+        const int numValues = valueOffsets [i + 1] - valueOffsets [i];
+
+        if (numValues < 0)
+        {
+            return false;
+        }
+
+        maxNumValues = jmax (maxNumValues, numValues);
+    }
+
+    HeapBlock <int64> previous ((size_t) maxNumValues), current ((size_t) maxNumValues);
+    int numPrevious = 0;
+
+    BitReader reader (data, numBytes);
+    RiceParameter riceParameter;
+
+    for (int feature = 0; feature < numFeatures; ++feature)
+    {
+        double *featureValues = values + valueOffsets [feature];
+        const int numValues = valueOffsets [feature + 1] - valueOffsets [feature];
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            const int64 prediction = getPrediction (previous, numPrevious, current, i);
+            const uint64 token = readToken (reader, riceParameter);
+
+            if (token == 0)
+            {
+                uint64 rawValue = reader.read (64);
+                memcpy (featureValues + i, &rawValue, sizeof (rawValue));
+
+                current [i] = prediction;
+            }
+            else
+            {
+                current [i] = prediction + zigzagDecode (token - 1);
+                featureValues [i] = (double) current [i] * step;
+            }
+        }
+
+        if (reader.hasOverrun())
+        {
+            return false;
+        }
+
+        previous.swapWith (current);
+        numPrevious = numValues;
+    }
+
+    return true;
+}
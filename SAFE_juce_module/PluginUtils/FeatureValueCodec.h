@@ -0,0 +1,42 @@
+#ifndef __FEATUREVALUECODEC__
+#define __FEATUREVALUECODEC__
+
+/**
+ *  Lossy compression for the values of a column of audio features.
+ *
+ *  Most features change slowly from one frame to the next, so each value is
+ *  quantised to a multiple of a step size and stored as the difference from
+ *  the same value in the previous feature. The differences are mostly small,
+ *  so they are written with an adaptive Rice code which gives them a few bits
+ *  each.
+ *
+ *  Each decoded value is within half a step of the original. Values which
+ *  aren't finite or are too big to quantise are stored exactly.
+ */
+class FeatureValueCodec
+{
+public:
+    /** Compress the values of a column.
+     *
+     *  @param features  the features to compress the values of
+     *  @param step      the quantisation step, this must be greater than 0
+     *  @param stream    the stream to write the compressed values to
+     */
+    static void encode (const AudioFeatureColumn &features, double step, MemoryOutputStream &stream);
+
+    /** Decompress the values of a column.
+     *
+     *  @param data          the compressed values
+     *  @param numBytes      the size of the compressed values
+     *  @param step          the quantisation step they were compressed with
+     *  @param valueOffsets  the offset of each feature's values, with one extra for the end
+     *  @param numFeatures   the number of features in the column
+     *  @param values        somewhere to put the values
+     *
+     *  @return false if the data ran out before all the values were read
+     */
+    static bool decode (const void *data, size_t numBytes, double step,
+                        const int *valueOffsets, int numFeatures, double *values);
+};
+
+#endif // __FEATUREVALUECODEC__
@@ -0,0 +1,257 @@
+//==========================================================================
+//      Node Definitions
+//==========================================================================
+#define SAFE_NO_ARGUMENTS       {{NoArgument, NoNode, 0}, {NoArgument, NoNode, 0}}
+#define SAFE_NODE_ARGUMENT(a)   {{NodeArgument, a, 0}, {NoArgument, NoNode, 0}}
+#define SAFE_NODE_ARGUMENTS(a, b) {{NodeArgument, a, 0}, {NodeArgument, b, 0}}
+
+// these must be in the same order as the Node enum
+const LibXtractFeatureGraph::NodeDefinition LibXtractFeatureGraph::nodeDefinitions [NumNodes] =
+{
+    // temporal features - these all come out of the fused temporal statistics
+    {nullptr,                             TemporalStatistics,      false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             TemporalStatistics,      false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             TemporalStatistics,      false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             TemporalStatistics,      false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             TemporalStatistics,      false, SAFE_NO_ARGUMENTS},
+
+    // spectral features
+    {xtract_failsafe_f0,                  TimeDomainBuffer,        false, {{SampleRateArgument, NoNode, 0}, {NoArgument, NoNode, 0}}},
+    {nullptr,                             SpectralMoments,         false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             SpectralMoments,         false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             SpectralMoments,         false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             SpectralMoments,         false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             SpectralMoments,         false, SAFE_NO_ARGUMENTS},
+    {xtract_irregularity_j,               SpectrumBuffer,          true,  SAFE_NO_ARGUMENTS},
+    {xtract_irregularity_k,               SpectrumBuffer,          true,  SAFE_NO_ARGUMENTS},
+    {xtract_smoothness,                   SpectrumBuffer,          true,  SAFE_NO_ARGUMENTS},
+    {xtract_rolloff,                      SpectrumBuffer,          true,  {{BinWidthArgument, NoNode, 0}, {ConstantArgument, NoNode, 45}}},
+    {xtract_flatness,                     SpectrumBuffer,          true,  SAFE_NO_ARGUMENTS},
+    {xtract_tonality,                     NoNode,                  false, SAFE_NODE_ARGUMENT (LogSpectralFlatness)},
+    {xtract_crest,                        NoNode,                  false, SAFE_NODE_ARGUMENTS (SpectralHighestValue, SpectralMean)},
+    {xtract_spectral_slope,               SpectrumBuffer,          false, SAFE_NO_ARGUMENTS},
+
+    // peak spectral features
+    {nullptr,                             PeakSpectralMoments,     false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             PeakSpectralMoments,     false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             PeakSpectralMoments,     false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             PeakSpectralMoments,     false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             PeakSpectralMoments,     false, SAFE_NO_ARGUMENTS},
+    {xtract_irregularity_j,               PeakSpectrumBuffer,      true,  SAFE_NO_ARGUMENTS},
+    {xtract_irregularity_k,               PeakSpectrumBuffer,      true,  SAFE_NO_ARGUMENTS},
+    {xtract_tristimulus_1,                PeakSpectrumBuffer,      false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+    {xtract_tristimulus_2,                PeakSpectrumBuffer,      false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+    {xtract_tristimulus_3,                PeakSpectrumBuffer,      false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+
+    // harmonic spectral features
+    {xtract_spectral_inharmonicity,       PeakSpectrumBuffer,      false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+    {nullptr,                             HarmonicSpectralMoments, false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             HarmonicSpectralMoments, false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             HarmonicSpectralMoments, false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             HarmonicSpectralMoments, false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             HarmonicSpectralMoments, false, SAFE_NO_ARGUMENTS},
+    {xtract_irregularity_j,               HarmonicSpectrumBuffer,  true,  SAFE_NO_ARGUMENTS},
+    {xtract_irregularity_k,               HarmonicSpectrumBuffer,  true,  SAFE_NO_ARGUMENTS},
+    {xtract_tristimulus_1,                HarmonicSpectrumBuffer,  false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+    {xtract_tristimulus_2,                HarmonicSpectrumBuffer,  false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+    {xtract_tristimulus_3,                HarmonicSpectrumBuffer,  false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+    {xtract_noisiness,                    NoNode,                  false, SAFE_NODE_ARGUMENTS (HarmonicSpectrumNonZeroCount, PeakSpectrumNonZeroCount)},
+    {xtract_odd_even_ratio,               HarmonicSpectrumBuffer,  false, SAFE_NODE_ARGUMENT (LibXtract::FundamentalFrequency)},
+
+    // intermediate values
+    {xtract_highest_value,                SpectrumBuffer,          true,  SAFE_NO_ARGUMENTS},
+    {xtract_mean,                         SpectrumBuffer,          true,  SAFE_NO_ARGUMENTS},
+    {xtract_flatness_db,                  NoNode,                  false, SAFE_NODE_ARGUMENT (LibXtract::SpectralFlatness)},
+    {xtract_nonzero_count,                PeakSpectrumBuffer,      true,  SAFE_NO_ARGUMENTS},
+    {xtract_nonzero_count,                HarmonicSpectrumBuffer,  true,  SAFE_NO_ARGUMENTS},
+
+    // buffers - the time domain data and spectrum are filled in by the feature extractor
+    {nullptr,                             NoNode,                  false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             NoNode,                  false, SAFE_NO_ARGUMENTS},
+    {xtract_peak_spectrum,                SpectrumBuffer,          true,  {{BinWidthArgument, NoNode, 0}, {ConstantArgument, NoNode, 10}}},
+    {xtract_harmonic_spectrum,            PeakSpectrumBuffer,      false, {{NodeArgument, LibXtract::FundamentalFrequency, 0}, {ConstantArgument, NoNode, 0.2}}},
+    {xtract_bark_coefficients,            SpectrumBuffer,          true,  {{BarkBandLimitsArgument, NoNode, 0}, {NoArgument, NoNode, 0}}},
+    {xtract_mfcc,                         SpectrumBuffer,          true,  {{MelFiltersArgument, NoNode, 0}, {NoArgument, NoNode, 0}}},
+
+    // filled in by the feature extractor
+    {nullptr,                             NoNode,                  false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             SpectrumBuffer,          false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             PeakSpectrumBuffer,      false, SAFE_NO_ARGUMENTS},
+    {nullptr,                             HarmonicSpectrumBuffer,  false, SAFE_NO_ARGUMENTS}
+};
+
+#undef SAFE_NO_ARGUMENTS
+#undef SAFE_NODE_ARGUMENT
+#undef SAFE_NODE_ARGUMENTS
+
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+LibXtractFeatureGraph::LibXtractFeatureGraph()
+{
+    for (int i = 0; i < NumNodes; ++i)
+    {
+        requested [i] = false;
+        compiled [i] = false;
+    }
+}
+
+LibXtractFeatureGraph::~LibXtractFeatureGraph()
+{
+}
+
+//==========================================================================
+//      Building the Graph
+//==========================================================================
+void LibXtractFeatureGraph::addFeature (LibXtract::Feature feature)
+{
+    if (feature < LibXtract::NumScalarFeatures)
+    {
+        requested [feature] = true;
+    }
+    else if (feature == LibXtract::BarkCoefficients)
+    {
+        requested [BarkCoefficientsBuffer] = true;
+    }
+    else if (feature == LibXtract::MFCCs)
+    {
+        requested [MFCCsBuffer] = true;
+    }
+    else
+    {
+        // feature groups should be split up before they get here
+        jassertfalse;
+    }
+}
+
+bool LibXtractFeatureGraph::isFeatureRequested (LibXtract::Feature feature) const
+{
+    if (feature < LibXtract::NumScalarFeatures)
+    {
+        return requested [feature];
+    }
+    else if (feature == LibXtract::BarkCoefficients)
+    {
+        return requested [BarkCoefficientsBuffer];
+    }
+    else if (feature == LibXtract::MFCCs)
+    {
+        return requested [MFCCsBuffer];
+    }
+
+    return false;
+}
+
+void LibXtractFeatureGraph::compile (int frameSize, double sampleRate, const int *barkBandLimits, const xtract_mel_filter *melFilters)
+{
+    steps.clearQuick();
+
+    for (int i = 0; i < NumNodes; ++i)
+    {
+        compiled [i] = false;
+    }
+
+    for (int i = 0; i < NumNodes; ++i)
+    {
+        if (requested [i])
+        {
+            addStepsForNode (i, frameSize, sampleRate, barkBandLimits, melFilters);
+        }
+    }
+}
+
+void LibXtractFeatureGraph::addStepsForNode (int node, int frameSize, double sampleRate, 
+                                             const int *barkBandLimits, const xtract_mel_filter *melFilters)
+{
+    if (compiled [node])
+    {
+        return;
+    }
+
+    compiled [node] = true;
+
+    const NodeDefinition &definition = nodeDefinitions [node];
+
+    // add the dependencies first
+    if (definition.input != NoNode)
+    {
+        addStepsForNode (definition.input, frameSize, sampleRate, barkBandLimits, melFilters);
+    }
+
+    Step newStep;
+    newStep.output = static_cast <Node> (node);
+    newStep.function = definition.function;
+    newStep.input = static_cast <Node> (definition.input);
+    newStep.length = 0;
+    newStep.numArguments = 0;
+    newStep.argumentPointer = nullptr;
+
+    if (definition.input != NoNode)
+    {
+        newStep.length = definition.halfLength ? frameSize / 2 : frameSize;
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        const Argument &argument = definition.arguments [i];
+
+        newStep.argumentNodes [i] = NoNode;
+        newStep.argumentConstants [i] = 0;
+
+        switch (argument.type)
+        {
+            case NoArgument:
+                continue;
+
+            case NodeArgument:
+                // only single values can be passed as arguments
+                jassert (argument.node < NumScalarNodes);
+
+                addStepsForNode (argument.node, frameSize, sampleRate, barkBandLimits, melFilters);
+                newStep.argumentNodes [i] = static_cast <Node> (argument.node);
+                break;
+
+            case ConstantArgument:
+                newStep.argumentConstants [i] = argument.constant;
+                break;
+
+            case SampleRateArgument:
+                newStep.argumentConstants [i] = sampleRate;
+                break;
+
+            case BinWidthArgument:
+                newStep.argumentConstants [i] = sampleRate / frameSize;
+                break;
+
+            case BarkBandLimitsArgument:
+                newStep.argumentPointer = barkBandLimits;
+                break;
+
+            case MelFiltersArgument:
+                newStep.argumentPointer = melFilters;
+                break;
+        }
+
+        newStep.numArguments = i + 1;
+    }
+
+    steps.add (newStep);
+}
+
+//==========================================================================
+//      Compiled Steps
+//==========================================================================
+int LibXtractFeatureGraph::getNumSteps() const
+{
+    return steps.size();
+}
+
+const LibXtractFeatureGraph::Step& LibXtractFeatureGraph::getStep (int index) const
+{
+    return steps.getReference (index);
+}
+
+bool LibXtractFeatureGraph::needsNode (Node node) const
+{
+    return compiled [node];
+}
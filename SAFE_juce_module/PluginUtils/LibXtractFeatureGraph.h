@@ -0,0 +1,163 @@
+#ifndef __LIBXTRACTFEATUREGRAPH__
+#define __LIBXTRACTFEATUREGRAPH__
+
+/**
+ *  The dependencies between the libxtract features.
+ *
+ *  Each feature, and each intermediate value or spectrum the features rely on,
+ *  is a node in a graph. A node says which libxtract function calculates it, which
+ *  buffer the function reads and what arguments it is passed. Any node used as an
+ *  input or an argument is a dependency of the node.
+ *
+ *  Once the required features have been added the graph is compiled into a flat
+ *  list of steps, ordered so that each step comes after everything it depends on.
+ */
+class LibXtractFeatureGraph
+{
+public:
+    /** The nodes in the graph.
+     *
+     *  The scalar features share their numbers with LibXtract::Feature.
+     */
+    enum Node
+    {
+        // intermediate values
+        SpectralHighestValue = LibXtract::NumScalarFeatures,
+        SpectralMean,
+        LogSpectralFlatness,
+        PeakSpectrumNonZeroCount,
+        HarmonicSpectrumNonZeroCount,
+
+        // number of nodes holding a single value
+        NumScalarNodes,
+
+        // buffers
+        TimeDomainBuffer = NumScalarNodes,
+        SpectrumBuffer,
+        PeakSpectrumBuffer,
+        HarmonicSpectrumBuffer,
+        BarkCoefficientsBuffer,
+        MFCCsBuffer,
+
+        // groups of features which are worked out together
+        TemporalStatistics,
+        SpectralMoments,
+        PeakSpectralMoments,
+        HarmonicSpectralMoments,
+
+        NumNodes,
+        NoNode = -1
+    };
+
+    /** The signature shared by the libxtract feature functions. */
+    typedef int (*XtractFunction) (const double*, const int, const void*, double*);
+
+    /** A compiled step with its arguments bound. */
+    struct Step
+    {
+        /** The node the step calculates. */
+        Node output;
+
+        /** The libxtract function to call - this is nullptr for the time domain
+         *  data, spectrum and feature groups which are filled in by the feature
+         *  extractor, and for the features which come out of those groups. */
+        XtractFunction function;
+
+        /** The buffer passed to the function. */
+        Node input;
+
+        /** The length passed to the function. */
+        int length;
+
+        /** The arguments passed to the function, taken from these nodes or constants. */
+        int numArguments;
+        Node argumentNodes [2];
+        double argumentConstants [2];
+
+        /** A pointer passed as the argument in place of the argument array. */
+        const void *argumentPointer;
+    };
+
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create an empty graph. */
+    LibXtractFeatureGraph();
+
+    /** Destructor */
+    ~LibXtractFeatureGraph();
+
+    //==========================================================================
+    //      Building the Graph
+    //==========================================================================
+    /** Request a feature.
+     *
+     *  @param feature  a scalar feature, BarkCoefficients or MFCCs
+     */
+    void addFeature (LibXtract::Feature feature);
+
+    /** Returns true if a feature has been requested. */
+    bool isFeatureRequested (LibXtract::Feature feature) const;
+
+    /** Compile the requested features into a list of steps.
+     *
+     *  @param frameSize        the size of the frames being analysed
+     *  @param sampleRate       the sample rate of the audio being analysed
+     *  @param barkBandLimits   the band limits for the bark coefficients
+     *  @param melFilters       the filters for the MFCCs
+     */
+    void compile (int frameSize, double sampleRate, const int *barkBandLimits, const xtract_mel_filter *melFilters);
+
+    //==========================================================================
+    //      Compiled Steps
+    //==========================================================================
+    /** Returns the number of compiled steps. */
+    int getNumSteps() const;
+
+    /** Returns a compiled step. */
+    const Step& getStep (int index) const;
+
+    /** Returns true if the compiled steps need a given node. */
+    bool needsNode (Node node) const;
+
+private:
+    /** How an argument is worked out. */
+    enum ArgumentType
+    {
+        NoArgument,
+        NodeArgument,
+        ConstantArgument,
+        SampleRateArgument,
+        BinWidthArgument,
+        BarkBandLimitsArgument,
+        MelFiltersArgument
+    };
+
+    struct Argument
+    {
+        ArgumentType type;
+        int node;
+        double constant;
+    };
+
+    struct NodeDefinition
+    {
+        XtractFunction function;
+        int input;
+        bool halfLength;
+        Argument arguments [2];
+    };
+
+    static const NodeDefinition nodeDefinitions [NumNodes];
+
+    bool requested [NumNodes];
+    bool compiled [NumNodes];
+    Array <Step> steps;
+
+    void addStepsForNode (int node, int frameSize, double sampleRate, 
+                          const int *barkBandLimits, const xtract_mel_filter *melFilters);
+
+    JUCE_DECLARE_NON_COPYABLE (LibXtractFeatureGraph)
+};
+
+#endif // __LIBXTRACTFEATUREGRAPH__
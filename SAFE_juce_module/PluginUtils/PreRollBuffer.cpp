@@ -0,0 +1,127 @@
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+PreRollBuffer::PreRollBuffer()
+    : numChannels (0),
+      numSamples (0)
+{
+}
+
+PreRollBuffer::~PreRollBuffer()
+{
+}
+
+//==========================================================================
+//      Setup
+//==========================================================================
+void PreRollBuffer::setSize (int numChannelsInit, int numSamplesInit)
+{
+    numChannels = jmax (0, numChannelsInit);
+    numSamples = jmax (0, numSamplesInit);
+
+    ring.setSize (jmax (1, numChannels), jmax (1, numSamples));
+    ring.clear();
+
+    writeEnd = 0;
+    readEnd = 0;
+}
+
+int PreRollBuffer::getNumSamples() const
+{
+    return numSamples;
+}
+
+//==========================================================================
+//      Writing and Reading
+//==========================================================================
+void PreRollBuffer::write (const AudioSampleBuffer &buffer, int startSample, int numSamplesToWrite)
+{
+    if (numSamples == 0 || numSamplesToWrite <= 0)
+    {
+        return;
+    }
+
+    // only the writer changes the positions so this doesn't need to be atomic
+    int64 position = readEnd.get();
+
+    // anything before the last lap of the ring would be overwritten straight away
+    if (numSamplesToWrite > numSamples)
+    {
+        const int numToSkip = numSamplesToWrite - numSamples;
+
+        startSample += numToSkip;
+        position += numToSkip;
+        numSamplesToWrite = numSamples;
+    }
+
+    writeEnd = position + numSamplesToWrite;
+
+    const int ringStart = (int) (position % numSamples);
+    const int firstPart = jmin (numSamplesToWrite, numSamples - ringStart);
+    const int secondPart = numSamplesToWrite - firstPart;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float *ringData = ring.getWritePointer (channel);
+
+        if (channel < buffer.getNumChannels())
+        {
+            const float *bufferData = buffer.getReadPointer (channel, startSample);
+
+            FloatVectorOperations::copy (ringData + ringStart, bufferData, firstPart);
+            FloatVectorOperations::copy (ringData, bufferData + firstPart, secondPart);
+        }
+        else
+        {
+            FloatVectorOperations::clear (ringData + ringStart, firstPart);
+            FloatVectorOperations::clear (ringData, secondPart);
+        }
+    }
+
+    readEnd = position + numSamplesToWrite;
+}
+
+int64 PreRollBuffer::getNumSamplesWritten() const
+{
+    return readEnd.get();
+}
+
+bool PreRollBuffer::read (AudioSampleBuffer &destination, int64 endPosition, int numSamplesToRead) const
+{
+    const int64 startPosition = endPosition - numSamplesToRead;
+
+    if (numSamplesToRead < 0 || numSamplesToRead > numSamples || startPosition < 0
+        || endPosition > readEnd.get() || numSamplesToRead > destination.getNumSamples())
+    {
+        return false;
+    }
+
+    if (startPosition < writeEnd.get() - numSamples)
+    {
+        return false;
+    }
+
+    const int ringStart = (int) (startPosition % jmax (1, numSamples));
+    const int firstPart = jmin (numSamplesToRead, numSamples - ringStart);
+    const int secondPart = numSamplesToRead - firstPart;
+
+    for (int channel = 0; channel < destination.getNumChannels(); ++channel)
+    {
+        float *destinationData = destination.getWritePointer (channel);
+
+        if (channel < numChannels)
+        {
+            const float *ringData = ring.getReadPointer (channel);
+
+            FloatVectorOperations::copy (destinationData, ringData + ringStart, firstPart);
+            FloatVectorOperations::copy (destinationData + firstPart, ringData, secondPart);
+        }
+        else
+        {
+            FloatVectorOperations::clear (destinationData, numSamplesToRead);
+        }
+    }
+
+    // the writer may have come round the ring onto the samples while we copied them
+    return startPosition >= writeEnd.get() - numSamples;
+}
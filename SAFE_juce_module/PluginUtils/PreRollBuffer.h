@@ -0,0 +1,79 @@
+#ifndef __PREROLLBUFFER__
+#define __PREROLLBUFFER__
+
+/**
+ *  A ring buffer which always holds the most recent samples written to it.
+ *
+ *  One thread, normally the audio thread, writes to it and any other thread
+ *  can copy samples out without locking. Writing costs the same every time
+ *  and never allocates. A reader checks whether the writer went round the
+ *  ring over the samples while they were being copied, and fails if it did,
+ *  so the ring should be a bit longer than the longest stretch read from it.
+ *
+ *  Samples are addressed by their position in the stream of samples written
+ *  since the buffer was last sized.
+ */
+class PreRollBuffer
+{
+public:
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create an empty buffer. */
+    PreRollBuffer();
+
+    /** Destructor */
+    ~PreRollBuffer();
+
+    //==========================================================================
+    //      Setup
+    //==========================================================================
+    /** Allocate the ring and forget everything written to it.
+     *
+     *  This allocates so it shouldn't be called while the buffer is being
+     *  written to or read from.
+     *
+     *  @param numChannelsInit  the number of channels to keep
+     *  @param numSamplesInit   the number of samples to keep for each channel
+     */
+    void setSize (int numChannelsInit, int numSamplesInit);
+
+    /** Returns the number of samples the ring holds. */
+    int getNumSamples() const;
+
+    //==========================================================================
+    //      Writing and Reading
+    //==========================================================================
+    /** Add some samples to the ring, overwriting the oldest ones.
+     *
+     *  Channels the ring has which aren't in the buffer are filled with silence.
+     */
+    void write (const AudioSampleBuffer &buffer, int startSample, int numSamplesToWrite);
+
+    /** Returns the number of samples written since the buffer was sized. */
+    int64 getNumSamplesWritten() const;
+
+    /** Copy some samples out of the ring.
+     *
+     *  @param destination       the buffer to copy to, starting at its first sample
+     *  @param endPosition       the position just after the last sample to copy
+     *  @param numSamplesToRead  the number of samples to copy
+     *
+     *  @return false if the samples haven't been written yet or have been overwritten
+     */
+    bool read (AudioSampleBuffer &destination, int64 endPosition, int numSamplesToRead) const;
+
+private:
+    //==========================================================================
+    //      Private Members
+    //==========================================================================
+    AudioSampleBuffer ring;
+    int numChannels, numSamples;
+
+    // the writer moves writeEnd on before it writes and readEnd after
+    Atomic <int64> writeEnd, readEnd;
+
+    JUCE_DECLARE_NON_COPYABLE (PreRollBuffer)
+};
+
+#endif // __PREROLLBUFFER__
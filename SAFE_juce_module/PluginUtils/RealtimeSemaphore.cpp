@@ -0,0 +1,82 @@
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+RealtimeSemaphore::RealtimeSemaphore()
+{
+    #if JUCE_LINUX || JUCE_ANDROID
+    sem_init (&semaphore, 0, 0);
+    #elif JUCE_MAC || JUCE_IOS
+    semaphore = dispatch_semaphore_create (0);
+    #endif
+}
+
+RealtimeSemaphore::~RealtimeSemaphore()
+{
+    #if JUCE_LINUX || JUCE_ANDROID
+    sem_destroy (&semaphore);
+    #elif JUCE_MAC || JUCE_IOS
+    dispatch_release (semaphore);
+    #endif
+}
+
+//==========================================================================
+//      Signal and Wait
+//==========================================================================
+void RealtimeSemaphore::signal()
+{
+    #if JUCE_LINUX || JUCE_ANDROID
+    sem_post (&semaphore);
+    #elif JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_signal (semaphore);
+    #else
+    event.signal();
+    #endif
+}
+
+bool RealtimeSemaphore::wait (int timeOutMilliseconds)
+{
+    #if JUCE_LINUX || JUCE_ANDROID
+    if (timeOutMilliseconds < 0)
+    {
+        // carry on waiting if a signal handler interrupts us
+        while (sem_wait (&semaphore) != 0)
+        {
+            if (errno != EINTR)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    struct timespec time;
+    clock_gettime (CLOCK_REALTIME, &time);
+
+    time.tv_sec += timeOutMilliseconds / 1000;
+    time.tv_nsec += (timeOutMilliseconds % 1000) * 1000000;
+
+    if (time.tv_nsec >= 1000000000)
+    {
+        time.tv_nsec -= 1000000000;
+        ++time.tv_sec;
+    }
+
+    while (sem_timedwait (&semaphore, &time) != 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    return true;
+    #elif JUCE_MAC || JUCE_IOS
+    dispatch_time_t timeOut = timeOutMilliseconds < 0 ? DISPATCH_TIME_FOREVER
+                                                      : dispatch_time (DISPATCH_TIME_NOW, (int64) timeOutMilliseconds * NSEC_PER_MSEC);
+
+    return dispatch_semaphore_wait (semaphore, timeOut) == 0;
+    #else
+    return event.wait (timeOutMilliseconds);
+    #endif
+}
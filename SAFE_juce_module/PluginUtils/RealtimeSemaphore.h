@@ -0,0 +1,53 @@
+#ifndef __REALTIMESEMAPHORE__
+#define __REALTIMESEMAPHORE__
+
+/**
+ *  A counting semaphore which can be signalled from the audio thread.
+ *
+ *  Signalling never takes a lock, so the audio thread can wake a worker
+ *  without risking being held up by it. This uses POSIX semaphores on Linux
+ *  and dispatch semaphores on OS X. Elsewhere it falls back on a
+ *  WaitableEvent, which on Windows is a kernel event and doesn't lock either.
+ */
+class RealtimeSemaphore
+{
+public:
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a semaphore with nothing to wait for. */
+    RealtimeSemaphore();
+
+    /** Destructor */
+    ~RealtimeSemaphore();
+
+    //==========================================================================
+    //      Signal and Wait
+    //==========================================================================
+    /** Wake up a waiting thread, or the next one to wait. */
+    void signal();
+
+    /** Wait for a signal.
+     *
+     *  @param timeOutMilliseconds  how long to wait, or -1 to wait forever
+     *
+     *  @return false if it timed out
+     */
+    bool wait (int timeOutMilliseconds = -1);
+
+private:
+    //==========================================================================
+    //      Private Members
+    //==========================================================================
+    #if JUCE_LINUX || JUCE_ANDROID
+    sem_t semaphore;
+    #elif JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_t semaphore;
+    #else
+    WaitableEvent event;
+    #endif
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeSemaphore)
+};
+
+#endif // __REALTIMESEMAPHORE__
@@ -20,8 +20,43 @@ SAFEAudioProcessor::AnalysisThread::~AnalysisThread()
 //==========================================================================
 void SAFEAudioProcessor::AnalysisThread::run()
 {
-    GenericScopedLock <SpinLock> lock (mutex);
+    // the thread lives as long as the processor and sleeps until the audio thread has
+    // recorded something for it
+    while (! threadShouldExit())
+    {
+        processor->recordedBlocksAvailable.wait();
+
+        if (threadShouldExit())
+        {
+            return;
+        }
+
+        processor->analyseRecordedBlocks();
+    }
+}
 
+//==========================================================================
+//      A Job for Saving the Analysed Data on the Shared Scheduler
+//==========================================================================
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+SAFEAudioProcessor::SaveJob::SaveJob (SAFEAudioProcessor* processorInit)
+    : ThreadPoolJob ("SaveJob"),
+      sendToServer (false)
+{
+    processor = processorInit;
+}
+
+SAFEAudioProcessor::SaveJob::~SaveJob()
+{
+}
+
+//==========================================================================
+//      The Job Callback
+//==========================================================================
+ThreadPoolJob::JobStatus SAFEAudioProcessor::SaveJob::runJob()
+{
     WarningID warning;
 
     if (sendToServer)
@@ -39,12 +74,14 @@ void SAFEAudioProcessor::AnalysisThread::run()
     }
 
     processor->readyToSave = true;
+
+    return jobHasFinished;
 }
 
 //==========================================================================
 //      Set Some Parameters
 //==========================================================================
-void SAFEAudioProcessor::AnalysisThread::setParameters (String newDescriptors, SAFEMetaData newMetaData, bool newSendToServer)
+void SAFEAudioProcessor::SaveJob::setParameters (String newDescriptors, SAFEMetaData newMetaData, bool newSendToServer)
 {
     descriptors = newDescriptors;
     metaData = newMetaData;
@@ -52,9 +89,45 @@ void SAFEAudioProcessor::AnalysisThread::setParameters (String newDescriptors, S
 }
 
 //==========================================================================
-//      Lock to ensure only one plug-in saves at a time
+//      A Job for Importing Old Xml Data on the Shared Scheduler
+//==========================================================================
 //==========================================================================
-SpinLock SAFEAudioProcessor::AnalysisThread::mutex;
+//      Constructor and Destructor
+//==========================================================================
+SAFEAudioProcessor::ImportJob::ImportJob (const File &xmlFileInit, const File &logFileInit)
+    : ThreadPoolJob ("ImportJob"),
+      xmlFile (xmlFileInit),
+      logFile (logFileInit)
+{
+}
+
+SAFEAudioProcessor::ImportJob::~ImportJob()
+{
+}
+
+//==========================================================================
+//      The Job Callback
+//==========================================================================
+ThreadPoolJob::JobStatus SAFEAudioProcessor::ImportJob::runJob()
+{
+    // the job has a store of its own, the processor picks the records up when it next synchronises
+    SemanticDataStore store;
+    CriticalSection &fileLock = analysisScheduler->getFileLock (logFile);
+
+    {
+        const ScopedLock lock (fileLock);
+
+        if (! store.open (logFile))
+        {
+            return jobHasFinished;
+        }
+    }
+
+    // the lock is only taken while the parsed records are copied into the log
+    store.migrateXmlFile (xmlFile, fileLock, this);
+
+    return jobHasFinished;
+}
 
 //==========================================================================
 //      The Processor Itself
@@ -63,9 +136,16 @@ SpinLock SAFEAudioProcessor::AnalysisThread::mutex;
 //      Constructor and Destructor
 //==========================================================================
 SAFEAudioProcessor::SAFEAudioProcessor()
+    : recordedBlockFifo (256)
 {
     // reset tap values
-    unprocessedTap = processedTap = 0;
+    unprocessedTap = 0;
+    processedTap = 0;
+    unprocessedSamplesAnalysed = processedSamplesAnalysed = 0;
+
+    preRollCaptureEnabled = false;
+    preRollParameterSequence = 0;
+    preRollSteadyStart = 0;
 
     // get the semantic data file set up
     initialiseSemanticDataFile();
@@ -78,15 +158,45 @@ SAFEAudioProcessor::SAFEAudioProcessor()
     numInputs = 1;
     numOutputs = 1;
 
+    currentRecording = 0;
+    localRecordingNumber = 0;
+    analysisRecording = -1;
+    analysisFinished = true;
+    recordedBlockPending = false;
+
+    recordedBlocks.allocate ((size_t) recordedBlockFifo.getTotalSize(), true);
+
+    saveJob = new SaveJob (this);
     analysisThread = new AnalysisThread (this);
+    analysisThread->startThread();
 
     controlRate = 64;
     controlBlockSize = (int) (44100.0 / controlRate);
     remainingControlBlockSamples = 0;
+
+    parameterRampsEnabled = false;
+    usingParameterRamps = false;
+    maximumRampSize = 0;
+
+    parametersChanged = 0;
+    numSmoothingParameters = 0;
+    parametersMoved = false;
 }
 
 SAFEAudioProcessor::~SAFEAudioProcessor()
 {
+    // make sure nothing is still using the processor
+    serverRequests->removeListener (this);
+
+    analysisThread->signalThreadShouldExit();
+    recordedBlocksAvailable.signal();
+    analysisThread->stopThread (4000);
+    analysisScheduler->removeJob (saveJob, 4000);
+
+    if (importJob != nullptr)
+    {
+        analysisScheduler->removeJob (importJob, 4000);
+    }
 }
 
 //==========================================================================
@@ -109,9 +219,9 @@ float SAFEAudioProcessor::getParameter (int index)
 
 void SAFEAudioProcessor::setParameter (int index, float newValue)
 {
+    // the audio thread picks the value up at the start of the next block
     parameters [index]->setBaseValue (newValue);
-    
-    parameterUpdateCalculations (index);
+    parametersChanged = 1;
 }
 
 float SAFEAudioProcessor::getScaledParameter (int index)
@@ -122,8 +232,7 @@ float SAFEAudioProcessor::getScaledParameter (int index)
 void SAFEAudioProcessor::setScaledParameter (int index, float newValue)
 {
     parameters [index]->setScaledValue (newValue);
-    
-    parameterUpdateCalculations (index);
+    parametersChanged = 1;
 }
 
 void SAFEAudioProcessor::setScaledParameterNotifyingHost (int index, float newValue)
@@ -276,21 +385,34 @@ void SAFEAudioProcessor::initialiseSemanticDataFile()
         dataDirectory.createDirectory();
     }
 
-    semanticDataFile = dataDirectory.getChildFile (JucePlugin_Name + String ("Data.xml"));
+    semanticDataFile = dataDirectory.getChildFile (JucePlugin_Name + String ("Data.records"));
 
-    if (semanticDataFile.exists())
     {
-        XmlDocument semanticDataDocument (semanticDataFile);
-        semanticDataElement = semanticDataDocument.getDocumentElement();
+        // other instances of this plug-in share the file
+        const ScopedLock fileLock (analysisScheduler->getFileLock (semanticDataFile));
+
+        semanticDataStore.open (semanticDataFile);
     }
-    else
+
+    // move any records from the old xml file into the store, just the once, without holding up the constructor
+    File xmlDataFile = dataDirectory.getChildFile (JucePlugin_Name + String ("Data.xml"));
+
+    if (xmlDataFile.existsAsFile())
     {
-        String elementName (JucePlugin_Name + String ("Data"));
-        semanticDataElement = new XmlElement (makeXmlString (elementName));
-        semanticDataElement->writeToFile (semanticDataFile, "");
+        importJob = new ImportJob (xmlDataFile, semanticDataFile);
+        analysisScheduler->addJob (importJob);
     }
 }
 
+StringArray SAFEAudioProcessor::getLocalDescriptors()
+{
+    const ScopedLock fileLock (analysisScheduler->getFileLock (semanticDataFile));
+
+    semanticDataStore.synchronise();
+
+    return semanticDataStore.getDescriptors();
+}
+
 XmlElement* SAFEAudioProcessor::getSemanticDataElement()
 {
     updateSemanticDataElement();
@@ -298,102 +420,136 @@ XmlElement* SAFEAudioProcessor::getSemanticDataElement()
     return semanticDataElement.get();
 }
 
-WarningID SAFEAudioProcessor::populateXmlElementWithSemanticData (XmlElement* element, const SAFEMetaData& metaData)
+void SAFEAudioProcessor::writeSemanticDataToXmlStream (XmlStreamWriter& writer, const SAFEMetaData& metaData)
 {
-    // analyse the buffered samples
-    WarningID warning = analyseRecordedSamples();
-
-    if (warning != NoWarning)
-    {
-        return warning;
-    }
-
     // save the channel configuration
-    XmlElement* configElement = element->createNewChildElement ("PlugInConfiguration");
+    writer.startElement ("PlugInConfiguration");
+
+    writer.addAttribute ("PluginCode", getPluginCode());
+    writer.addAttribute ("Inputs", numInputs);
+    writer.addAttribute ("Outputs", numOutputs);
+    writer.addAttribute ("SampleRate", fs);
+    writer.addAttribute ("AnalysisTime", getAnalysisTime());
 
-    configElement->setAttribute ("PluginCode", getPluginCode());
-    configElement->setAttribute ("Inputs", numInputs);
-    configElement->setAttribute ("Outputs", numOutputs);
-    configElement->setAttribute ("SampleRate", fs);
-    configElement->setAttribute ("AnalysisTime", getAnalysisTime());
+    writer.endElement();
 
     // save the parameter settings
-    XmlElement* parametersElement = element->createNewChildElement ("ParameterSettings");
-    String parameterString;
+    writer.startElement ("ParameterSettings");
+    writer.startAttribute ("Values");
 
     for (int parameterNum = 0; parameterNum < parameters.size() - 1; ++parameterNum)
     {
         float currentParameterValue = parametersToSave [parameterNum];
-        parameterString += String (currentParameterValue) + ", ";
+        writer.writeAttributeText (String (currentParameterValue) + ", ");
     }
 
     if (parameters.size() > 0)
     {
-        parameterString += String (parametersToSave.getLast());
+        writer.writeAttributeText (String (parametersToSave.getLast()));
     }
 
-    parametersElement->setAttribute ("Values", parameterString);
+    writer.endAttribute();
+    writer.endElement();
 
     // save the unprocessed audio features
-    XmlElement* unprocessedFeaturesElement = element->createNewChildElement ("UnprocessedAudioFeatures");
-    unprocessedFeatureExtractor.addFeaturesToXmlElement (unprocessedFeaturesElement);
+    writer.startElement ("UnprocessedAudioFeatures");
+    unprocessedFeatureExtractor.writeFeaturesToXmlStream (writer);
+    writer.endElement();
 
     // save the processed audio features
-    XmlElement* processedFeaturesElement = element->createNewChildElement ("ProcessedAudioFeatures");
-    processedFeatureExtractor.addFeaturesToXmlElement (processedFeaturesElement);
+    writer.startElement ("ProcessedAudioFeatures");
+    processedFeatureExtractor.writeFeaturesToXmlStream (writer);
+    writer.endElement();
 
     // save the meta data
-    XmlElement* metaDataElement = element->createNewChildElement ("MetaData");
+    writer.startElement ("MetaData");
 
-    metaDataElement->setAttribute ("Genre", metaData.genre);
-    metaDataElement->setAttribute ("Instrument", metaData.instrument);
-    metaDataElement->setAttribute ("Location", metaData.location);
-    metaDataElement->setAttribute ("Experience", metaData.experience);
-    metaDataElement->setAttribute ("Age", metaData.age);
-    metaDataElement->setAttribute ("Language", metaData.language);
+    writer.addAttribute ("Genre", metaData.genre);
+    writer.addAttribute ("Instrument", metaData.instrument);
+    writer.addAttribute ("Location", metaData.location);
+    writer.addAttribute ("Experience", metaData.experience);
+    writer.addAttribute ("Age", metaData.age);
+    writer.addAttribute ("Language", metaData.language);
 
-    return warning;
+    writer.endElement();
 }
 
 WarningID SAFEAudioProcessor::saveSemanticData (const String& newDescriptors, const SAFEMetaData& metaData)
 {
+    // the samples were analysed on the analysis thread before the save was scheduled
+    WarningID warning = NoWarning;
+
+    SemanticDataStore::RecordInfo info;
+
     // separate different descriptors
-    StringArray descriptors;
-    descriptors.addTokens (newDescriptors, " ,;", String::empty);
-    int numDescriptors = descriptors.size();
+    info.descriptors.addTokens (newDescriptors, " ,;", String::empty);
+
+    info.pluginCode = getPluginCode();
+    info.numInputs = numInputs;
+    info.numOutputs = numOutputs;
+    info.sampleRate = fs;
+    info.analysisTime = getAnalysisTime();
+    info.parameters = parametersToSave;
+    info.metaData = metaData;
+
+    // the features are written straight from the feature extractors
+    AudioFeatureBinaryFormat::Writer unprocessedFeatures, processedFeatures;
+    unprocessedFeatureExtractor.addFeaturesToBinaryWriter (unprocessedFeatures);
+    processedFeatureExtractor.addFeaturesToBinaryWriter (processedFeatures);
+
+    // other instances of this plug-in share the file
+    const ScopedLock fileLock (analysisScheduler->getFileLock (semanticDataFile));
+
+    // anything a failed append leaves in the log is cleared by the next one, the user just needs telling
+    if (! semanticDataStore.appendRecord (info, unprocessedFeatures, processedFeatures))
+    {
+        warning = CannotSaveData;
+    }
 
-    updateSemanticDataElement();
+    return warning;
+}
 
-    XmlElement* descriptorElement = semanticDataElement->createNewChildElement ("SemanticData");
+WarningID SAFEAudioProcessor::loadSemanticData (const String& descriptor)
+{
+    StringArray descriptorArray;
+    descriptorArray.addTokens (descriptor, " ,;", String::empty);
 
-    for (int descriptor = 0; descriptor < numDescriptors; ++descriptor)
+    if (descriptorArray.size() == 0)
     {
-        String descriptorString = descriptors [descriptor];
-        String descriptorName = String ("Descriptor") + String (descriptor);
-
-        descriptorElement->setAttribute (descriptorName, descriptorString);
+        return DescriptorNotInFile;
     }
-    
-    WarningID warning = populateXmlElementWithSemanticData (descriptorElement, metaData);
 
-    if (warning != NoWarning)
+    String firstDescriptor = descriptorArray [0];
+
+    // the most recent record with the descriptor we want is looked up in the index
+    SemanticDataStore::RecordInfo info;
+
     {
-        return warning;
+        const ScopedLock fileLock (analysisScheduler->getFileLock (semanticDataFile));
+
+        semanticDataStore.synchronise();
+
+        const Array <int>& records = semanticDataStore.getRecordsWithDescriptor (firstDescriptor);
+
+        if (records.size() == 0 || ! semanticDataStore.readRecordInfo (records.getLast(), info))
+        {
+            return NoWarning;
+        }
     }
 
-    // save to file
-    semanticDataElement->writeToFile (semanticDataFile, "");
+    for (int i = 0; i < info.parameters.size(); ++i)
+    {
+        setScaledParameterNotifyingHost (i, info.parameters [i]);
+    }
 
-    return warning;
+    return NoWarning;
 }
 
-WarningID SAFEAudioProcessor::loadSemanticData (const String& descriptor)
+WarningID SAFEAudioProcessor::loadAveragedSemanticData (const String& descriptor)
 {
     StringArray descriptorArray;
     descriptorArray.addTokens (descriptor, " ,;", String::empty);
 
-    updateSemanticDataElement();
-
     if (descriptorArray.size() == 0)
     {
         return DescriptorNotInFile;
@@ -401,105 +557,56 @@ WarningID SAFEAudioProcessor::loadSemanticData (const String& descriptor)
 
     String firstDescriptor = descriptorArray [0];
 
-    // go through XML elements and look for the first one with the descriptor we want
-    forEachXmlChildElement (*semanticDataElement, descriptorElement)
+    // the averages are kept up to date as records are saved
+    Array <double> parameterMeans;
+
     {
-        int numAttributes = descriptorElement->getNumAttributes();
+        const ScopedLock fileLock (analysisScheduler->getFileLock (semanticDataFile));
 
-        for (int attribute = 0; attribute < numAttributes; ++ attribute)
-        {
-            String attributeValue = descriptorElement->getAttributeValue (attribute);
+        semanticDataStore.synchronise();
 
-            if (attributeValue == firstDescriptor)
-            {
-                XmlElement *parameterElement = descriptorElement->getChildByName ("ParameterSettings");
-                String parameterValueString = parameterElement->getStringAttribute ("Values");
+        const SemanticDataStore::ParameterStatistics* statistics = semanticDataStore.getParameterStatistics (getPluginCode(), firstDescriptor);
 
-                StringArray parameterValues;
-                parameterValues.addTokens (parameterValueString, ",", "");
-                parameterValues.removeEmptyStrings();
+        if (statistics == nullptr)
+        {
+            return DescriptorNotInFile;
+        }
 
-                for (int i = 0; i < parameterValues.size(); ++i)
-                {
-                    setScaledParameterNotifyingHost (i, parameterValues [i].getDoubleValue());
-                }
-            }
+        for (int i = 0; i < statistics->getNumParameters(); ++i)
+        {
+            parameterMeans.add (statistics->getMean (i));
         }
     }
 
+    for (int i = 0; i < parameterMeans.size(); ++i)
+    {
+        setScaledParameterNotifyingHost (i, parameterMeans [i]);
+    }
+
     return NoWarning;
 }
 
 WarningID SAFEAudioProcessor::sendDataToServer (const String& newDescriptors, const SAFEMetaData& metaData)
 {
-    XmlElement descriptorElement ("SemanticData");
+    // the samples were analysed on the analysis thread before the save was scheduled
+    WarningID warning = NoWarning;
+    
+    // the record is spooled and sent in the background, so saving doesn't wait for the network
+    MemoryOutputStream stream;
 
-    descriptorElement.setAttribute ("Descriptors", newDescriptors);
+    {
+        XmlStreamWriter writer (stream);
 
-    WarningID warning = populateXmlElementWithSemanticData (&descriptorElement, metaData);
+        writer.startElement ("SemanticData");
+        writer.addAttribute ("Descriptors", newDescriptors);
 
-    if (warning != NoWarning)
-    {
-        return warning;
+        writeSemanticDataToXmlStream (writer, metaData);
     }
-    
-    // save to file
-    File documentsDirectory (File::getSpecialLocation (File::userDocumentsDirectory));
-    File dataDirectory (documentsDirectory.getChildFile ("SAFEPluginData"));
 
-    File tempDataFile = dataDirectory.getChildFile ("tempData.xml");
-
-    descriptorElement.writeToFile (tempDataFile, "");
-
-    #if JUCE_LINUX
-    CURLcode res;
- 
-    struct curl_httppost *formpost=NULL;
-    struct curl_httppost *lastptr=NULL;
-    struct curl_slist *headerlist=NULL;
-    static const char buf[] = "Expect:";
- 
-    /* Fill in the file upload field */ 
-    curl_formadd(&formpost,
-                 &lastptr,
-                 CURLFORM_COPYNAME, "DataFile",
-                 CURLFORM_FILE, tempDataFile.getFullPathName().toRawUTF8(),
-                 CURLFORM_END);
- 
-    /* Fill in the filename field */ 
-    curl_formadd(&formpost,
-                 &lastptr,
-                 CURLFORM_COPYNAME, "DataFile",
-                 CURLFORM_COPYCONTENTS, tempDataFile.getFullPathName().toRawUTF8(),
-                 CURLFORM_END);
- 
- 
-    /* Fill in the submit field too, even if this is rarely needed */ 
-    curl_formadd(&formpost,
-                 &lastptr,
-                 CURLFORM_COPYNAME, "submit",
-                 CURLFORM_COPYCONTENTS, "send",
-                 CURLFORM_END);
- 
-    headerlist = curl_slist_append(headerlist, buf);
-    if(curl) 
-    {
-        curl_easy_setopt(curl->curl, CURLOPT_URL, "http://193.60.133.151/newsafe/uploadterm.php");
-        curl_easy_setopt(curl->curl, CURLOPT_HTTPPOST, formpost);
- 
-        res = curl_easy_perform(curl->curl);
- 
-        curl_formfree(formpost);
-        curl_slist_free_all (headerlist);
-    }
-    #else
-    URL dataUpload ("http://193.60.133.151/newsafe/uploadterm.php");
-    dataUpload = dataUpload.withFileToUpload ("DataFile", tempDataFile, "text/xml");
-
-    ScopedPointer <InputStream> stream (dataUpload.createInputStream (true));
-    #endif
-
-    tempDataFile.deleteFile();
+    if (! uploadSpool->addRecord (stream.getMemoryBlock()))
+    {
+        warning = CannotSaveData;
+    }
 
     return warning;
 }
@@ -511,68 +618,78 @@ WarningID SAFEAudioProcessor::getServerData (const String& descriptor)
     descriptorArray.addTokens (descriptor, " ,;", String::empty);
     descriptorArray.removeEmptyStrings();
 
-    if (descriptorArray.size() > 0)
+    if (descriptorArray.size() == 0)
     {
-        // we just take the first descriptor in the box
-        // This will be changed to a more comprehensive model soon...
-        String firstDescriptor = descriptorArray [0];
-        
-        // send call to script with user descriptor...
-        URL downloadParamData ("http://193.60.133.151/newsafe/getaverageparameters.php");
-        downloadParamData = downloadParamData.withParameter("Plugin", getPluginCode());
-        downloadParamData = downloadParamData.withParameter("Descriptor", firstDescriptor);
-        
-        // just returns an ordered list of strings for the params...
-        String dbOutput = downloadParamData.readEntireTextStream();
+        return DescriptorNotOnServer;
+    }
 
-        if (dbOutput == "Descriptor not found.")
-        {
-            return DescriptorNotOnServer;
-        }
+    // we just take the first descriptor in the box
+    // This will be changed to a more comprehensive model soon...
+    requestedServerDescriptor = descriptorArray [0];
 
-        StringArray parameterSettings;
-        parameterSettings.addTokens (dbOutput, "\n", "");
-        parameterSettings.removeEmptyStrings();
+    // the parameters are set in averageParametersReceived()
+    serverRequests->requestAverageParameters (getPluginCode(), requestedServerDescriptor, this);
 
-        for (int i = 0; i < parameterSettings.size(); ++i)
-        {
-            double parameterValue = parameterSettings [i].fromFirstOccurrenceOf (", ", false, false).getDoubleValue();
+    return NoWarning;
+}
+
+void SAFEAudioProcessor::averageParametersReceived (const String& /*pluginCode*/, const String& descriptor,
+                                                    const Array <double>& parameterValues, bool reachedServer)
+{
+    // only the descriptor asked for most recently gets loaded
+    if (descriptor != requestedServerDescriptor)
+    {
+        return;
+    }
+
+    requestedServerDescriptor = String::empty;
+
+    if (isRecording())
+    {
+        sendWarningToEditor (LoadingDisabled);
+        return;
+    }
 
-            setScaledParameterNotifyingHost (i, parameterValue);                        
+    if (! reachedServer)
+    {
+        // fall back on the averages saved locally
+        if (loadAveragedSemanticData (descriptor) != NoWarning)
+        {
+            sendWarningToEditor (CannotReachServer);
         }
+
+        return;
     }
-    else
+
+    if (parameterValues.size() == 0)
     {
-        return DescriptorNotOnServer;
+        sendWarningToEditor (DescriptorNotOnServer);
+        return;
     }
 
-	return NoWarning;
+    for (int i = 0; i < parameterValues.size(); ++i)
+    {
+        setScaledParameterNotifyingHost (i, (float) parameterValues [i]);
+    }
 }
 
 //==========================================================================
 //      Analysis Thread
 //==========================================================================
-WarningID SAFEAudioProcessor::startAnalysisThread()
+WarningID SAFEAudioProcessor::scheduleSave()
 {
-    if (analysisThread->isThreadRunning())
+    if (! analysisScheduler->addJob (saveJob))
     {
-        resetRecording();
-        sendWarningToEditor (AnalysisThreadBusy);
         return AnalysisThreadBusy;
     }
-    else
-    {
-        resetRecording();
-        analysisThread->setParameters (descriptorsToSave, metaDataToSave, sendToServer);
-        analysisThread->startThread();
-    }
 
     return NoWarning;
 }
 
 bool SAFEAudioProcessor::isThreadRunning()
 {
-    return analysisThread->isThreadRunning();
+    return analysisBusy.get() != 0 || recordedBlockFifo.getNumReady() > 0 || preRollRecordingPending.get() != 0
+           || analysisScheduler->isJobPending (saveJob);
 }
 
 void SAFEAudioProcessor::sendWarningToEditor (WarningID warning)
@@ -635,12 +752,53 @@ void SAFEAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     unprocessedBuffer.setSize (numInputs, numSamplesToRecord);
     processedBuffer.setSize (numOutputs, numSamplesToRecord);
 
-    unprocessedFeatureExtractor.initialise (numInputs, getAnalysisFrameSize(), getAnalysisStepSize(), sampleRate);
-    processedFeatureExtractor.initialise (numOutputs, getAnalysisFrameSize(), getAnalysisStepSize(), sampleRate);
+    // the pre-roll rings have some room to spare so a block can be written while they are read
+    if (preRollCaptureEnabled)
+    {
+        int preRollSize = numSamplesToRecord + jmax (samplesPerBlock, getAnalysisFrameSize());
+
+        unprocessedPreRoll.setSize (numInputs, preRollSize);
+        processedPreRoll.setSize (numOutputs, preRollSize);
+
+        ++preRollParameterSequence;
+        preRollParameterValues.clearQuick();
+
+        for (int i = 0; i < parameters.size(); ++i)
+        {
+            preRollParameterValues.add (parameters [i]->getScaledValue());
+        }
+
+        ++preRollParameterSequence;
+        preRollSteadyStart = 0;
+    }
+    else
+    {
+        unprocessedPreRoll.setSize (0, 0);
+        processedPreRoll.setSize (0, 0);
+    }
+
+    unprocessedFeatureExtractor.initialise (numInputs, getAnalysisFrameSize(), getAnalysisStepSize(), sampleRate, numSamplesToRecord);
+    processedFeatureExtractor.initialise (numOutputs, getAnalysisFrameSize(), getAnalysisStepSize(), sampleRate, numSamplesToRecord);
+
+    usingParameterRamps = parameterRampsEnabled;
+    maximumRampSize = jmax (1, samplesPerBlock);
+
+    parametersChanged = 0;
+    smoothingParameters.allocate ((size_t) jmax (1, parameters.size()), false);
+    parameterSmoothing.allocate ((size_t) jmax (1, parameters.size()), true);
+    numSmoothingParameters = 0;
 
     for (int i = 0; i < parameters.size(); ++i)
     {
         parameters [i]->setSampleRate (sampleRate);
+        parameters [i]->setRampsEnabled (usingParameterRamps, maximumRampSize);
+        parameters [i]->updateValue();
+        parameterUpdateCalculations (i);
+
+        if (parameters [i]->isInterpolating())
+        {
+            addSmoothingParameter (i);
+        }
     }
 
     controlBlockSize = (int) (sampleRate / controlRate);
@@ -655,17 +813,26 @@ void SAFEAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& mi
 {
     localRecording = recording;
 
+    if (localRecording)
+    {
+        localRecordingNumber = currentRecording.get();
+    }
+
     recordUnprocessedSamples (buffer);
 
-    // call the plugin dsp
-    bool parametersInterpolating = false;
+    // pick up any parameter changes made since the last block
+    parametersMoved = false;
+    updateParameters();
 
-    for (int i = 0; i < parameters.size(); ++i)
+    bool parametersInterpolating = numSmoothingParameters > 0;
+    parametersMoved = parametersMoved || parametersInterpolating;
+
+    // call the plugin dsp
+    if (usingParameterRamps)
     {
-        parametersInterpolating = parametersInterpolating || parameters [i]->isInterpolating();
+        processWithParameterRamps (buffer, midiMessages);
     }
-
-    if (parametersInterpolating)
+    else if (parametersInterpolating)
     {
         int numChannels = buffer.getNumChannels();
         int numSamples = buffer.getNumSamples();
@@ -698,14 +865,7 @@ void SAFEAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& mi
 
             for (int block = 0; block < numControlBlocks; ++block)
             {
-                for (int i = 0; i < parameters.size(); ++i)
-                {
-                    if (parameters [i]->isInterpolating())
-                    {
-                        parameters [i]->smoothValues();
-                        parameterUpdateCalculations (i);
-                    }
-                }
+                smoothParameters();
 
                 AudioSampleBuffer controlBlock (buffer.getArrayOfWritePointers(), numChannels, sampleNumber, controlBlockSize);
 
@@ -721,14 +881,7 @@ void SAFEAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& mi
 
             if (samplesLeft)
             {
-                for (int i = 0; i < parameters.size(); ++i)
-                {
-                    if (parameters [i]->isInterpolating())
-                    {
-                        parameters [i]->smoothValues();
-                        parameterUpdateCalculations (i);
-                    }
-                }
+                smoothParameters();
 
                 AudioSampleBuffer controlBlock (buffer.getArrayOfWritePointers(), numChannels, sampleNumber, samplesLeft);
 
@@ -757,6 +910,125 @@ void SAFEAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& mi
 
     updatePlayHead();
     recordProcessedSamples (buffer);
+
+    if (localRecording || recordedBlockPending)
+    {
+        publishRecordedBlock();
+    }
+}
+
+void SAFEAudioProcessor::setParameterRampsEnabled (bool shouldUseRamps)
+{
+    parameterRampsEnabled = shouldUseRamps;
+}
+
+const float* SAFEAudioProcessor::getParameterRamp (int index) const
+{
+    return parameters [index]->getRamp();
+}
+
+void SAFEAudioProcessor::processWithParameterRamps (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+    int numChannels = buffer.getNumChannels();
+    int numSamples = buffer.getNumSamples();
+
+    remainingControlBlockSamples = 0;
+
+    if (numSamples <= maximumRampSize)
+    {
+        fillParameterRamps (numSamples);
+        pluginProcessing (buffer, midiMessages);
+
+        return;
+    }
+
+    // the host sent a bigger block than it said it would, so it has to be split up
+    for (int sampleNumber = 0; sampleNumber < numSamples; sampleNumber += maximumRampSize)
+    {
+        int blockSize = jmin (maximumRampSize, numSamples - sampleNumber);
+
+        fillParameterRamps (blockSize);
+
+        AudioSampleBuffer rampBlock (buffer.getArrayOfWritePointers(), numChannels, sampleNumber, blockSize);
+
+        midiControlBlock.clear();
+        midiControlBlock.addEvents (midiMessages, sampleNumber, blockSize, -sampleNumber);
+
+        pluginProcessing (rampBlock, midiControlBlock);
+    }
+}
+
+void SAFEAudioProcessor::fillParameterRamps (int numSamples)
+{
+    // parameters which aren't moving already have their value in their ramps
+    for (int i = numSmoothingParameters; --i >= 0;)
+    {
+        const int index = smoothingParameters [i];
+
+        parameters [index]->fillRamp (numSamples);
+        parameterUpdateCalculations (index);
+
+        if (! parameters [index]->isInterpolating())
+        {
+            removeSmoothingParameter (i);
+        }
+    }
+}
+
+void SAFEAudioProcessor::updateParameters()
+{
+    // nothing has been set since the last block, which is the usual case
+    if (! parametersChanged.compareAndSetBool (0, 1))
+    {
+        return;
+    }
+
+    // anything set after the flag was cleared will set it again for the next block
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        if (parameters [i]->updateValue())
+        {
+            parameterUpdateCalculations (i);
+            parametersMoved = true;
+
+            if (parameters [i]->isInterpolating())
+            {
+                addSmoothingParameter (i);
+            }
+        }
+    }
+}
+
+void SAFEAudioProcessor::addSmoothingParameter (int index)
+{
+    if (! parameterSmoothing [index])
+    {
+        parameterSmoothing [index] = true;
+        smoothingParameters [numSmoothingParameters++] = index;
+    }
+}
+
+void SAFEAudioProcessor::removeSmoothingParameter (int position)
+{
+    // the last one takes its place, the loops go backwards so it has already been seen
+    parameterSmoothing [smoothingParameters [position]] = false;
+    smoothingParameters [position] = smoothingParameters [--numSmoothingParameters];
+}
+
+void SAFEAudioProcessor::smoothParameters()
+{
+    for (int i = numSmoothingParameters; --i >= 0;)
+    {
+        const int index = smoothingParameters [i];
+
+        parameters [index]->smoothValues();
+        parameterUpdateCalculations (index);
+
+        if (! parameters [index]->isInterpolating())
+        {
+            removeSmoothingParameter (i);
+        }
+    }
 }
 
 //==========================================================================
@@ -771,6 +1043,13 @@ bool SAFEAudioProcessor::startRecording (const String& descriptors, const SAFEMe
 {
     if (readyToSave)
     {
+        // the analysis thread could still be reading an abandoned recording
+        if (isThreadRunning())
+        {
+            sendWarningToEditor (AnalysisThreadBusy);
+            return false;
+        }
+
         currentUnprocessedAnalysisFrame = 0;
         currentProcessedAnalysisFrame = 0;
         unprocessedTap = 0;
@@ -783,8 +1062,23 @@ bool SAFEAudioProcessor::startRecording (const String& descriptors, const SAFEMe
         sendToServer = newSendToServer;
         cacheCurrentParameters();
 
-        recording = true;
+        saveJob->setParameters (descriptorsToSave, metaDataToSave, sendToServer);
+
+        // the audio thread tags the blocks it records with this
+        ++currentRecording;
+
+        // if the audio has already been heard there is no need to wait for it again
+        if (recordPreRollSamples())
+        {
+            readyToSave = false;
+            preRollRecordingPending = 1;
+            recordedBlocksAvailable.signal();
+
+            return true;
+        }
+
         readyToSave = false;
+        recording = true;
 
         startTimer (50);
         return true;
@@ -795,6 +1089,11 @@ bool SAFEAudioProcessor::startRecording (const String& descriptors, const SAFEMe
     }
 }
 
+void SAFEAudioProcessor::setPreRollCaptureEnabled (bool shouldCapture)
+{
+    preRollCaptureEnabled = shouldCapture;
+}
+
 bool SAFEAudioProcessor::isRecording()
 {
     return recording;
@@ -826,6 +1125,12 @@ void SAFEAudioProcessor::setSpectralAnalysisWindowingFunction (void (*newWindowi
     processedFeatureExtractor.setWindowingFunction (newWindowingFunction);
 }
 
+void SAFEAudioProcessor::setSpectralAnalysisWindowType (AnalysisWindows::Type newWindowType, double kaiserBeta)
+{
+    unprocessedFeatureExtractor.setWindowType (newWindowType, kaiserBeta);
+    processedFeatureExtractor.setWindowType (newWindowType, kaiserBeta);
+}
+
 //==========================================================================
 //      Methods to Create New Parameters
 //==========================================================================
@@ -858,6 +1163,13 @@ void SAFEAudioProcessor::addVampPlugin (const String &libraryName, const String
     processedFeatureExtractor.addVampPlugin (libraryName, pluginName);
 }
 
+void SAFEAudioProcessor::setFeaturePrecision (const String &featureName, double precision)
+{
+    unprocessedFeatureExtractor.setFeaturePrecision (featureName, precision);
+    processedFeatureExtractor.setFeaturePrecision (featureName, precision);
+    semanticDataStore.setFeatureValueType (AudioFeatureBinaryFormat::CompressedValues);
+}
+
 //==========================================================================
 //      Buffer Playing Audio For Analysis
 //==========================================================================
@@ -874,12 +1186,17 @@ void SAFEAudioProcessor::recordUnprocessedSamples (AudioSampleBuffer& buffer)
 
         for (int channel = 0; channel < numOutputs; ++channel)
         {
-            unprocessedBuffer.copyFrom (channel, unprocessedTap, buffer, channel, 0, numSamples);
+            unprocessedBuffer.copyFrom (channel, unprocessedTap.get(), buffer, channel, 0, numSamples);
         }
 
         unprocessedTap += numSamples;
         unprocessedSamplesToRecord -= numSamples;
     }
+
+    if (preRollCaptureEnabled)
+    {
+        unprocessedPreRoll.write (buffer, 0, buffer.getNumSamples());
+    }
 }
 
 void SAFEAudioProcessor::recordProcessedSamples (AudioSampleBuffer& buffer)
@@ -895,28 +1212,230 @@ void SAFEAudioProcessor::recordProcessedSamples (AudioSampleBuffer& buffer)
 
         for (int channel = 0; channel < numOutputs; ++channel)
         {
-            processedBuffer.copyFrom (channel, processedTap, buffer, channel, 0, numSamples);
+            processedBuffer.copyFrom (channel, processedTap.get(), buffer, channel, 0, numSamples);
         }
 
         processedTap += numSamples;
         processedSamplesToRecord -= numSamples;
 
+        // the analysis thread will pick up from here, the timer is stopped on the
+        // message thread as stopping it here could block
         if (processedSamplesToRecord == 0)
         {
-            startAnalysisThread();
+            recording = false;
+        }
+    }
+
+    if (preRollCaptureEnabled)
+    {
+        bool steady = playHead.isPlaying && ! parametersMoved;
+
+        // the message thread reads the values, the sequence tells it if they changed under it
+        if (parametersMoved)
+        {
+            ++preRollParameterSequence;
+
+            for (int i = 0; i < preRollParameterValues.size(); ++i)
+            {
+                preRollParameterValues.getReference (i) = parameters [i]->getScaledValue();
+            }
+
+            ++preRollParameterSequence;
+        }
+
+        // this block wasn't all made with the same settings, so the steady audio starts after it
+        if (! steady)
+        {
+            preRollSteadyStart = processedPreRoll.getNumSamplesWritten() + buffer.getNumSamples();
+        }
+
+        processedPreRoll.write (buffer, 0, buffer.getNumSamples());
+    }
+}
+
+bool SAFEAudioProcessor::recordPreRollSamples()
+{
+    if (! preRollCaptureEnabled || numSamplesToRecord <= 0)
+    {
+        return false;
+    }
+
+    // the unprocessed samples for a block are always written before the processed ones
+    const int64 endPosition = processedPreRoll.getNumSamplesWritten();
+
+    if (endPosition - preRollSteadyStart.get() < numSamplesToRecord)
+    {
+        return false;
+    }
+
+    if (! unprocessedPreRoll.read (unprocessedBuffer, endPosition, numSamplesToRecord)
+        || ! processedPreRoll.read (processedBuffer, endPosition, numSamplesToRecord))
+    {
+        return false;
+    }
+
+    // check the parameters weren't changed while we copied, and that the settings
+    // being saved are the ones the audio was made with
+    if (endPosition - preRollSteadyStart.get() < numSamplesToRecord)
+    {
+        return false;
+    }
+
+    // the audio thread may be writing the values, if it started or finished while
+    // we compared them they can't be trusted
+    const int sequence = preRollParameterSequence.get();
+
+    if ((sequence & 1) != 0)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < preRollParameterValues.size(); ++i)
+    {
+        if (parametersToSave [i] != preRollParameterValues [i])
+        {
+            return false;
         }
     }
+
+    if (preRollParameterSequence.get() != sequence)
+    {
+        return false;
+    }
+
+    unprocessedTap = numSamplesToRecord;
+    processedTap = numSamplesToRecord;
+    unprocessedSamplesToRecord = 0;
+    processedSamplesToRecord = 0;
+
+    return true;
 }
 
 //==========================================================================
 //      Buffer Playing Audio For Analysis
 //==========================================================================
-WarningID SAFEAudioProcessor::analyseRecordedSamples()
+void SAFEAudioProcessor::publishRecordedBlock()
 {
-    unprocessedFeatureExtractor.analyseAudio (unprocessedBuffer);
-    processedFeatureExtractor.analyseAudio (processedBuffer);
+    int start1, size1, start2, size2;
+    recordedBlockFifo.prepareToWrite (1, start1, size1, start2, size2);
 
-    return NoWarning;
+    // the positions are where the recording has got up to, so if the analysis thread
+    // has fallen behind the next block will cover this one as well
+    if (size1 == 0)
+    {
+        recordedBlockPending = true;
+        return;
+    }
+
+    RecordedBlock& block = recordedBlocks [start1];
+    block.recording = localRecordingNumber;
+    block.unprocessedEnd = unprocessedTap.get();
+    block.processedEnd = processedTap.get();
+
+    recordedBlockFifo.finishedWrite (1);
+    recordedBlockPending = false;
+
+    recordedBlocksAvailable.signal();
+}
+
+void SAFEAudioProcessor::analyseRecordedBlocks()
+{
+    analysisBusy = 1;
+
+    // recordings taken from the pre-roll buffers are ready all at once
+    if (preRollRecordingPending.get() != 0)
+    {
+        RecordedBlock block;
+        block.recording = currentRecording.get();
+        block.unprocessedEnd = numSamplesToRecord;
+        block.processedEnd = numSamplesToRecord;
+
+        analyseRecordedBlock (block);
+        preRollRecordingPending = 0;
+    }
+
+    for (;;)
+    {
+        int start1, size1, start2, size2;
+        recordedBlockFifo.prepareToRead (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            break;
+        }
+
+        RecordedBlock block = recordedBlocks [start1];
+        recordedBlockFifo.finishedRead (1);
+
+        analyseRecordedBlock (block);
+    }
+
+    analysisBusy = 0;
+}
+
+void SAFEAudioProcessor::analyseRecordedBlock (const RecordedBlock& block)
+{
+    // a new recording starts the analysis from scratch
+    if (block.recording != analysisRecording)
+    {
+        unprocessedFeatureExtractor.resetAnalysis();
+        processedFeatureExtractor.resetAnalysis();
+        unprocessedSamplesAnalysed = 0;
+        processedSamplesAnalysed = 0;
+
+        analysisRecording = block.recording;
+        analysisFinished = false;
+    }
+
+    if (analysisFinished)
+    {
+        return;
+    }
+
+    analyseSamples (block.unprocessedEnd, block.processedEnd);
+
+    // abandoned recordings never get this far
+    if (block.processedEnd >= numSamplesToRecord)
+    {
+        analysisFinished = true;
+
+        unprocessedFeatureExtractor.finishAnalysis();
+        processedFeatureExtractor.finishAnalysis();
+
+        WarningID warning = scheduleSave();
+
+        if (warning != NoWarning)
+        {
+            sendWarningToEditor (warning);
+            readyToSave = true;
+        }
+    }
+}
+
+void SAFEAudioProcessor::analyseSamples (int unprocessedSamplesRecorded, int processedSamplesRecorded)
+{
+    // the two extractors share nothing so their jobs all go in together
+    OwnedArray <ThreadPoolJob> analysisJobs;
+
+    if (unprocessedSamplesRecorded > unprocessedSamplesAnalysed)
+    {
+        unprocessedFeatureExtractor.addAnalysisJobs (analysisJobs,
+                                                     unprocessedBuffer, 
+                                                     unprocessedSamplesAnalysed, 
+                                                     unprocessedSamplesRecorded - unprocessedSamplesAnalysed);
+        unprocessedSamplesAnalysed = unprocessedSamplesRecorded;
+    }
+
+    if (processedSamplesRecorded > processedSamplesAnalysed)
+    {
+        processedFeatureExtractor.addAnalysisJobs (analysisJobs,
+                                                   processedBuffer, 
+                                                   processedSamplesAnalysed, 
+                                                   processedSamplesRecorded - processedSamplesAnalysed);
+        processedSamplesAnalysed = processedSamplesRecorded;
+    }
+
+    analysisThreadPool->runJobsAndWait (analysisJobs);
 }
 
 //==========================================================================
@@ -941,8 +1460,39 @@ void SAFEAudioProcessor::updatePlayHead()
 //==========================================================================
 void SAFEAudioProcessor::updateSemanticDataElement()
 {
-    XmlDocument semanticDataDocument (semanticDataFile);
-    semanticDataElement = semanticDataDocument.getDocumentElement();
+    semanticDataElement = new XmlElement (makeXmlString (JucePlugin_Name + String ("Data")));
+
+    const ScopedLock fileLock (analysisScheduler->getFileLock (semanticDataFile));
+
+    semanticDataStore.synchronise();
+
+    SemanticDataStore::RecordInfo info;
+
+    // only the descriptors and parameters are needed so the features are left on disk
+    for (int record = 0; record < semanticDataStore.getNumRecords(); ++record)
+    {
+        if (! semanticDataStore.readRecordInfo (record, info))
+        {
+            continue;
+        }
+
+        XmlElement* descriptorElement = semanticDataElement->createNewChildElement ("SemanticData");
+
+        for (int descriptor = 0; descriptor < info.descriptors.size(); ++descriptor)
+        {
+            descriptorElement->setAttribute ("Descriptor" + String (descriptor), info.descriptors [descriptor]);
+        }
+
+        String parameterString;
+
+        for (int i = 0; i < info.parameters.size(); ++i)
+        {
+            parameterString += (i > 0 ? ", " : "") + String (info.parameters [i]);
+        }
+
+        XmlElement* parametersElement = descriptorElement->createNewChildElement ("ParameterSettings");
+        parametersElement->setAttribute ("Values", parameterString);
+    }
 }
 
 //==========================================================================
@@ -974,6 +1524,13 @@ bool SAFEAudioProcessor::haveParametersChanged()
 
 void SAFEAudioProcessor::timerCallback()
 {
+    // the recording has finished
+    if (! recording)
+    {
+        stopTimer();
+        return;
+    }
+
     if (haveParametersChanged())
     {
         resetRecording();
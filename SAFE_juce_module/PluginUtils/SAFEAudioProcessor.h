@@ -18,12 +18,18 @@
  *  of which functions are marked final in this documentation. Then DON'T OVERRIDE THEM.
  */
 class SAFEAudioProcessor : public AudioProcessor,
-                           public Timer
+                           public Timer,
+                           public ServerRequestQueue::Listener
 {
 private:
     //==========================================================================
     //      A Class to Put the Analysis on a Separate Thread
     //==========================================================================
+    /** Analyses the blocks the audio thread records as they arrive.
+     *
+     *  The thread is started with the processor and waits on a semaphore, so
+     *  the audio thread never has to start a thread or take a lock.
+     */
     class AnalysisThread : public Thread
     {
     public:
@@ -38,6 +44,29 @@ private:
         //==========================================================================
         void run();
 
+    private:
+        SAFEAudioProcessor* processor;
+    };
+
+    ScopedPointer <AnalysisThread> analysisThread;
+
+    //==========================================================================
+    //      A Job for Saving the Analysed Data on the Shared Scheduler
+    //==========================================================================
+    class SaveJob : public ThreadPoolJob
+    {
+    public:
+        //==========================================================================
+        //      Constructor and Destructor
+        //==========================================================================
+        SaveJob (SAFEAudioProcessor* processorInit);
+        ~SaveJob();
+
+        //==========================================================================
+        //      The Job Callback
+        //==========================================================================
+        JobStatus runJob();
+
         //==========================================================================
         //      Set Some Parameters
         //==========================================================================
@@ -49,14 +78,33 @@ private:
         String descriptors;
         SAFEMetaData metaData;
         bool sendToServer;
+    };
+
+    //==========================================================================
+    //      A Job for Importing Old Xml Data on the Shared Scheduler
+    //==========================================================================
+    class ImportJob : public ThreadPoolJob
+    {
+    public:
+        //==========================================================================
+        //      Constructor and Destructor
+        //==========================================================================
+        ImportJob (const File &xmlFileInit, const File &logFileInit);
+        ~ImportJob();
 
         //==========================================================================
-        //      Lock to ensure only one plug-in saves at a time
+        //      The Job Callback
         //==========================================================================
-        static SpinLock mutex;
+        JobStatus runJob();
+
+    private:
+        File xmlFile, logFile;
+        SharedResourcePointer <AnalysisScheduler> analysisScheduler;
     };
 
-    ScopedPointer <AnalysisThread> analysisThread;
+    ScopedPointer <SaveJob> saveJob;
+    ScopedPointer <ImportJob> importJob;
+    SharedResourcePointer <AnalysisScheduler> analysisScheduler;
 
 public:
     //==========================================================================
@@ -121,6 +169,9 @@ public:
      *  the value of a parameter has been set. Perhaps you need to calculate some filter
      *  coefficients of something.
      *
+     *  Parameters can be set from any thread but this is called on the audio thread,
+     *  before the next block is processed, or from prepareToPlay().
+     *
      *  @param index  the index of the parameter which was set  
      */
     virtual void parameterUpdateCalculations (int /*index*/) {};
@@ -134,7 +185,8 @@ public:
     /** Returns an read only reference to the plug-ins array of parameters.
      *  
      *  The SAFEAudioProcessorEditor class uses this to get the information needed
-     *  to generate its sliders.
+     *  to generate its sliders. Parameters should be set through the processor,
+     *  otherwise processBlock() won't notice they have changed.
      */
     const OwnedArray <SAFEParameter>& getParameterArray();
 
@@ -195,26 +247,48 @@ public:
     //==========================================================================
     //      Semantic Data Parsing
     //==========================================================================
-    /** Returns a pointer to the XmlElement from the file the plug-in saves its descriptors
-     *  to. */
+    /** Returns a pointer to an XmlElement listing the descriptors and parameter settings
+     *  the plug-in has saved locally.
+     *
+     *  This has a SemanticData element for each saved record, without the audio features. */
     XmlElement* getSemanticDataElement();
 
+    /** Returns all the descriptors the plug-in has saved locally. */
+    StringArray getLocalDescriptors();
+
     /** Load a descriptor from a local file.
      *
      *  @param descriptor  the descriptor to load.
      */
     WarningID loadSemanticData (const String& descriptor);
 
+    /** Load the average of the parameter settings saved locally with a descriptor.
+     *
+     *  This doesn't need the server so it can be used offline.
+     *
+     *  @param descriptor  the descriptor to load.
+     */
+    WarningID loadAveragedSemanticData (const String& descriptor);
+
     /** Load a descriptor from the server
+     *
+     *  The parameters are fetched in the background and set when the server
+     *  answers, so this doesn't wait for the network. Any problems loading
+     *  them are sent to the editor as warnings. If the server can't be reached
+     *  the averages saved locally are loaded instead.
      *
      *  @param descriptor  the descriptor to load.
      */
     WarningID getServerData (const String& descriptor);
 
+    /** Implementation of function from ServerRequestQueue::Listener */
+    void averageParametersReceived (const String& pluginCode, const String& descriptor,
+                                    const Array <double>& parameterValues, bool reachedServer);
+
     //==========================================================================
     //      Analysis Thread
     //==========================================================================
-    /** Returns true if the plug-in is currently analysing some audio. */
+    /** Returns true if the plug-in is currently analysing or saving some audio. */
     bool isThreadRunning();
     
     //==========================================================================
@@ -244,6 +318,27 @@ public:
      */
     virtual void pluginProcessing (AudioSampleBuffer& buffer, MidiBuffer& midiMessages) = 0;
 
+    /** Smooth parameters into a ramp buffer for each block rather than splitting blocks up.
+     *
+     *  By default, while a parameter is changing, processBlock() splits the buffer into
+     *  control blocks and calls pluginProcessing() once for each of them, updating the
+     *  parameter values in between. With ramps enabled pluginProcessing() is called once
+     *  for the whole buffer and getParameterRamp() gives the value of each parameter at
+     *  every sample. The value references still hold the value at the end of the block.
+     *
+     *  It takes effect the next time prepareToPlay() is called, so it is best called from
+     *  your constructor.
+     */
+    void setParameterRampsEnabled (bool shouldUseRamps);
+
+    /** Returns the value of a parameter for each sample of the buffer being processed.
+     *
+     *  This should only be used in pluginProcessing() when parameter ramps are enabled.
+     *
+     *  @param index  the index of the parameter to get the ramp for
+     */
+    const float* getParameterRamp (int index) const;
+
     //==========================================================================
     //      Playing & Recording Info
     //==========================================================================
@@ -254,12 +349,25 @@ public:
      *
      *  Returns true if the plug-in started recording. If this returns false it means the 
      *  plug-in was already recording audio from a previous call to this function.
+     *
+     *  If pre-roll capture is enabled and the plug-in has already played enough audio
+     *  without its parameters changing, that audio is analysed straight away rather than
+     *  waiting for more.
      *  
      *  You should not need to call this function. It is called by the editor when the record
      *  button is pressed.
      */
     bool startRecording (const String& descriptors, const SAFEMetaData& metaData, bool newSendToServer);
 
+    /** Keep the last getAnalysisTime() milliseconds of audio at all times.
+     *
+     *  With this enabled the plug-in's input and output are copied into a ring buffer
+     *  during every call to processBlock(), so pressing record can save what was just
+     *  heard. This costs some memory and a copy of each block. It takes effect the next
+     *  time prepareToPlay() is called, so it is best called from your constructor.
+     */
+    void setPreRollCaptureEnabled (bool shouldCapture);
+
     /** Returns true if the plug-in is currently recording audio. */
     bool isRecording();
 
@@ -296,6 +404,15 @@ public:
      */
     void setSpectralAnalysisWindowingFunction (void (*newWindowingFunction) (float* audioData, int numSamples));
 
+    /** Set the type of window used in the spectral analysis.
+     *
+     *  By default the spectral analysis uses a Hann window.
+     *
+     *  @param newWindowType  the type of window to use
+     *  @param kaiserBeta     the beta parameter for Kaiser windows
+     */
+    void setSpectralAnalysisWindowType (AnalysisWindows::Type newWindowType, double kaiserBeta = 8.6);
+
     /** Returns the plug-in's unique plugin code.
      *
      *  This should return the same code set in the introjucer. The string should
@@ -362,6 +479,17 @@ protected:
      */
     void addVampPlugin (const String &libraryName, const String &pluginName);
 
+    /** Save a feature compressed to a given precision.
+     *
+     *  Features are saved as float32 values unless this is called. Once it has
+     *  been called the data is saved compressed, and features with a precision
+     *  of 0 are still saved as float32 values inside the compressed records.
+     *
+     *  @param featureName  the name the feature is saved with
+     *  @param precision    the largest error allowed in the saved values
+     */
+    void setFeaturePrecision (const String &featureName, double precision);
+
     //==========================================================================
     //      Play Head Stuff
     //==========================================================================
@@ -398,6 +526,7 @@ protected:
 
 private:
     bool localRecording;
+    int localRecordingNumber;
 
     OwnedArray <SAFEParameter> parameters;
     Array <float> parametersToSave;
@@ -410,25 +539,78 @@ private:
     //      Semantic Data File Stuff
     //==========================================================================
     File semanticDataFile;
+    SemanticDataStore semanticDataStore;
     ScopedPointer <XmlElement> semanticDataElement;
     void updateSemanticDataElement();
 
     int numAnalysisFrames, currentUnprocessedAnalysisFrame, currentProcessedAnalysisFrame;
     int numSamplesToRecord;
     AudioSampleBuffer unprocessedBuffer, processedBuffer;
-    int unprocessedTap, processedTap;
+    Atomic <int> unprocessedTap, processedTap;
     int unprocessedSamplesToRecord, processedSamplesToRecord;
+    int unprocessedSamplesAnalysed, processedSamplesAnalysed;
+
+    //==========================================================================
+    //      Handing Recorded Audio to the Analysis Thread
+    //==========================================================================
+    /** How far a recording has got, the samples before these positions can be analysed. */
+    struct RecordedBlock
+    {
+        int recording;
+        int unprocessedEnd, processedEnd;
+    };
+
+    // a wait-free queue from the audio thread to the analysis thread
+    AbstractFifo recordedBlockFifo;
+    HeapBlock <RecordedBlock> recordedBlocks;
+    RealtimeSemaphore recordedBlocksAvailable;
+    bool recordedBlockPending;
+
+    Atomic <int> currentRecording, preRollRecordingPending, analysisBusy;
+
+    // only used on the analysis thread
+    int analysisRecording;
+    bool analysisFinished;
+
+    bool preRollCaptureEnabled;
+    PreRollBuffer unprocessedPreRoll, processedPreRoll;
+    Array <float> preRollParameterValues;
+    Atomic <int> preRollParameterSequence;   // odd while the values above are being written
+    Atomic <int64> preRollSteadyStart;
 
     SAFEFeatureExtractor unprocessedFeatureExtractor, processedFeatureExtractor;
+    SharedResourcePointer <AnalysisThreadPool> analysisThreadPool;
 
     double controlRate;
     int controlBlockSize;
     int remainingControlBlockSamples;
     MidiBuffer midiControlBlock;
 
-    #if JUCE_LINUX
-    SharedResourcePointer <CurlHolder> curl;
-    #endif
+    bool parameterRampsEnabled, usingParameterRamps;
+    int maximumRampSize;
+
+    // set by any thread when a parameter is set, so idle blocks needn't look at every parameter
+    Atomic <int> parametersChanged;
+
+    // the indices of the parameters which are interpolating, with a flag for each
+    // parameter saying if it is in the list, only used on the audio thread - the
+    // space is allocated in prepareToPlay() so nothing is allocated while playing
+    HeapBlock <int> smoothingParameters;
+    HeapBlock <bool> parameterSmoothing;
+    int numSmoothingParameters;
+    bool parametersMoved;
+
+    void addSmoothingParameter (int index);
+    void removeSmoothingParameter (int position);
+
+    void processWithParameterRamps (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+    void fillParameterRamps (int numSamples);
+    void updateParameters();
+    void smoothParameters();
+
+    SharedResourcePointer <UploadSpool> uploadSpool;
+    SharedResourcePointer <ServerRequestQueue> serverRequests;
+    String requestedServerDescriptor;
 
     //==========================================================================
     //      Recording Tests
@@ -445,16 +627,20 @@ private:
     /** Set up a local file for the descriptors to be saved to.
      *
      *  This should get put in the user's Documents directory in a new
-     *  directory called SAFEPluginData.
+     *  directory called SAFEPluginData. Any records in an xml data file from
+     *  an older version are moved into the new file the first time.
      */
     void initialiseSemanticDataFile();
 
-    /** Populate an XmlElement with the latest set of audio feature data.
+    /** Write the latest set of audio feature data to an xml stream.
      *
-     *  @param element   a pointer to the XmlElement to populate
+     *  The data is written as children of the element currently open in the
+     *  writer. The recorded samples should have been analysed first.
+     *
+     *  @param writer    the writer to use
      *  @param metaData  the user's meta data to save alongside the feature data
      */
-    WarningID populateXmlElementWithSemanticData (XmlElement* element, const SAFEMetaData& metaData);
+    void writeSemanticDataToXmlStream (XmlStreamWriter& writer, const SAFEMetaData& metaData);
 
     /** Save semantic data locally.
      *  
@@ -464,14 +650,16 @@ private:
     WarningID saveSemanticData (const String& newDescriptors, const SAFEMetaData& metaData);
 
     /** Save semantic data to the server.
+     *
+     *  The data is added to the upload spool, which sends it in the background.
      *  
      *  @param newDescriptors  the descriptors to save
      *  @param metaData        the users meta data to save
      */
     WarningID sendDataToServer (const String& newDescriptors, const SAFEMetaData& metaData);
 
-    /** Starts the thread which analysis the audio. */
-    WarningID startAnalysisThread();
+    /** Hands the analysed audio over to the scheduler to be saved. */
+    WarningID scheduleSave();
 
     //==========================================================================
     //      Buffer Playing Audio For Analysis
@@ -494,11 +682,35 @@ private:
      */
     void recordProcessedSamples (AudioSampleBuffer& buffer);
 
+    /** Copies the audio in the pre-roll buffers into the recording buffers.
+     *
+     *  Returns false if not enough audio has been played since the parameters last
+     *  changed or the host last stopped.
+     */
+    bool recordPreRollSamples();
+
     //==========================================================================
     //      Analyse Buffered Audio
     //==========================================================================
-    /** Analyses the samples in the recording buffers. */
-    WarningID analyseRecordedSamples();
+    /** Tells the analysis thread how far the current recording has got.
+     *
+     *  This is called at the end of processBlock() while recording. It doesn't
+     *  lock or allocate.
+     */
+    void publishRecordedBlock();
+
+    /** Analyses everything the audio thread has recorded since the last call.
+     *
+     *  This is called on the analysis thread whenever it is woken up, so the
+     *  analysis is done bit by bit rather than all at the end.
+     */
+    void analyseRecordedBlocks();
+
+    /** Analyses one block and schedules the save once the recording is complete. */
+    void analyseRecordedBlock (const RecordedBlock& block);
+
+    /** Passes the samples up to some positions in the recording buffers to the feature extractors. */
+    void analyseSamples (int unprocessedSamplesRecorded, int processedSamplesRecorded);
 
     //==========================================================================
     //      Make String ok for use in XML
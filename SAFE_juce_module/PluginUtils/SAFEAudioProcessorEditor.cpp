@@ -8,7 +8,7 @@ SAFEAudioProcessorEditor::SAFEAudioProcessorEditor (SAFEAudioProcessor* ownerFil
       metaDataButton ("Meta Data"),
       fileAccessButton ("File Access"),
       infoButton ("i"),
-      descriptorLoadScreen (ownerFilter->getPluginCode()),
+      descriptorLoadScreen (*ownerFilter),
       parameters (ownerFilter->getParameterArray())
 {
     // set it to use our look and feel
@@ -116,21 +116,15 @@ SAFEAudioProcessorEditor::SAFEAudioProcessorEditor (SAFEAudioProcessor* ownerFil
         metaDataElement = new XmlElement ("MetaData");
     }
 
-    // file access button settings
-    if (canReachServer())
-    {
-        fileAccessButton.setMode (SAFEButton::GlobalFile);
-        fileAccessButtonPressed = true;
-    }
-    else
-    {
-        fileAccessButton.setMode (SAFEButton::LocalFile);
-        fileAccessButtonPressed = false;
-    }
+    // file access button settings - the server isn't checked here as that would
+    // hold up the host, anything fetched from it falls back on the local data
+    // if it can't be reached
+    fileAccessButton.setMode (SAFEButton::GlobalFile);
+    fileAccessButtonPressed = true;
 
     fileAccessButton.addListener (this);
 
-    descriptorLoadScreen.updateDescriptors (fileAccessButtonPressed, ownerFilter->getSemanticDataElement());
+    descriptorLoadScreen.updateDescriptors (fileAccessButtonPressed);
 
     warningVisible = false;
     warningFlagged = false;
@@ -175,12 +169,6 @@ void SAFEAudioProcessorEditor::buttonClicked (Button* button)
         }
         else if (descriptorBoxContent.containsNonWhitespaceChars())
         {
-            if (fileAccessButtonPressed && ! canReachServer())
-            {
-                displayWarning (CannotReachServer);
-                return;
-            }
-
             if (ourProcessor->isPlaying())
             {
                 ourProcessor->startRecording (descriptorBoxContent, metaData, fileAccessButtonPressed);
@@ -212,12 +200,6 @@ void SAFEAudioProcessorEditor::buttonClicked (Button* button)
 
         String selectedDescriptor = descriptorLoadScreen.getSelectedDescriptor();
 
-        if (fileAccessButtonPressed && ! canReachServer())
-        {
-            displayWarning (CannotReachServer);
-            return;
-        }
-
         if (! (ourProcessor->isRecording()))
         {
             // select param settings from either local/global db...
@@ -279,7 +261,7 @@ void SAFEAudioProcessorEditor::buttonClicked (Button* button)
             fileAccessButtonPressed = true;
         }
 
-        descriptorLoadScreen.updateDescriptors (fileAccessButtonPressed, ourProcessor->getSemanticDataElement());
+        descriptorLoadScreen.updateDescriptors (fileAccessButtonPressed);
     }
 }
 
@@ -492,6 +474,10 @@ void SAFEAudioProcessorEditor::displayWarning (WarningID id, int durationInMilli
             case CannotReachServer:
                 warningMessage = "Can't reach the server, check your internet connection";
                 break;
+
+            case CannotSaveData:
+                warningMessage = "Couldn't save, check there's space on the disk!";
+                break;
         }
 
         recordButton.setEnabled (false);
@@ -506,14 +492,3 @@ void SAFEAudioProcessorEditor::displayWarning (WarningID id, int durationInMilli
         startTimer (warningTimer, durationInMilliseconds);
     }
 }
-
-//==========================================================================
-//      Test Connection to Server
-//==========================================================================
-bool SAFEAudioProcessorEditor::canReachServer()
-{
-    URL serverConnectionTest ("http://193.60.133.151/SAFE/testConnection.txt");
-    String testString (serverConnectionTest.readEntireTextStream());
-
-    return testString.contains ("Hi There!");
-}
@@ -160,11 +160,6 @@ private:
     WarningID flaggedWarningID;
     void displayWarning (WarningID id, int durationInMilliseconds = 1000);
 
-    //==========================================================================
-    //      Test Connection to Server
-    //==========================================================================
-    bool canReachServer();
-
     SAFEAudioProcessor* getProcessor()
     {
         return static_cast <SAFEAudioProcessor*> (getAudioProcessor());
@@ -6,22 +6,10 @@ SAFEFeatureExtractor::SAFEFeatureExtractor()
       numChannels (0),
       defaultFrameSize (0),
       defaultStepSize (0),
+      expectedNumSamples (0),
       fs (0.0),
-      windowingFunction (applyHannWindow),
-      libXtractSpectrumNeeded (false),
-      libXtractPeakSpectrumNeeded (false),
-      libXtractHarmonicSpectrumNeeded (false),
-      calculateLibXtractBarkCoefficients (false),
-      libXtractMelFiltersInitialised (false),
-      calculateLibXtractMFCCs (false),
-      nextVampFeatureTimeStamp (0)
+      libXtractMelFiltersInitialised (false)
 {
-    // initialise libxtract arrays
-    for (int i = 0; i < LibXtract::NumScalarFeatures; ++i)
-    {
-        calculateLibXtractScalarFeature [i] = false;
-    }
-
     // allocate bark band limits and mel filters
     libXtractBarkBandLimits.allocate (numLibXtractBarkBands + 1, true);
 
@@ -41,7 +29,8 @@ SAFEFeatureExtractor::~SAFEFeatureExtractor()
 //==========================================================================
 //      Setup
 //==========================================================================
-void SAFEFeatureExtractor::initialise (int numChannelsInit, int defaultFrameSizeInit, int defaultStepSizeInit, double sampleRate)
+void SAFEFeatureExtractor::initialise (int numChannelsInit, int defaultFrameSizeInit, int defaultStepSizeInit, double sampleRate,
+                                       int expectedNumSamplesInit)
 {
     // save the number of channels
     numChannels = numChannelsInit;
@@ -62,6 +51,8 @@ void SAFEFeatureExtractor::initialise (int numChannelsInit, int defaultFrameSize
     // save the sample rate
     fs = sampleRate;
 
+    expectedNumSamples = jmax (0, expectedNumSamplesInit);
+
     analysisConfigurations.clear();
 
     // initialise libxtract bits
@@ -70,123 +61,25 @@ void SAFEFeatureExtractor::initialise (int numChannelsInit, int defaultFrameSize
     // initialise the vamp stuff
     initialiseVampPlugins();
 
+    prepareAnalysisConfigurations();
+
     initialised = true;
 }
 
 void SAFEFeatureExtractor::addLibXtractFeature (LibXtract::Feature feature)
 {
-    if (feature < LibXtract::NumScalarFeatures)
-    {
-        if (calculateLibXtractScalarFeature [feature])
-        {
-            return;
-        }
-
-        calculateLibXtractScalarFeature [feature] = true;
-
-        LibXtractFeature *newFeature = libXtractFeatureValues.add (new LibXtractFeature);
-        newFeature->featureNumber = feature;
-
-        if (feature >= LibXtract::SpectralCentroid)
-        {
-            libXtractSpectrumNeeded = true;
-        }
-
-        if (feature >= LibXtract::PeakSpectralCentroid)
-        {
-            libXtractPeakSpectrumNeeded = true;
-        }
-
-        if (feature >= LibXtract::PeakTristimulus1)
-        {
-            calculateLibXtractScalarFeature [LibXtract::FundamentalFrequency] = true;
-        }
-
-        if (feature >= LibXtract::HarmonicSpectralCentroid)
-        {
-            libXtractHarmonicSpectrumNeeded = true;
-        }
-
-        // make sure prerequisite features are calculated
-        switch (feature)
-        {
-            // temporal features
-            case LibXtract::TemporalStandardDeviation:
-                calculateLibXtractScalarFeature [LibXtract::TemporalVariance] = true;
-
-            case LibXtract::TemporalVariance:
-                calculateLibXtractScalarFeature [LibXtract::TemporalMean] = true;
-                break;
-
-            // spectral features
-            case LibXtract::SpectralSkewness:
-            case LibXtract::SpectralKurtosis:
-                calculateLibXtractScalarFeature [LibXtract::SpectralStandardDeviation] = true;
-
-            case LibXtract::SpectralStandardDeviation:
-                calculateLibXtractScalarFeature [LibXtract::SpectralVariance] = true;
-
-            case LibXtract::SpectralVariance:
-                calculateLibXtractScalarFeature [LibXtract::SpectralCentroid] = true;
-                break;
-
-            case LibXtract::Tonality:
-                calculateLibXtractScalarFeature [LibXtract::SpectralFlatness] = true;
-                break;
-
-            // peak spectral features
-            case LibXtract::PeakSpectralSkewness:
-            case LibXtract::PeakSpectralKurtosis:
-                calculateLibXtractScalarFeature [LibXtract::PeakSpectralStandardDeviation] = true;
-
-            case LibXtract::PeakSpectralStandardDeviation:
-                calculateLibXtractScalarFeature [LibXtract::PeakSpectralVariance] = true;
-
-            case LibXtract::PeakSpectralVariance:
-                calculateLibXtractScalarFeature [LibXtract::PeakSpectralCentroid] = true;
-                break;
-
-            // harmonic spectral features
-            case LibXtract::HarmonicSpectralSkewness:
-            case LibXtract::HarmonicSpectralKurtosis:
-                calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralStandardDeviation] = true;
-
-            case LibXtract::HarmonicSpectralStandardDeviation:
-                calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralVariance] = true;
-
-            case LibXtract::HarmonicSpectralVariance:
-                calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralCentroid] = true;
-                break;
-
-            default:
-                break;
-        }
-    }
-    else if (feature == LibXtract::BarkCoefficients)
+    if (feature < LibXtract::NumScalarFeatures || feature == LibXtract::BarkCoefficients || feature == LibXtract::MFCCs)
     {
-        if (calculateLibXtractBarkCoefficients)
+        if (libXtractFeatureGraph.isFeatureRequested (feature))
         {
             return;
         }
 
-        LibXtractFeature *newFeature = libXtractFeatureValues.add (new LibXtractFeature);
-        newFeature->featureNumber = feature;
-
-        libXtractSpectrumNeeded = true;
-        calculateLibXtractBarkCoefficients = true;
-    }
-    else if (feature == LibXtract::MFCCs)
-    {
-        if (calculateLibXtractMFCCs)
-        {
-            return;
-        }
+        // the graph takes care of any prerequisite features
+        libXtractFeatureGraph.addFeature (feature);
 
         LibXtractFeature *newFeature = libXtractFeatureValues.add (new LibXtractFeature);
         newFeature->featureNumber = feature;
-
-        libXtractSpectrumNeeded = true;
-        calculateLibXtractMFCCs = true;
     }
     else
     {
@@ -253,15 +146,24 @@ void SAFEFeatureExtractor::addVampPlugin (const String &libraryName, const Strin
     vampPluginKeys.add (pluginKey);
 }
 
+void SAFEFeatureExtractor::setFeaturePrecision (const String &featureName, double precision)
+{
+    featurePrecisions.set (featureName, jmax (0.0, precision));
+}
+
 void SAFEFeatureExtractor::analyseAudio (AudioSampleBuffer &buffer)
 {
     // the number of channels passed in must be the number the extractor was
     // initialised for
     jassert (buffer.getNumChannels() == numChannels);
 
-    int numSamples = buffer.getNumSamples();
-    float **audioData = buffer.getArrayOfWritePointers();
+    resetAnalysis();
+    pushSamples (buffer, 0, buffer.getNumSamples());
+    finishAnalysis();
+}
 
+void SAFEFeatureExtractor::resetAnalysis()
+{
     resetVampPlugins();
     clearLibXtractFeatures();
     clearVampFeatures();
@@ -270,35 +172,47 @@ void SAFEFeatureExtractor::analyseAudio (AudioSampleBuffer &buffer)
     {
         AnalysisConfiguration *config = analysisConfigurations [i];
 
-        int currentFrameSize = config->frameSize;
-        int currentStepSize = config->stepSize;
-
-        int lastFrameStart = numSamples - currentFrameSize;
-
-        for (int frameStart = 0; frameStart <= lastFrameStart; frameStart += currentStepSize)
-        {
-            AudioSampleBuffer frameBuffer (audioData, numChannels, frameStart, currentFrameSize);
+        config->samplesInFrame = 0;
+        config->samplesToSkip = 0;
+        config->frameStart = 0;
+    }
+}
 
-            calculateSpectra (frameBuffer);
+void SAFEFeatureExtractor::pushSamples (const AudioSampleBuffer &buffer, int startSample, int numSamples)
+{
+    OwnedArray <ThreadPoolJob> jobs;
+    addAnalysisJobs (jobs, buffer, startSample, numSamples);
 
-            int time = 1000 * frameStart / fs;
+    analysisThreadPool->runJobsAndWait (jobs);
+}
 
-            if (config->libXtractConfiguration)
-            {
-                calculateLibXtractFeatures (frameBuffer);
-                addLibXtractFeaturesToList (time);
-            }
+void SAFEFeatureExtractor::addAnalysisJobs (OwnedArray <ThreadPoolJob> &jobs, const AudioSampleBuffer &buffer, int startSample, int numSamples)
+{
+    // the number of channels passed in must be the number the extractor was
+    // initialised for
+    jassert (buffer.getNumChannels() == numChannels);
 
-            calculateVampPluginFeatures (config->vampPluginIndicies, frameBuffer, time);
-        }
+    for (int i = 0; i < analysisConfigurations.size(); ++i)
+    {
+        jobs.add (new AnalysisJob (*this, *analysisConfigurations [i], buffer, startSample, numSamples));
     }
-    
+}
+
+void SAFEFeatureExtractor::finishAnalysis()
+{
     getRemainingVampPluginFeatures();
 }
 
 void SAFEFeatureExtractor::setWindowingFunction (void (*newWindowingFunction) (float*, int))
 {
-    windowingFunction = newWindowingFunction;
+    windows.setCustomFunction (newWindowingFunction);
+    updateWindows();
+}
+
+void SAFEFeatureExtractor::setWindowType (AnalysisWindows::Type newWindowType, double kaiserBeta)
+{
+    windows.setType (newWindowType, kaiserBeta);
+    updateWindows();
 }
 
 void SAFEFeatureExtractor::addFeaturesToXmlElement (XmlElement *element)
@@ -318,11 +232,12 @@ void SAFEFeatureExtractor::addFeaturesToXmlElement (XmlElement *element)
             XmlElement *channelElement = featureElement->createNewChildElement ("Channel");
             channelElement->setAttribute ("Number", channel);
 
-            int numFeatures = currentFeature->featureValues.getReference (channel).size();
+            AudioFeatureColumn features = libXtractFeatureStore.getColumn (currentFeature->firstColumn + channel);
 
-            for (int feature = numFeatures - 1; feature >= 0; --feature)
+            // each feature is prepended, so going backwards leaves them oldest first
+            for (int feature = features.size() - 1; feature >= 0; --feature)
             {
-                addAudioFeatureToXmlElement (channelElement, currentFeature->featureValues.getReference (channel).getReference (feature));
+                addAudioFeatureToXmlElement (channelElement, features, feature);
             }
         }
     }
@@ -330,7 +245,7 @@ void SAFEFeatureExtractor::addFeaturesToXmlElement (XmlElement *element)
     for (int i = 0; i < vampPlugins.size(); ++i)
     {
         VampPluginConfiguration *currentPlugin = vampPlugins [i];
-        int numFeatures = currentPlugin->featureValues.size();
+        int numFeatures = currentPlugin->featureStore.getNumColumns();
 
         for (int feature = 0; feature < numFeatures; ++feature)
         {
@@ -344,17 +259,157 @@ void SAFEFeatureExtractor::addFeaturesToXmlElement (XmlElement *element)
             XmlElement *channelElement = featureElement->createNewChildElement ("Channel");
             channelElement->setAttribute ("Number", "NULL");
 
-            int numValues = currentPlugin->featureValues.getReference (feature).size();
+            AudioFeatureColumn features = currentPlugin->featureStore.getColumn (feature);
 
-            for (int value = numValues - 1; value >= 0; --value)
+            for (int value = features.size() - 1; value >= 0; --value)
             {
-                addAudioFeatureToXmlElement (channelElement, currentPlugin->featureValues.getReference (feature).getReference (value));
+                addAudioFeatureToXmlElement (channelElement, features, value);
             }
 
         }
     }
 }
 
+void SAFEFeatureExtractor::writeFeaturesToXmlStream (XmlStreamWriter &writer)
+{
+    for (int i = 0; i < libXtractFeatureValues.size(); ++i)
+    {
+        LibXtractFeature *currentFeature = libXtractFeatureValues [i];
+
+        writer.startElement ("FeatureSet");
+        writer.addAttribute ("FeatureName", LibXtract::getFeatureName (currentFeature->featureNumber));
+        writer.addAttribute ("FrameSize", defaultFrameSize);
+        writer.addAttribute ("StepSize", defaultStepSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            writer.startElement ("Channel");
+            writer.addAttribute ("Number", channel);
+
+            writeAudioFeaturesToXmlStream (writer, libXtractFeatureStore.getColumn (currentFeature->firstColumn + channel));
+
+            writer.endElement();
+        }
+
+        writer.endElement();
+    }
+
+    for (int i = 0; i < vampPlugins.size(); ++i)
+    {
+        VampPluginConfiguration *currentPlugin = vampPlugins [i];
+        int numFeatures = currentPlugin->featureStore.getNumColumns();
+
+        for (int feature = 0; feature < numFeatures; ++feature)
+        {
+            writer.startElement ("FeatureSet");
+            writer.addAttribute ("FeatureName", "Vamp " + currentPlugin->outputs [feature].name);
+            writer.addAttribute ("FrameSize", currentPlugin->frameSize);
+            writer.addAttribute ("StepSize", currentPlugin->stepSize);
+
+            writer.startElement ("Channel");
+            writer.addAttribute ("Number", "NULL");
+
+            writeAudioFeaturesToXmlStream (writer, currentPlugin->featureStore.getColumn (feature));
+
+            writer.endElement();
+            writer.endElement();
+        }
+    }
+}
+
+void SAFEFeatureExtractor::addFeaturesToBinaryWriter (AudioFeatureBinaryFormat::Writer &writer)
+{
+    AudioFeatureBinaryFormat::FeatureSetInfo info;
+
+    for (int i = 0; i < libXtractFeatureValues.size(); ++i)
+    {
+        LibXtractFeature *currentFeature = libXtractFeatureValues [i];
+
+        info.name = LibXtract::getFeatureName (currentFeature->featureNumber);
+        info.precision = featurePrecisions [info.name];
+        info.frameSize = defaultFrameSize;
+        info.stepSize = defaultStepSize;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            info.channel = channel;
+            writer.addFeatureSet (info, libXtractFeatureStore.getColumn (currentFeature->firstColumn + channel));
+        }
+    }
+
+    for (int i = 0; i < vampPlugins.size(); ++i)
+    {
+        VampPluginConfiguration *currentPlugin = vampPlugins [i];
+
+        info.frameSize = currentPlugin->frameSize;
+        info.stepSize = currentPlugin->stepSize;
+        info.channel = -1;
+
+        for (int feature = 0; feature < currentPlugin->featureStore.getNumColumns(); ++feature)
+        {
+            info.name = "Vamp " + currentPlugin->outputs [feature].name;
+            info.precision = featurePrecisions [info.name];
+            writer.addFeatureSet (info, currentPlugin->featureStore.getColumn (feature));
+        }
+    }
+}
+
+AudioFeatureColumn SAFEFeatureExtractor::getLibXtractFeatureValues (LibXtract::Feature feature, int channel) const
+{
+    for (int i = 0; i < libXtractFeatureValues.size(); ++i)
+    {
+        const LibXtractFeature *currentFeature = libXtractFeatureValues [i];
+
+        if (currentFeature->featureNumber == feature)
+        {
+            return libXtractFeatureStore.getColumn (currentFeature->firstColumn + channel);
+        }
+    }
+
+    // this feature hasn't been added
+    jassertfalse;
+    return AudioFeatureColumn();
+}
+
+int SAFEFeatureExtractor::getNumVampPlugins() const
+{
+    return vampPlugins.size();
+}
+
+int SAFEFeatureExtractor::getNumVampPluginOutputs (int pluginIndex) const
+{
+    return vampPlugins [pluginIndex]->featureStore.getNumColumns();
+}
+
+AudioFeatureColumn SAFEFeatureExtractor::getVampPluginFeatureValues (int pluginIndex, int output) const
+{
+    return vampPlugins [pluginIndex]->featureStore.getColumn (output);
+}
+
+//==========================================================================
+//      Analysis Jobs
+//==========================================================================
+SAFEFeatureExtractor::AnalysisJob::AnalysisJob (SAFEFeatureExtractor &extractorInit, AnalysisConfiguration &configInit,
+                                                const AudioSampleBuffer &bufferInit, int startSampleInit, int numSamplesInit)
+    : ThreadPoolJob ("AnalysisJob"),
+      extractor (extractorInit),
+      config (configInit),
+      buffer (bufferInit),
+      startSample (startSampleInit),
+      numSamples (numSamplesInit)
+{
+}
+
+ThreadPoolJob::JobStatus SAFEFeatureExtractor::AnalysisJob::runJob()
+{
+    extractor.pushSamplesToConfiguration (config, buffer, startSample, numSamples);
+
+    return jobHasFinished;
+}
+
+//==========================================================================
+//      Internal Analysis Bits
+//==========================================================================
 void SAFEFeatureExtractor::cacheNewFFT (int size)
 {
     // make a new FFT object if needs be
@@ -368,47 +423,60 @@ void SAFEFeatureExtractor::cacheNewFFT (int size)
         fftCache.insert (std::pair <int, ScopedPointer <FFT> > (size, 
                                                                 new FFT (frameOrder, false)));
     }
-
-    if (! spectraCache.count (size))
-    {
-        spectraCache [size].setSize (numChannels, size * 2);
-    }
 }
 
-void SAFEFeatureExtractor::calculateSpectra (const AudioSampleBuffer &frame)
+const float* SAFEFeatureExtractor::getSpectrum (AnalysisConfiguration &config, int channel)
 {
-    int numSamples = frame.getNumSamples();
+    // this configuration wasn't planned to need any spectra
+    jassert (config.spectraNeeded);
 
-    if (fftCache.count (numSamples) == 0)
+    float *spectrum = config.spectra.getWritePointer (channel);
+
+    if (config.spectrumCalculated [channel])
     {
-        return;
+        return spectrum;
     }
 
-    FFT *fft = fftCache [numSamples];
-    AudioSampleBuffer &spectra = spectraCache [numSamples];
+    int numSamples = config.frameSize;
 
-    for (int i = 0; i < numChannels; ++i)
-    {
-        spectra.copyFrom (i, 0, frame, i, 0, numSamples);
-        windowingFunction (spectra.getWritePointer (i), numSamples);
-        fft->performRealOnlyForwardTransform (spectra.getWritePointer (i));
-    }
+    FloatVectorOperations::copy (spectrum, config.frameBuffer.getReadPointer (channel), numSamples);
+    AnalysisWindows::applyWindow (spectrum, config.window, numSamples);
+    config.fft->performRealOnlyForwardTransform (spectrum);
 
-    // scale spectra
+    // scale spectrum
     float singleBinGain = 1.0f / numSamples;
     float duplicateBinGain = 2.0f * singleBinGain;
-    spectra.applyGain (0, 1, singleBinGain);
-    spectra.applyGain (1, 1, 0);
-    spectra.applyGain (2, numSamples - 2, duplicateBinGain);
-    spectra.applyGain (numSamples, 1, singleBinGain);
-    spectra.applyGain (numSamples + 1, 1, 0);
+    spectrum [0] *= singleBinGain;
+    spectrum [1] = 0;
+    FloatVectorOperations::multiply (spectrum + 2, duplicateBinGain, numSamples - 2);
+    spectrum [numSamples] *= singleBinGain;
+    spectrum [numSamples + 1] = 0;
+
+    config.spectrumCalculated [channel] = true;
+
+    return spectrum;
 }
 
-void SAFEFeatureExtractor::applyHannWindow (float *data, int numSamples)
+const AudioSampleBuffer& SAFEFeatureExtractor::getSpectra (AnalysisConfiguration &config)
 {
-    for (int i = 0; i < numSamples; ++i)
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        data [i] *= 0.5 * (1 - cos (2 * float_Pi * i / (numSamples - 1)));
+        getSpectrum (config, channel);
+    }
+
+    return config.spectra;
+}
+
+void SAFEFeatureExtractor::updateWindows()
+{
+    for (int i = 0; i < analysisConfigurations.size(); ++i)
+    {
+        AnalysisConfiguration *config = analysisConfigurations [i];
+
+        if (config->fft != nullptr)
+        {
+            config->window = windows.getWindow (config->frameSize);
+        }
     }
 }
 
@@ -420,9 +488,91 @@ SAFEFeatureExtractor::AnalysisConfiguration* SAFEFeatureExtractor::addNewAnalysi
     config->stepSize = stepSize;
     config->libXtractConfiguration = libXtractConfiguration;
 
+    config->frameBuffer.setSize (numChannels, frameSize);
+    config->samplesInFrame = 0;
+    config->samplesToSkip = 0;
+    config->frameStart = 0;
+
+    config->spectraNeeded = false;
+    config->fft = nullptr;
+    config->window = nullptr;
+
     return analysisConfigurations.add (config);
 }
 
+void SAFEFeatureExtractor::prepareAnalysisConfigurations()
+{
+    for (int i = 0; i < analysisConfigurations.size(); ++i)
+    {
+        AnalysisConfiguration *config = analysisConfigurations [i];
+
+        // work out whether anything in this configuration uses the spectra
+        config->spectraNeeded = config->libXtractConfiguration && libXtractFeatureGraph.needsNode (LibXtractFeatureGraph::SpectrumBuffer);
+
+        for (int plugin = 0; plugin < config->vampPluginIndicies.size(); ++plugin)
+        {
+            if (vampPlugins [config->vampPluginIndicies [plugin]]->plugin->getInputDomain() == VampPlugin::FrequencyDomain)
+            {
+                config->spectraNeeded = true;
+            }
+        }
+
+        if (config->spectraNeeded)
+        {
+            cacheNewFFT (config->frameSize);
+
+            config->fft = fftCache [config->frameSize];
+            config->spectra.setSize (numChannels, config->frameSize * 2);
+            config->spectrumCalculated.allocate (numChannels, true);
+        }
+        else
+        {
+            config->fft = nullptr;
+            config->spectra.setSize (0, 0);
+            config->spectrumCalculated.free();
+        }
+
+        config->window = nullptr;
+    }
+
+    updateWindows();
+}
+
+void SAFEFeatureExtractor::pushSamplesToConfiguration (AnalysisConfiguration &config, const AudioSampleBuffer &buffer, int startSample, int numSamples)
+{
+    int samplesRead = 0;
+
+    while (samplesRead < numSamples)
+    {
+        int samplesLeft = numSamples - samplesRead;
+
+        // skip the gap between frames if the step is longer than the frame
+        if (config.samplesToSkip > 0)
+        {
+            int samplesSkipped = jmin (config.samplesToSkip, samplesLeft);
+
+            config.samplesToSkip -= samplesSkipped;
+            samplesRead += samplesSkipped;
+            continue;
+        }
+
+        int samplesToCopy = jmin (config.frameSize - config.samplesInFrame, samplesLeft);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            config.frameBuffer.copyFrom (channel, config.samplesInFrame, buffer, channel, startSample + samplesRead, samplesToCopy);
+        }
+
+        config.samplesInFrame += samplesToCopy;
+        samplesRead += samplesToCopy;
+
+        if (config.samplesInFrame == config.frameSize)
+        {
+            analyseFrame (config);
+        }
+    }
+}
+
 void SAFEFeatureExtractor::addVampPluginToAnalysisConfigurations (int pluginIndex, int frameSize, int stepSize)
 {
     AnalysisConfiguration *configToAlter = nullptr;
@@ -462,23 +612,64 @@ const SAFEFeatureExtractor::AnalysisConfiguration* SAFEFeatureExtractor::getVamp
     }
 }
 
-void SAFEFeatureExtractor::addAudioFeatureToXmlElement (XmlElement *element, const AudioFeature &feature)
+void SAFEFeatureExtractor::analyseFrame (AnalysisConfiguration &config)
+{
+    // the spectra are worked out on demand for each new frame
+    if (config.spectraNeeded)
+    {
+        config.spectrumCalculated.clear (numChannels);
+    }
+
+    int time = 1000 * config.frameStart / fs;
+
+    if (config.libXtractConfiguration)
+    {
+        calculateLibXtractFeatures (config);
+        addLibXtractFeaturesToList (time);
+    }
+
+    calculateVampPluginFeatures (config, time);
+
+    // keep the overlapping samples for the next frame
+    int overlap = config.frameSize - config.stepSize;
+
+    if (overlap > 0)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float *channelData = config.frameBuffer.getWritePointer (channel);
+            memmove (channelData, channelData + config.stepSize, overlap * sizeof (float));
+        }
+
+        config.samplesInFrame = overlap;
+    }
+    else
+    {
+        config.samplesInFrame = 0;
+        config.samplesToSkip = -overlap;
+    }
+
+    config.frameStart += config.stepSize;
+}
+
+void SAFEFeatureExtractor::addAudioFeatureToXmlElement (XmlElement *element, const AudioFeatureColumn &features, int index)
 {
     XmlElement *featureElement = new XmlElement ("Feature");
-    featureElement->setAttribute ("Time", feature.timeStamp);    
-    featureElement->setAttribute ("Duration", feature.duration);    
+    featureElement->setAttribute ("Time", features.getTimeStamp (index));    
+    featureElement->setAttribute ("Duration", features.getDuration (index));    
 
     String valueString;
-    int numValues = feature.values.size();
+    int numValues = features.getNumValues (index);
+    const double *values = features.getValues (index);
 
     for (int i = 0; i < numValues - 1; ++i)
     {
-        valueString += doubleToString (feature.values [i]) + ", ";
+        valueString += doubleToString (values [i]) + ", ";
     }
 
     if (numValues > 0)
     {
-        valueString += doubleToString (feature.values.getLast());
+        valueString += doubleToString (values [numValues - 1]);
     }
 
     featureElement->setAttribute ("Values", valueString);
@@ -486,6 +677,41 @@ void SAFEFeatureExtractor::addAudioFeatureToXmlElement (XmlElement *element, con
     element->prependChildElement (featureElement);
 }
 
+void SAFEFeatureExtractor::writeAudioFeaturesToXmlStream (XmlStreamWriter &writer, const AudioFeatureColumn &features)
+{
+    // oldest first, the order addFeaturesToXmlElement() ends up with
+    for (int index = 0; index < features.size(); ++index)
+    {
+        writer.startElement ("Feature");
+        writer.addAttribute ("Time", features.getTimeStamp (index));
+        writer.addAttribute ("Duration", features.getDuration (index));
+
+        int numValues = features.getNumValues (index);
+        const double *values = features.getValues (index);
+
+        // the values go straight to the stream rather than into one long string
+        writer.startAttribute ("Values");
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            if (i > 0)
+            {
+                writer.writeAttributeText (", ");
+            }
+
+            writer.writeAttributeText (doubleToString (values [i]));
+        }
+
+        writer.endAttribute();
+        writer.endElement();
+    }
+}
+
+int SAFEFeatureExtractor::getExpectedNumFrames (int stepSize) const
+{
+    return expectedNumSamples / jmax (1, stepSize) + 1;
+}
+
 String SAFEFeatureExtractor::doubleToString (double value)
 {
     if (std::isnan (value))
@@ -522,6 +748,7 @@ void SAFEFeatureExtractor::deleteLibXtractMelFilters()
 void SAFEFeatureExtractor::initialiseLibXtract()
 {
     libXtractScalarFeatureValues.resize (numChannels);
+    libXtractFeatureBuffers.resize (numChannels);
 
     xtract_init_bark (defaultFrameSize, fs, libXtractBarkBandLimits);
     libXtractBarkCoefficients.resize (numChannels);
@@ -542,544 +769,265 @@ void SAFEFeatureExtractor::initialiseLibXtract()
     libXtractSpectra.resize (numChannels);
     libXtractPeakSpectra.resize (numChannels);
     libXtractHarmonicSpectra.resize (numChannels);
+    libXtractChannelData.resize (numChannels);
+
+    int numBins = defaultFrameSize / 2;
+    double binWidth = fs / defaultFrameSize;
 
     // allocate memory for multi channel buffers
     for (int i = 0; i < numChannels; ++i)
     {
-        libXtractScalarFeatureValues.getReference (i).resize (LibXtract::NumScalarFeatures);
+        // leave space for the intermediate values too
+        libXtractScalarFeatureValues.getReference (i).resize (LibXtractFeatureGraph::NumScalarNodes);
         libXtractBarkCoefficients.getReference (i).resize (numLibXtractBarkBands);
         libXtractMFCCs.getReference (i).resize (numLibXtractMelFilters);
 
         libXtractSpectra.getReference (i).resize (defaultFrameSize);
         libXtractPeakSpectra.getReference (i).resize (defaultFrameSize);
         libXtractHarmonicSpectra.getReference (i).resize (defaultFrameSize);
-    }
-
-    libXtractChannelData.allocate (defaultFrameSize, true);
-
-    if (libXtractSpectrumNeeded)
-    {
-        cacheNewFFT (defaultFrameSize);
-    }
-
-    addNewAnalysisConfiguration (defaultFrameSize, defaultStepSize, true);
-
-    // initialise the feature value arrays
-    for (int i = 0; i < libXtractFeatureValues.size(); ++i)
-    {
-        libXtractFeatureValues [i]->featureValues.resize (numChannels);
-    }
-}
-
-void SAFEFeatureExtractor::calculateLibXtractSpectra()
-{
-    if (! libXtractSpectrumNeeded)
-    {
-        return;
-    }
+        libXtractChannelData.getReference (i).resize (defaultFrameSize);
 
-    int numBins = defaultFrameSize / 2;
-    double binWidth = fs / defaultFrameSize;
-    AudioSampleBuffer &spectra = spectraCache [defaultFrameSize];
+        // the bin frequencies don't change so they only need filling in once
+        double *libXtractSpectrumChannel = libXtractSpectra.getReference (i).getRawDataPointer();
 
-    for (int channel = 0; channel < numChannels; ++channel)
-    {
-        const float *spectrumChannel = spectra.getReadPointer (channel);
-        double *libXtractSpectrumChannel = libXtractSpectra.getReference (channel).getRawDataPointer();
-
-        for (int i = 1; i <= numBins; ++i)
+        for (int bin = 1; bin <= numBins; ++bin)
         {
-            double realPart = spectrumChannel [2 * i];
-            double imagPart = spectrumChannel [2 * i + 1];
-            double magnitude = pow (pow (realPart, 2.0) + pow (imagPart, 2.0), 0.5);
-
-            libXtractSpectrumChannel [i - 1] = magnitude;
-            libXtractSpectrumChannel [i - 1 + numBins] = i * binWidth;
+            libXtractSpectrumChannel [bin - 1 + numBins] = bin * binWidth;
         }
-    }
-}
 
-void SAFEFeatureExtractor::calculateLibXtractFeatures (const AudioSampleBuffer &frame)
-{
-    calculateLibXtractSpectra();
+        // point the graph's buffer nodes at this channel's buffers
+        Array <double*> &buffers = libXtractFeatureBuffers.getReference (i);
+        buffers.clearQuick();
+        buffers.insertMultiple (0, nullptr, LibXtractFeatureGraph::NumNodes);
 
-    for (int channel = 0; channel < numChannels; ++channel)
-    {
-        const float *channelData = frame.getReadPointer (channel);
-        double *scalarFeatureValues = libXtractScalarFeatureValues.getReference (channel).getRawDataPointer();
-        double *spectrum = libXtractSpectra.getReference (channel).getRawDataPointer();
-        double *peakSpectrum = libXtractPeakSpectra.getReference (channel).getRawDataPointer();
-        double *harmonicSpectrum = libXtractHarmonicSpectra.getReference (channel).getRawDataPointer();
-
-        for (int i = 0; i < defaultFrameSize; ++i)
-        {
-            libXtractChannelData [i] = channelData [i];
-        }
-
-        // temporal features
-        if (calculateLibXtractScalarFeature [LibXtract::TemporalMean])
-        {
-            xtract_mean (libXtractChannelData, 
-                         defaultFrameSize, 
-                         NULL, 
-                         scalarFeatureValues + LibXtract::TemporalMean);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::TemporalVariance])
-        {
-            xtract_variance (libXtractChannelData, 
-                             defaultFrameSize, 
-                             scalarFeatureValues + LibXtract::TemporalMean, 
-                             scalarFeatureValues + LibXtract::TemporalVariance);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::TemporalStandardDeviation])
-        {
-            xtract_standard_deviation (libXtractChannelData, 
-                                       defaultFrameSize, 
-                                       scalarFeatureValues + LibXtract::TemporalVariance, 
-                                       scalarFeatureValues + LibXtract::TemporalStandardDeviation);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::RMSAmplitude])
-        {
-            xtract_rms_amplitude (libXtractChannelData, 
-                                  defaultFrameSize, 
-                                  NULL, 
-                                  scalarFeatureValues + LibXtract::RMSAmplitude);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::ZeroCrossingRate])
-        {
-            xtract_zcr (libXtractChannelData, 
-                        defaultFrameSize, 
-                        NULL, 
-                        scalarFeatureValues + LibXtract::ZeroCrossingRate);
-        }
-        
-        // spectral features
-        if (calculateLibXtractScalarFeature [LibXtract::FundamentalFrequency])
-        {
-            xtract_failsafe_f0 (libXtractChannelData, 
-                                defaultFrameSize, 
-                                &fs, 
-                                scalarFeatureValues + LibXtract::FundamentalFrequency);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralCentroid])
-        {
-            xtract_spectral_centroid (spectrum, 
-                                      defaultFrameSize, 
-                                      NULL, 
-                                      scalarFeatureValues + LibXtract::SpectralCentroid);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralVariance])
-        {
-            xtract_spectral_variance (spectrum, 
-                                      defaultFrameSize, 
-                                      scalarFeatureValues + LibXtract::SpectralCentroid, 
-                                      scalarFeatureValues + LibXtract::SpectralVariance);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralStandardDeviation])
-        {
-            xtract_spectral_standard_deviation (spectrum, 
-                                                defaultFrameSize, 
-                                                scalarFeatureValues + LibXtract::SpectralVariance, 
-                                                scalarFeatureValues + LibXtract::SpectralStandardDeviation);
-        }
-
-        double argumentArray [2] = {scalarFeatureValues [LibXtract::SpectralCentroid],
-                                    scalarFeatureValues [LibXtract::SpectralStandardDeviation]};
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralSkewness])
-        {
-            xtract_spectral_skewness (spectrum, 
-                                      defaultFrameSize, 
-                                      argumentArray, 
-                                      scalarFeatureValues + LibXtract::SpectralSkewness);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralKurtosis])
-        {
-            xtract_spectral_kurtosis (spectrum, 
-                                      defaultFrameSize, 
-                                      argumentArray, 
-                                      scalarFeatureValues + LibXtract::SpectralKurtosis);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::JensenIrregularity])
-        {
-            xtract_irregularity_j (spectrum, 
-                                   defaultFrameSize / 2, 
-                                   NULL, 
-                                   scalarFeatureValues + LibXtract::JensenIrregularity);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::KrimphoffIrregularity])
-        {
-            xtract_irregularity_k (spectrum, 
-                                   defaultFrameSize / 2, 
-                                   NULL, 
-                                   scalarFeatureValues + LibXtract::KrimphoffIrregularity);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralSmoothness])
-        {
-            xtract_smoothness (spectrum, 
-                               defaultFrameSize / 2, 
-                               NULL, 
-                               scalarFeatureValues + LibXtract::SpectralSmoothness);
-        }
-
-        argumentArray [0] = fs / defaultFrameSize;
-        argumentArray [1] = 45;
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralRollOff])
-        {
-            xtract_rolloff (spectrum, 
-                            defaultFrameSize / 2, 
-                            argumentArray, 
-                            scalarFeatureValues + LibXtract::SpectralRollOff);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralFlatness])
-        {
-            xtract_flatness (spectrum, 
-                             defaultFrameSize / 2, 
-                             NULL, 
-                             scalarFeatureValues + LibXtract::SpectralFlatness);
-        }
-
-        if (calculateLibXtractScalarFeature [LibXtract::Tonality])
-        {
-            double logFlatness;
-
-            xtract_flatness_db (NULL,
-                                0,
-                                scalarFeatureValues + LibXtract::SpectralFlatness,
-                                &logFlatness);
-
-            xtract_tonality (NULL, 
-                             0, 
-                             &logFlatness, 
-                             scalarFeatureValues + LibXtract::Tonality);
-        }
+        buffers.set (LibXtractFeatureGraph::TimeDomainBuffer, libXtractChannelData.getReference (i).getRawDataPointer());
+        buffers.set (LibXtractFeatureGraph::SpectrumBuffer, libXtractSpectrumChannel);
+        buffers.set (LibXtractFeatureGraph::PeakSpectrumBuffer, libXtractPeakSpectra.getReference (i).getRawDataPointer());
+        buffers.set (LibXtractFeatureGraph::HarmonicSpectrumBuffer, libXtractHarmonicSpectra.getReference (i).getRawDataPointer());
+        buffers.set (LibXtractFeatureGraph::BarkCoefficientsBuffer, libXtractBarkCoefficients.getReference (i).getRawDataPointer());
+        buffers.set (LibXtractFeatureGraph::MFCCsBuffer, libXtractMFCCs.getReference (i).getRawDataPointer());
+    }
 
-        if (calculateLibXtractScalarFeature [LibXtract::CrestFactor])
-        {
-            xtract_highest_value (spectrum,
-                                  defaultFrameSize / 2,
-                                  NULL,
-                                  argumentArray);
-
-            xtract_mean (spectrum,
-                         defaultFrameSize / 2,
-                         NULL,
-                         argumentArray + 1);
-
-            xtract_crest (NULL, 
-                          0, 
-                          argumentArray, 
-                          scalarFeatureValues + LibXtract::CrestFactor);
-        }
+    libXtractFeatureGraph.compile (defaultFrameSize, fs, libXtractBarkBandLimits, &libXtractMelFilters);
 
-        if (calculateLibXtractScalarFeature [LibXtract::SpectralSlope])
-        {
-            xtract_spectral_slope (spectrum, 
-                                   defaultFrameSize, 
-                                   NULL, 
-                                   scalarFeatureValues + LibXtract::SpectralSlope);
-        }
+    addNewAnalysisConfiguration (defaultFrameSize, defaultStepSize, true);
 
-        // peak spectral features
-        if (libXtractPeakSpectrumNeeded)
-        {
-            argumentArray [0] = fs / defaultFrameSize;
-            argumentArray [1] = 10;
+    // set up the feature store with a column for each feature on each channel
+    libXtractFeatureStore.removeAllColumns();
+    int expectedNumFrames = getExpectedNumFrames (defaultStepSize);
 
-            xtract_peak_spectrum (spectrum,
-                                  defaultFrameSize / 2,
-                                  argumentArray,
-                                  peakSpectrum);
-        }
+    for (int i = 0; i < libXtractFeatureValues.size(); ++i)
+    {
+        LibXtractFeature *currentFeature = libXtractFeatureValues [i];
+        int valuesPerFeature = 1;
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakSpectralCentroid])
+        if (currentFeature->featureNumber == LibXtract::BarkCoefficients)
         {
-            xtract_spectral_centroid (peakSpectrum, 
-                                      defaultFrameSize, 
-                                      NULL, 
-                                      scalarFeatureValues + LibXtract::PeakSpectralCentroid);
+            valuesPerFeature = numLibXtractBarkBands;
         }
-
-        if (calculateLibXtractScalarFeature [LibXtract::PeakSpectralVariance])
+        else if (currentFeature->featureNumber == LibXtract::MFCCs)
         {
-            xtract_spectral_variance (peakSpectrum, 
-                                      defaultFrameSize, 
-                                      scalarFeatureValues + LibXtract::PeakSpectralCentroid, 
-                                      scalarFeatureValues + LibXtract::PeakSpectralVariance);
+            valuesPerFeature = numLibXtractMelFilters;
         }
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakSpectralStandardDeviation])
+        for (int channel = 0; channel < numChannels; ++channel)
         {
-            xtract_spectral_standard_deviation (peakSpectrum, 
-                                                defaultFrameSize, 
-                                                scalarFeatureValues + LibXtract::PeakSpectralVariance, 
-                                                scalarFeatureValues + LibXtract::PeakSpectralStandardDeviation);
-        }
-
-        argumentArray [0] = scalarFeatureValues [LibXtract::PeakSpectralCentroid];
-        argumentArray [1] = scalarFeatureValues [LibXtract::PeakSpectralStandardDeviation];
+            int column = libXtractFeatureStore.addColumn (expectedNumFrames, valuesPerFeature);
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakSpectralSkewness])
-        {
-            xtract_spectral_skewness (peakSpectrum, 
-                                      defaultFrameSize, 
-                                      argumentArray, 
-                                      scalarFeatureValues + LibXtract::PeakSpectralSkewness);
+            if (channel == 0)
+            {
+                currentFeature->firstColumn = column;
+            }
         }
+    }
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakSpectralKurtosis])
-        {
-            xtract_spectral_kurtosis (peakSpectrum, 
-                                      defaultFrameSize, 
-                                      argumentArray, 
-                                      scalarFeatureValues + LibXtract::PeakSpectralKurtosis);
-        }
+    libXtractFeatureStore.allocate();
+}
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakJensenIrregularity])
-        {
-            xtract_irregularity_j (peakSpectrum, 
-                                   defaultFrameSize / 2, 
-                                   NULL, 
-                                   scalarFeatureValues + LibXtract::PeakJensenIrregularity);
-        }
+void SAFEFeatureExtractor::calculateLibXtractSpectrum (AnalysisConfiguration &config, int channel)
+{
+    int numBins = defaultFrameSize / 2;
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakKrimphoffIrregularity])
-        {
-            xtract_irregularity_k (peakSpectrum, 
-                                   defaultFrameSize / 2, 
-                                   NULL, 
-                                   scalarFeatureValues + LibXtract::PeakKrimphoffIrregularity);
-        }
+    // the bin frequencies in the second half of the spectra are filled in by initialiseLibXtract()
+    const float *spectrumChannel = getSpectrum (config, channel);
+    double *libXtractSpectrumChannel = libXtractSpectra.getReference (channel).getRawDataPointer();
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakTristimulus1])
-        {
-            xtract_tristimulus_1 (peakSpectrum, 
-                                  defaultFrameSize, 
-                                  scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                  scalarFeatureValues + LibXtract::PeakTristimulus1);
-        }
+    // skip the DC bin
+    FeatureKernels::magnitudeSpectrum (spectrumChannel + 2, libXtractSpectrumChannel, numBins);
+}
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakTristimulus2])
-        {
-            xtract_tristimulus_2 (peakSpectrum, 
-                                  defaultFrameSize, 
-                                  scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                  scalarFeatureValues + LibXtract::PeakTristimulus2);
-        }
+void SAFEFeatureExtractor::calculateLibXtractFeatures (AnalysisConfiguration &config)
+{
+    int numSteps = libXtractFeatureGraph.getNumSteps();
 
-        if (calculateLibXtractScalarFeature [LibXtract::PeakTristimulus3])
-        {
-            xtract_tristimulus_3 (peakSpectrum, 
-                                  defaultFrameSize, 
-                                  scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                  scalarFeatureValues + LibXtract::PeakTristimulus3);
-        }
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        double *scalarFeatureValues = libXtractScalarFeatureValues.getReference (channel).getRawDataPointer();
+        double * const *buffers = libXtractFeatureBuffers.getReference (channel).getRawDataPointer();
 
-        // harmonic spectral features
-        
-        if (calculateLibXtractScalarFeature [LibXtract::Inharmonicity])
+        for (int i = 0; i < numSteps; ++i)
         {
-            xtract_spectral_inharmonicity (peakSpectrum, 
-                                           defaultFrameSize, 
-                                           scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                           scalarFeatureValues + LibXtract::Inharmonicity);
-        }
+            const LibXtractFeatureGraph::Step &step = libXtractFeatureGraph.getStep (i);
 
-        if (libXtractHarmonicSpectrumNeeded)
-        {
-            argumentArray [0] = scalarFeatureValues [LibXtract::FundamentalFrequency];
-            argumentArray [1] = 0.2;
+            if (step.function == nullptr)
+            {
+                calculateLibXtractFeatureGroup (config, channel, step.output, scalarFeatureValues, buffers);
+                continue;
+            }
 
-            xtract_harmonic_spectrum (peakSpectrum,
-                                      defaultFrameSize,
-                                      argumentArray,
-                                      harmonicSpectrum);
-        }
+            // bind the arguments
+            double argumentArray [2];
+            const void *arguments = step.argumentPointer;
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralCentroid])
-        {
-            xtract_spectral_centroid (harmonicSpectrum, 
-                                      defaultFrameSize, 
-                                      NULL, 
-                                      scalarFeatureValues + LibXtract::HarmonicSpectralCentroid);
-        }
+            if (arguments == nullptr && step.numArguments > 0)
+            {
+                for (int argument = 0; argument < step.numArguments; ++argument)
+                {
+                    LibXtractFeatureGraph::Node argumentNode = step.argumentNodes [argument];
+
+                    if (argumentNode != LibXtractFeatureGraph::NoNode)
+                    {
+                        argumentArray [argument] = scalarFeatureValues [argumentNode];
+                    }
+                    else
+                    {
+                        argumentArray [argument] = step.argumentConstants [argument];
+                    }
+                }
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralVariance])
-        {
-            xtract_spectral_variance (harmonicSpectrum, 
-                                      defaultFrameSize, 
-                                      scalarFeatureValues + LibXtract::HarmonicSpectralCentroid, 
-                                      scalarFeatureValues + LibXtract::HarmonicSpectralVariance);
-        }
+                arguments = argumentArray;
+            }
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralStandardDeviation])
-        {
-            xtract_spectral_standard_deviation (harmonicSpectrum, 
-                                                defaultFrameSize, 
-                                                scalarFeatureValues + LibXtract::HarmonicSpectralVariance, 
-                                                scalarFeatureValues + LibXtract::HarmonicSpectralStandardDeviation);
-        }
+            const double *input = nullptr;
 
-        argumentArray [0] = scalarFeatureValues [LibXtract::HarmonicSpectralCentroid];
-        argumentArray [1] = scalarFeatureValues [LibXtract::HarmonicSpectralStandardDeviation];
+            if (step.input != LibXtractFeatureGraph::NoNode)
+            {
+                input = buffers [step.input];
+            }
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralSkewness])
-        {
-            xtract_spectral_skewness (harmonicSpectrum, 
-                                      defaultFrameSize, 
-                                      argumentArray, 
-                                      scalarFeatureValues + LibXtract::HarmonicSpectralSkewness);
-        }
+            double *output = nullptr;
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicSpectralKurtosis])
-        {
-            xtract_spectral_kurtosis (harmonicSpectrum, 
-                                      defaultFrameSize, 
-                                      argumentArray, 
-                                      scalarFeatureValues + LibXtract::HarmonicSpectralKurtosis);
-        }
+            if (step.output < LibXtractFeatureGraph::NumScalarNodes)
+            {
+                output = scalarFeatureValues + step.output;
+            }
+            else
+            {
+                output = buffers [step.output];
+            }
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicJensenIrregularity])
-        {
-            xtract_irregularity_j (harmonicSpectrum, 
-                                   defaultFrameSize / 2, 
-                                   NULL, 
-                                   scalarFeatureValues + LibXtract::HarmonicJensenIrregularity);
+            step.function (input, step.length, arguments, output);
         }
+    }
+}
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicKrimphoffIrregularity])
+void SAFEFeatureExtractor::calculateLibXtractFeatureGroup (AnalysisConfiguration &config, int channel, LibXtractFeatureGraph::Node node,
+                                                           double *scalarFeatureValues, double * const *buffers)
+{
+    switch (node)
+    {
+        case LibXtractFeatureGraph::TimeDomainBuffer:
         {
-            xtract_irregularity_k (harmonicSpectrum, 
-                                   defaultFrameSize / 2, 
-                                   NULL, 
-                                   scalarFeatureValues + LibXtract::HarmonicKrimphoffIrregularity);
-        }
+            const float *channelData = config.frameBuffer.getReadPointer (channel);
+            double *timeDomainData = buffers [LibXtractFeatureGraph::TimeDomainBuffer];
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicTristimulus1])
-        {
-            xtract_tristimulus_1 (harmonicSpectrum, 
-                                  defaultFrameSize, 
-                                  scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                  scalarFeatureValues + LibXtract::HarmonicTristimulus1);
-        }
+            for (int sample = 0; sample < defaultFrameSize; ++sample)
+            {
+                timeDomainData [sample] = channelData [sample];
+            }
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicTristimulus2])
-        {
-            xtract_tristimulus_2 (harmonicSpectrum, 
-                                  defaultFrameSize, 
-                                  scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                  scalarFeatureValues + LibXtract::HarmonicTristimulus2);
+            break;
         }
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicTristimulus3])
-        {
-            xtract_tristimulus_3 (harmonicSpectrum, 
-                                  defaultFrameSize, 
-                                  scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                  scalarFeatureValues + LibXtract::HarmonicTristimulus3);
-        }
+        case LibXtractFeatureGraph::SpectrumBuffer:
+            calculateLibXtractSpectrum (config, channel);
+            break;
 
-        if (calculateLibXtractScalarFeature [LibXtract::Noisiness])
+        case LibXtractFeatureGraph::TemporalStatistics:
         {
-            xtract_nonzero_count (harmonicSpectrum,
-                                  defaultFrameSize / 2,
-                                  NULL,
-                                  argumentArray);
-
-            xtract_nonzero_count (peakSpectrum,
-                                  defaultFrameSize / 2,
-                                  NULL,
-                                  argumentArray + 1);
-
-            xtract_noisiness (NULL, 
-                              0, 
-                              argumentArray, 
-                              scalarFeatureValues + LibXtract::Noisiness);
-        }
+            FeatureKernels::TemporalStatistics statistics;
+            FeatureKernels::temporalStatistics (config.frameBuffer.getReadPointer (channel), defaultFrameSize, statistics);
 
-        if (calculateLibXtractScalarFeature [LibXtract::HarmonicParityRatio])
-        {
-            xtract_odd_even_ratio (harmonicSpectrum, 
-                                   defaultFrameSize, 
-                                   scalarFeatureValues + LibXtract::FundamentalFrequency, 
-                                   scalarFeatureValues + LibXtract::HarmonicParityRatio);
+            scalarFeatureValues [LibXtract::TemporalMean] = statistics.mean;
+            scalarFeatureValues [LibXtract::TemporalVariance] = statistics.variance;
+            scalarFeatureValues [LibXtract::TemporalStandardDeviation] = statistics.standardDeviation;
+            scalarFeatureValues [LibXtract::RMSAmplitude] = statistics.rmsAmplitude;
+            scalarFeatureValues [LibXtract::ZeroCrossingRate] = statistics.zeroCrossingRate;
+            break;
         }
 
-        if (calculateLibXtractBarkCoefficients)
-        {
-            double *barkCoefficients = libXtractBarkCoefficients.getReference (channel).getRawDataPointer();
+        case LibXtractFeatureGraph::SpectralMoments:
+            calculateLibXtractSpectralMoments (buffers [LibXtractFeatureGraph::SpectrumBuffer],
+                                               scalarFeatureValues + LibXtract::SpectralCentroid);
+            break;
 
-            xtract_bark_coefficients (spectrum,
-                                      defaultFrameSize / 2,
-                                      libXtractBarkBandLimits,
-                                      barkCoefficients);
-        }
+        case LibXtractFeatureGraph::PeakSpectralMoments:
+            calculateLibXtractSpectralMoments (buffers [LibXtractFeatureGraph::PeakSpectrumBuffer],
+                                               scalarFeatureValues + LibXtract::PeakSpectralCentroid);
+            break;
 
-        if (calculateLibXtractMFCCs)
-        {
-            double *mfccs = libXtractMFCCs.getReference (channel).getRawDataPointer();
+        case LibXtractFeatureGraph::HarmonicSpectralMoments:
+            calculateLibXtractSpectralMoments (buffers [LibXtractFeatureGraph::HarmonicSpectrumBuffer],
+                                               scalarFeatureValues + LibXtract::HarmonicSpectralCentroid);
+            break;
 
-            xtract_mfcc (spectrum,
-                         defaultFrameSize / 2,
-                         &libXtractMelFilters,
-                         mfccs);
-        }
+        default:
+            // the rest come out of the groups above
+            break;
     }
 }
 
+void SAFEFeatureExtractor::calculateLibXtractSpectralMoments (const double *spectrum, double *results)
+{
+    FeatureKernels::SpectralMoments moments;
+    FeatureKernels::spectralMoments (spectrum, defaultFrameSize / 2, moments);
+
+    // the centroid, variance, standard deviation, skewness and kurtosis sit
+    // next to each other in the feature list for each type of spectrum
+    results [0] = moments.centroid;
+    results [1] = moments.variance;
+    results [2] = moments.standardDeviation;
+    results [3] = moments.skewness;
+    results [4] = moments.kurtosis;
+}
+
 void SAFEFeatureExtractor::addLibXtractFeaturesToList (int timeStamp)
 {
     for (int i = 0; i < libXtractFeatureValues.size(); ++i)
     {
+        LibXtractFeature *currentFeature = libXtractFeatureValues [i];
+        LibXtract::Feature featureNumber = currentFeature->featureNumber;
+
         for (int channel = 0; channel < numChannels; ++channel)
         {
-            AudioFeature tempFeature;
-            tempFeature.timeStamp = timeStamp;
-            tempFeature.duration = 0;
-
-            LibXtractFeature *currentFeature = libXtractFeatureValues [i];
-            LibXtract::Feature featureNumber = currentFeature->featureNumber;
+            const double *values = nullptr;
+            int numValues = 0;
 
             if (featureNumber == LibXtract::BarkCoefficients)
             {
-                tempFeature.values = libXtractBarkCoefficients [channel];
+                values = libXtractBarkCoefficients.getReference (channel).getRawDataPointer();
+                numValues = numLibXtractBarkBands;
             }
             else if (featureNumber == LibXtract::MFCCs)
             {
-                tempFeature.values = libXtractMFCCs [channel];
+                values = libXtractMFCCs.getReference (channel).getRawDataPointer();
+                numValues = numLibXtractMelFilters;
             }
             else if (featureNumber < LibXtract::NumScalarFeatures)
             {
-                tempFeature.values.add (libXtractScalarFeatureValues [channel][featureNumber]);
+                values = libXtractScalarFeatureValues.getReference (channel).getRawDataPointer() + featureNumber;
+                numValues = 1;
             }
 
-            currentFeature->featureValues.getReference (channel).add (tempFeature);
+            double *storedValues = libXtractFeatureStore.addFeature (currentFeature->firstColumn + channel, timeStamp, 0, numValues);
+            memcpy (storedValues, values, numValues * sizeof (double));
         }
     }
 }
 
 void SAFEFeatureExtractor::clearLibXtractFeatures()
 {
-    for (int i = 0; i < libXtractFeatureValues.size(); ++i)
-    {
-        for (int channel = 0; channel < numChannels; ++channel)
-        {
-            libXtractFeatureValues [i]->featureValues.getReference (channel).clear();
-        }
-    }
+    libXtractFeatureStore.clear();
 }
 
 void SAFEFeatureExtractor::initialiseVampPlugins()
@@ -1129,6 +1077,7 @@ void SAFEFeatureExtractor::loadAndInitialiseVampPlugin(const VampPluginKey &key)
     newPluginConfig->plugin = newPlugin;
     newPluginConfig->frameSize = pluginFrameSize;
     newPluginConfig->stepSize = pluginStepSize;
+    newPluginConfig->nextFeatureTimeStamp = 0;
     vampPlugins.add (newPluginConfig);
 
     if (! newPlugin->initialise (numChannels, pluginStepSize, pluginFrameSize))
@@ -1145,16 +1094,31 @@ void SAFEFeatureExtractor::loadAndInitialiseVampPlugin(const VampPluginKey &key)
     addVampPluginToAnalysisConfigurations (vampPlugins.size() - 1, pluginFrameSize, pluginStepSize);
 
     newPluginConfig->outputs = newPlugin->getOutputDescriptors();
-    newPluginConfig->featureValues.resize (newPluginConfig->outputs.size());
 
-    if (newPlugin->getInputDomain() == VampPlugin::FrequencyDomain)
+    // set up the feature store with a column for each output
+    int expectedNumFrames = getExpectedNumFrames (pluginStepSize);
+
+    for (int i = 0; i < (int) newPluginConfig->outputs.size(); ++i)
     {
-        cacheNewFFT (pluginFrameSize);
+        const VampOutputDescriptor &output = newPluginConfig->outputs [i];
+        int expectedNumFeatures = expectedNumFrames;
+        int valuesPerFeature = output.hasFixedBinCount ? (int) output.binCount : 1;
+
+        if (output.sampleType == VampOutputDescriptor::FixedSampleRate)
+        {
+            expectedNumFeatures = (int) (output.sampleRate * expectedNumSamples / fs) + 1;
+        }
+
+        newPluginConfig->featureStore.addColumn (expectedNumFeatures, valuesPerFeature);
     }
+
+    newPluginConfig->featureStore.allocate();
 }
 
-void SAFEFeatureExtractor::calculateVampPluginFeatures (const Array <int> &plugins, const AudioSampleBuffer &frame, int timeStamp)
+void SAFEFeatureExtractor::calculateVampPluginFeatures (AnalysisConfiguration &config, int timeStamp)
 {
+    const Array <int> &plugins = config.vampPluginIndicies;
+
     for (int i = 0; i < plugins.size(); ++i)
     {
         VampPlugin *currentPlugin = vampPlugins [plugins [i]]->plugin;
@@ -1162,18 +1126,16 @@ void SAFEFeatureExtractor::calculateVampPluginFeatures (const Array <int> &plugi
 
         if (currentPlugin->getInputDomain() == VampPlugin::TimeDomain)
         {
-			const float * const *audioData = frame.getArrayOfReadPointers();
+			const float * const *audioData = config.frameBuffer.getArrayOfReadPointers();
             features = currentPlugin->process (audioData, VampTime::fromMilliseconds (timeStamp));
         }
         else
         {
-			int numSamples = frame.getNumSamples();
-			AudioSampleBuffer &spectra = spectraCache [numSamples];
-			const float * const *spectralData = spectra.getArrayOfReadPointers();
+			const float * const *spectralData = getSpectra (config).getArrayOfReadPointers();
             features = currentPlugin->process (spectralData, VampTime::fromMilliseconds (timeStamp));
         }
 
-        addVampPluginFeaturesToList (i, features, timeStamp);
+        addVampPluginFeaturesToList (plugins [i], features, timeStamp);
     }
 }
 
@@ -1201,35 +1163,38 @@ void SAFEFeatureExtractor::addVampPluginFeaturesToList (int pluginIndex, VampFea
         {
             VampFeature &currentFeature = currentFeatureList [i];
 
-            nextVampFeatureTimeStamp = timeStamp;
+            currentPlugin->nextFeatureTimeStamp = timeStamp;
 
-			AudioFeature tempFeature;
+            int featureTimeStamp, featureDuration;
 
-            bool ignoreFeature = getVampPluginFeatureTimeAndDuration (tempFeature, currentOutput, currentFeature, timeStamp);
-
-            for (int value = 0; value < currentFeature.values.size(); ++value)
-            {
-                tempFeature.values.add (currentFeature.values [value]);
-            }
+            bool ignoreFeature = getVampPluginFeatureTimeAndDuration (featureTimeStamp, featureDuration, currentOutput, 
+                                                                      currentFeature, timeStamp, currentPlugin->nextFeatureTimeStamp);
 
             if (! ignoreFeature)
             {
-                currentPlugin->featureValues.getReference (feature).add (tempFeature);
+                int numValues = (int) currentFeature.values.size();
+                double *values = currentPlugin->featureStore.addFeature (feature, featureTimeStamp, featureDuration, numValues);
+
+                for (int value = 0; value < numValues; ++value)
+                {
+                    values [value] = currentFeature.values [value];
+                }
             }
         }
     }
 }
 
-bool SAFEFeatureExtractor::getVampPluginFeatureTimeAndDuration (AudioFeature &newFeature, 
+bool SAFEFeatureExtractor::getVampPluginFeatureTimeAndDuration (int &featureTimeStamp, int &featureDuration, 
                                                                 const VampOutputDescriptor &output,
                                                                 const VampFeature &feature,
-                                                                int timeStamp)
+                                                                int timeStamp,
+                                                                int &nextFeatureTimeStamp)
 {
     switch (output.sampleType)
     {
         case VampOutputDescriptor::OneSamplePerStep:
-            newFeature.timeStamp = timeStamp;
-            newFeature.duration = 0;
+            featureTimeStamp = timeStamp;
+            featureDuration = 0;
             break;
 
         case VampOutputDescriptor::FixedSampleRate:
@@ -1240,23 +1205,23 @@ bool SAFEFeatureExtractor::getVampPluginFeatureTimeAndDuration (AudioFeature &ne
 
             if (feature.hasTimestamp)
             {
-                newFeature.timeStamp = feature.timestamp.msec();
+                featureTimeStamp = feature.timestamp.msec();
             }
             else
             {
                 int timeStampIncrement = 1000 / output.sampleRate;
 
-                newFeature.timeStamp = nextVampFeatureTimeStamp;
-                nextVampFeatureTimeStamp += timeStampIncrement;
+                featureTimeStamp = nextFeatureTimeStamp;
+                nextFeatureTimeStamp += timeStampIncrement;
             }
 
             if (feature.hasDuration)
             {
-                newFeature.duration = feature.duration.msec();
+                featureDuration = feature.duration.msec();
             }
             else
             {
-                newFeature.duration = 0;
+                featureDuration = 0;
             }
 
             break;
@@ -1267,11 +1232,11 @@ bool SAFEFeatureExtractor::getVampPluginFeatureTimeAndDuration (AudioFeature &ne
                 return true;
             }
 
-            newFeature.timeStamp = feature.timestamp.msec();
+            featureTimeStamp = feature.timestamp.msec();
 
             if (feature.hasDuration)
             {
-                newFeature.duration = feature.duration.msec();
+                featureDuration = feature.duration.msec();
             }
             else
             {
@@ -1282,7 +1247,7 @@ bool SAFEFeatureExtractor::getVampPluginFeatureTimeAndDuration (AudioFeature &ne
                     minimalDuration = 1000 / output.sampleRate;
                 }
 
-                newFeature.duration = minimalDuration;
+                featureDuration = minimalDuration;
             }
             
             break;
@@ -1295,11 +1260,6 @@ void SAFEFeatureExtractor::clearVampFeatures()
 {
     for (int i = 0; i < vampPlugins.size(); ++i)
     {
-        VampPluginConfiguration *currentPlugin = vampPlugins [i];
-
-        for (int feature = 0; feature < currentPlugin->featureValues.size(); ++feature)
-        {
-            currentPlugin->featureValues.getReference (feature).clear();
-        }
+        vampPlugins [i]->featureStore.clear();
     }
 }
@@ -11,13 +11,6 @@ typedef Vamp::Plugin::FeatureSet VampFeatureSet;
 typedef Vamp::Plugin::FeatureList VampFeatureList;
 typedef Vamp::Plugin::Feature VampFeature;
 
-struct AudioFeature
-{
-    int timeStamp;
-    Array <double> values;
-    int duration;
-};
-
 /** 
  *  A class for extracting features from a block of audio.
  */
@@ -45,8 +38,11 @@ public:
      *                          greater than the frame length it will be set to the 
      *                          frame length
      *  @param sampleRate       the sample rate of the audio to be analysed
+     *  @param expectedNumSamples  the length of audio expected to be analysed at a time - 
+     *                             this is used to size the feature store up front
      */
-    void initialise (int numChannelsInit, int defaultFrameSizeInit, int defaultStepSizeInit, double sampleRate);
+    void initialise (int numChannelsInit, int defaultFrameSizeInit, int defaultStepSizeInit, double sampleRate,
+                     int expectedNumSamples = 0);
 
     //==========================================================================
     //      Add Features
@@ -71,6 +67,15 @@ public:
      */
     void addVampPlugin (const String &libraryName, const String &pluginName);
 
+    /** Set how precisely a feature is kept when it is saved compressed.
+     *
+     *  @param featureName  the name the feature is saved with - vamp outputs
+     *                      are saved as "Vamp " followed by the output name
+     *  @param precision    the largest error allowed in the saved values,
+     *                      0 saves them uncompressed
+     */
+    void setFeaturePrecision (const String &featureName, double precision);
+
     //==========================================================================
     //      Analyse Audio
     //==========================================================================
@@ -84,40 +89,127 @@ public:
      */
     void analyseAudio (AudioSampleBuffer &buffer);
 
+    /** Prepare the feature extractor to analyse a new stream of audio.
+     *
+     *  Any features extracted from previously analysed audio are cleared. This should
+     *  be called before the first call to pushSamples() for each new stream.
+     */
+    void resetAnalysis();
+
+    /** Analyse the next section of a stream of audio.
+     *
+     *  Samples are buffered internally and each analysis frame is analysed as soon
+     *  as enough samples for it have been pushed. This lets the analysis be spread out
+     *  over the time the audio is being recorded rather than happening all at once.
+     *
+     *  @param buffer       the buffer holding the samples to analyse
+     *  @param startSample  the index of the first sample in the buffer to analyse
+     *  @param numSamples   the number of samples to analyse
+     */
+    void pushSamples (const AudioSampleBuffer &buffer, int startSample, int numSamples);
+
+    /** Create the jobs needed to analyse the next section of a stream of audio.
+     *
+     *  This does the same as pushSamples() but rather than running the analysis it
+     *  adds a job for each analysis configuration to an array. This way the jobs from
+     *  several feature extractors can be run on the shared analysis thread pool 
+     *  together. The buffer must stay valid until all the jobs have been run.
+     *
+     *  @param jobs         the array to add the new jobs to
+     *  @param buffer       the buffer holding the samples to analyse
+     *  @param startSample  the index of the first sample in the buffer to analyse
+     *  @param numSamples   the number of samples to analyse
+     */
+    void addAnalysisJobs (OwnedArray <ThreadPoolJob> &jobs, const AudioSampleBuffer &buffer, int startSample, int numSamples);
+
+    /** Finish analysing a stream of audio.
+     *
+     *  This collects any features the vamp plug-ins have been holding on to. It
+     *  should be called once all the samples in a stream have been passed to
+     *  pushSamples().
+     */
+    void finishAnalysis();
+
     /** Set a windowing function for use in the spectral analysis.
      *
      *  During spectral analysis each frame of audio is passed to the windowing 
      *  function to have a window applied. By default the spectral analysis uses
      *  a Hann window.
      *
+     *  The function is only run once for each frame size, over a frame of ones,
+     *  to build a window table, so it should apply its window by multiplication.
+     *
      *  @param newWindowingFunction  a pointer to the new windowing function to use -
      *                               the function should apply a window function of length
      *                               numSamples to the audioData
      */
     void setWindowingFunction (void (*newWindowingFunction) (float*, int));
 
+    /** Set the type of window used in the spectral analysis.
+     *
+     *  @param newWindowType  the type of window to use
+     *  @param kaiserBeta     the beta parameter for Kaiser windows
+     */
+    void setWindowType (AnalysisWindows::Type newWindowType, double kaiserBeta = 8.6);
+
     /** Add the recorded audio features to an xml element.
      *
      *  This should be called after a call to analyseAudio() has returned.
      *  It will put all the audio features which were recorded into an xml element
-     *  you pass it.
+     *  you pass it. The Feature elements in each channel are in time order, oldest
+     *  first.
      */
     void addFeaturesToXmlElement (XmlElement *element);
 
+    /** Write the recorded audio features to an xml stream.
+     *
+     *  This writes the same elements as addFeaturesToXmlElement() as children
+     *  of the element currently open in the writer, in the same order, oldest
+     *  first, but without keeping them all in memory at once.
+     */
+    void writeFeaturesToXmlStream (XmlStreamWriter &writer);
+
+    /** Add the recorded audio features to a binary feature writer.
+     *
+     *  This is the binary equivalent of addFeaturesToXmlElement(). The features
+     *  are not copied, so nothing should be analysed until the writer is done.
+     */
+    void addFeaturesToBinaryWriter (AudioFeatureBinaryFormat::Writer &writer);
+
+    /** Returns the values of a libxtract feature for the last audio analysed.
+     *
+     *  The feature must have been added with addLibXtractFeature().
+     *
+     *  @param feature  the feature to get
+     *  @param channel  the channel to get the feature for
+     */
+    AudioFeatureColumn getLibXtractFeatureValues (LibXtract::Feature feature, int channel) const;
+
+    /** Returns the number of vamp plug-ins which were loaded successfully. */
+    int getNumVampPlugins() const;
+
+    /** Returns the number of outputs a vamp plug-in has. */
+    int getNumVampPluginOutputs (int pluginIndex) const;
+
+    /** Returns the values of one of a vamp plug-in's outputs for the last audio analysed.
+     *
+     *  @param pluginIndex  the index of the plug-in
+     *  @param output       the index of the output
+     */
+    AudioFeatureColumn getVampPluginFeatureValues (int pluginIndex, int output) const;
+
 private:
     bool initialised;
-    int numChannels, defaultFrameSize, defaultStepSize;
+    int numChannels, defaultFrameSize, defaultStepSize, expectedNumSamples;
     double fs;
 
     // some fft bits
     std::map <int, ScopedPointer <FFT> > fftCache;
-    std::map <int, AudioSampleBuffer> spectraCache;
 
     void cacheNewFFT (int size);
 
-    void calculateSpectra (const AudioSampleBuffer &frame);
-    void (*windowingFunction) (float*, int);
-    static void applyHannWindow (float *data, int numSamples);
+    AnalysisWindows windows;
+    void updateWindows();
 
     struct AnalysisConfiguration
     {
@@ -125,51 +217,97 @@ private:
         int stepSize;
         bool libXtractConfiguration;
         Array <int> vampPluginIndicies;
+
+        // streaming bits
+        AudioSampleBuffer frameBuffer;
+        int samplesInFrame;
+        int samplesToSkip;
+        int frameStart;
+
+        // the analysis plan, worked out by prepareAnalysisConfigurations()
+        bool spectraNeeded;
+
+        // each configuration has its own spectra so they can be analysed in parallel
+        FFT *fft;
+        const float *window;
+        AudioSampleBuffer spectra;
+        HeapBlock <bool> spectrumCalculated;
     };
 
     OwnedArray <AnalysisConfiguration> analysisConfigurations;
+    SharedResourcePointer <AnalysisThreadPool> analysisThreadPool;
+
+    class AnalysisJob : public ThreadPoolJob
+    {
+    public:
+        AnalysisJob (SAFEFeatureExtractor &extractorInit, AnalysisConfiguration &configInit,
+                     const AudioSampleBuffer &bufferInit, int startSampleInit, int numSamplesInit);
+
+        JobStatus runJob();
+
+    private:
+        SAFEFeatureExtractor &extractor;
+        AnalysisConfiguration &config;
+        const AudioSampleBuffer &buffer;
+        int startSample, numSamples;
+    };
+
+    void prepareAnalysisConfigurations();
+    void pushSamplesToConfiguration (AnalysisConfiguration &config, const AudioSampleBuffer &buffer, int startSample, int numSamples);
+    const float* getSpectrum (AnalysisConfiguration &config, int channel);
+    const AudioSampleBuffer& getSpectra (AnalysisConfiguration &config);
 
     AnalysisConfiguration* addNewAnalysisConfiguration (int frameSize, int stepSize, bool libXtractConfiguration);
     void addVampPluginToAnalysisConfigurations (int pluginIndex, int frameSize, int stepSize);
     const AnalysisConfiguration* getVampPluginAnalysisConfiguration (int pluginIndex);
+    void analyseFrame (AnalysisConfiguration &config);
 
-    void addAudioFeatureToXmlElement (XmlElement *element, const AudioFeature &feature);
+    void addAudioFeatureToXmlElement (XmlElement *element, const AudioFeatureColumn &features, int index);
+    void writeAudioFeaturesToXmlStream (XmlStreamWriter &writer, const AudioFeatureColumn &features);
+    int getExpectedNumFrames (int stepSize) const;
     String doubleToString (double value);
+
+    HashMap <String, double> featurePrecisions;
     
     //==========================================================================
     //      libxtract stuff
     //==========================================================================
-    bool libXtractSpectrumNeeded, libXtractPeakSpectrumNeeded, libXtractHarmonicSpectrumNeeded;
-    bool calculateLibXtractScalarFeature [LibXtract::NumScalarFeatures];
+    LibXtractFeatureGraph libXtractFeatureGraph;
     Array <Array <double> > libXtractScalarFeatureValues;
+    Array <Array <double*> > libXtractFeatureBuffers;
 
     static const int numLibXtractBarkBands = 25;
     HeapBlock <int> libXtractBarkBandLimits;
-    bool calculateLibXtractBarkCoefficients;
     Array <Array <double> > libXtractBarkCoefficients;
 
     static const int numLibXtractMelFilters = 13;
     xtract_mel_filter libXtractMelFilters;
     bool libXtractMelFiltersInitialised;
-    bool calculateLibXtractMFCCs;
     Array <Array <double> > libXtractMFCCs;
     void deleteLibXtractMelFilters();
 
     Array <Array <double> > libXtractSpectra, libXtractPeakSpectra, libXtractHarmonicSpectra;
 
-    HeapBlock <double> libXtractChannelData;
+    Array <Array <double> > libXtractChannelData;
 
     struct LibXtractFeature
     {
         LibXtract::Feature featureNumber;
-        Array <Array <AudioFeature> > featureValues;
+
+        // the store column for the first channel, the others follow on
+        int firstColumn;
     };
 
+    AudioFeatureStore libXtractFeatureStore;
+
     OwnedArray <LibXtractFeature> libXtractFeatureValues;
 
     void initialiseLibXtract();
-    void calculateLibXtractSpectra();
-    void calculateLibXtractFeatures (const AudioSampleBuffer &frame);
+    void calculateLibXtractSpectrum (AnalysisConfiguration &config, int channel);
+    void calculateLibXtractFeatures (AnalysisConfiguration &config);
+    void calculateLibXtractFeatureGroup (AnalysisConfiguration &config, int channel, LibXtractFeatureGraph::Node node,
+                                         double *scalarFeatureValues, double * const *buffers);
+    void calculateLibXtractSpectralMoments (const double *spectrum, double *results);
     void addLibXtractFeaturesToList (int timeStamp);
     void clearLibXtractFeatures();
 
@@ -182,7 +320,10 @@ private:
         int stepSize;
         ScopedPointer <VampPlugin> plugin;
         VampOutputList outputs;
-        Array <Array <AudioFeature> > featureValues;
+
+        // one column for each output
+        AudioFeatureStore featureStore;
+        int nextFeatureTimeStamp;
     };
 
     VampPluginLoader *vampPluginLoader;
@@ -192,15 +333,15 @@ private:
     void initialiseVampPlugins();
     void resetVampPlugins();
     void loadAndInitialiseVampPlugin (const VampPluginKey &key);
-    void calculateVampPluginFeatures (const Array <int> &plugins, const AudioSampleBuffer &frame, int timeStamp);
+    void calculateVampPluginFeatures (AnalysisConfiguration &config, int timeStamp);
     void getRemainingVampPluginFeatures();
     void addVampPluginFeaturesToList (int pluginIndex, VampFeatureSet &features, int timeStamp);
-    bool getVampPluginFeatureTimeAndDuration (AudioFeature &newFeature, 
+    bool getVampPluginFeatureTimeAndDuration (int &featureTimeStamp, int &featureDuration, 
                                               const VampOutputDescriptor &output,
                                               const VampFeature &feature,
-                                              int timeStamp);
+                                              int timeStamp,
+                                              int &nextFeatureTimeStamp);
     void clearVampFeatures();
-    int nextVampFeatureTimeStamp;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SAFEFeatureExtractor);
 };
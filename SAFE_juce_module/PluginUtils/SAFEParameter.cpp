@@ -1,3 +1,40 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace SAFEParameterHelpers
+{
+    union PackedValues
+    {
+        float values [2];
+        int64 packed;
+    };
+
+    static int64 packValues (float baseValue, float scaledValue)
+    {
+        PackedValues values;
+        values.values [0] = baseValue;
+        values.values [1] = scaledValue;
+
+        return values.packed;
+    }
+
+    static float getBaseValue (int64 packed)
+    {
+        PackedValues values;
+        values.packed = packed;
+
+        return values.values [0];
+    }
+
+    static float getScaledValue (int64 packed)
+    {
+        PackedValues values;
+        values.packed = packed;
+
+        return values.values [1];
+    }
+}
+
 //==========================================================================
 //      Constructor and Destructor
 //==========================================================================
@@ -19,9 +56,16 @@ SAFEParameter::SAFEParameter (String nameInit, float& valueRef, float initialVal
     interpolationTime = interpolationTimeInit;
     updateBlockSizes();
 
+    rampsEnabled = false;
+    rampSize = 0;
+    rampSamplesLeft = 0;
+    rampStep = 0;
+
     UIScaleFactor = UIScaleFactorInit;
 
+    // nothing else can be using the parameter yet so the value is picked up straight away
     setScaledValue (defaultValue);
+    applyValues (targetValues.get());
 }
 
 SAFEParameter::~SAFEParameter()
@@ -33,50 +77,42 @@ SAFEParameter::~SAFEParameter()
 //==========================================================================
 void SAFEParameter::setBaseValue (float newBaseValue)
 {
-    baseValue = newBaseValue;
-    
     float range = maxValue - minValue;
-    scaledValue = range * pow (baseValue, (1 / skewFactor)) + minValue;
-    
-    gainValue = Decibels::decibelsToGain (scaledValue);
+    float newScaledValue = range * pow (newBaseValue, (1 / skewFactor)) + minValue;
 
-    startInterpolating();
+    setTargetValues (newBaseValue, newScaledValue);
 }
 
 void SAFEParameter::setScaledValue (float newScaledValue)
 {
-    scaledValue = newScaledValue;
-    
-    gainValue = Decibels::decibelsToGain (scaledValue);
-    
     float range = maxValue - minValue;
-    float proportion = scaledValue - minValue;
-    baseValue = pow ((proportion / range), skewFactor);  
+    float proportion = newScaledValue - minValue;
+    float newBaseValue = pow ((proportion / range), skewFactor);  
 
-    startInterpolating();
+    setTargetValues (newBaseValue, newScaledValue);
 }
 
 float SAFEParameter::getBaseValue() const
 {
-    return baseValue;
+    return SAFEParameterHelpers::getBaseValue (targetValues.get());
 }
 
 float SAFEParameter::getScaledValue() const
 {
-    return scaledValue;
+    return SAFEParameterHelpers::getScaledValue (targetValues.get());
 }
 
 float SAFEParameter::getUIScaledValue() const
 {
-    return scaledValue * UIScaleFactor;
+    return getScaledValue() * UIScaleFactor;
 }
 
 float SAFEParameter::getGainValue() const
 {
     if (convertToGain)
-        return gainValue;
+        return Decibels::decibelsToGain (getScaledValue());
     else
-        return scaledValue;
+        return getScaledValue();
 }
 
 float SAFEParameter::getDefaultValue() const
@@ -135,6 +171,20 @@ void SAFEParameter::setInterpolationTime (double newInterpolationTime)
     updateBlockSizes();
 }
 
+bool SAFEParameter::updateValue()
+{
+    const int64 newValues = targetValues.get();
+
+    if (newValues == currentValues)
+    {
+        return false;
+    }
+
+    applyValues (newValues);
+
+    return true;
+}
+
 bool SAFEParameter::isInterpolating() const
 {
     return interpolating;
@@ -153,13 +203,7 @@ void SAFEParameter::smoothValues()
             interpolating = false;
         }
 
-        float range = maxValue - minValue;
-        float smoothedScaledValue = range * pow (smoothedValue, (1 / skewFactor)) + minValue;
-
-        if (convertToGain)
-            outputValue = Decibels::decibelsToGain (smoothedScaledValue);
-        else
-            outputValue = smoothedScaledValue;
+        outputValue = getOutputValue (smoothedValue);
     }
     else
     {
@@ -170,6 +214,22 @@ void SAFEParameter::smoothValues()
     }
 }
 
+void SAFEParameter::setTargetValues (float newBaseValue, float newScaledValue)
+{
+    // the pair is written in one go so the audio thread can't pick up half of a change
+    targetValues = SAFEParameterHelpers::packValues (newBaseValue, newScaledValue);
+}
+
+void SAFEParameter::applyValues (int64 newValues)
+{
+    currentValues = newValues;
+    baseValue = SAFEParameterHelpers::getBaseValue (newValues);
+    scaledValue = SAFEParameterHelpers::getScaledValue (newValues);
+    gainValue = Decibels::decibelsToGain (scaledValue);
+
+    startInterpolating();
+}
+
 void SAFEParameter::updateBlockSizes()
 {
     controlBlockSize = (int) (sampleRate / controlRate);
@@ -190,11 +250,19 @@ void SAFEParameter::startInterpolating()
 
         initialised = true;
     }
-    else if (interpolationTime < 1000.0 / controlRate)
+    else if (rampsEnabled ? interpolationBlockSize < 2 : interpolationTime < 1000.0 / controlRate)
     {
         interpolating = false;
+        smoothedValue = baseValue;
         smoothValues();
     }
+    else if (rampsEnabled)
+    {
+        rampStep = (baseValue - smoothedValue) / interpolationBlockSize;
+        rampSamplesLeft = interpolationBlockSize;
+
+        interpolating = ! (smoothedValue == baseValue);
+    }
     else
     {
         interpolationStep = (baseValue - smoothedValue) / controlBlocksPerChange;
@@ -202,4 +270,121 @@ void SAFEParameter::startInterpolating()
 
         interpolating = ! (smoothedValue == baseValue);
     }
+
+    // a ramp which isn't moving always holds the current value, so it needn't be filled
+    if (rampsEnabled && ! interpolating)
+    {
+        FloatVectorOperations::fill (ramp, outputValue, rampSize);
+    }
+}
+
+float SAFEParameter::getOutputValue (float smoothedBaseValue) const
+{
+    float range = maxValue - minValue;
+    float smoothedScaledValue = range * pow (smoothedBaseValue, (1 / skewFactor)) + minValue;
+
+    if (convertToGain)
+        return Decibels::decibelsToGain (smoothedScaledValue);
+    else
+        return smoothedScaledValue;
+}
+
+//==========================================================================
+//      Ramps
+//==========================================================================
+void SAFEParameter::setRampsEnabled (bool shouldUseRamps, int maximumBlockSize)
+{
+    // a change in smoothing method finishes any change in progress
+    if (interpolating)
+    {
+        interpolating = false;
+        smoothedValue = baseValue;
+        outputValue = getOutputValue (smoothedValue);
+    }
+
+    rampsEnabled = shouldUseRamps;
+    rampSize = rampsEnabled ? jmax (1, maximumBlockSize) : 0;
+
+    ramp.allocate (jmax (1, rampSize), false);
+    FloatVectorOperations::fill (ramp, outputValue, jmax (1, rampSize));
+}
+
+void SAFEParameter::fillRamp (int numSamples)
+{
+    jassert (rampsEnabled && numSamples <= rampSize);
+    numSamples = jmin (numSamples, rampSize);
+
+    if (numSamples <= 0)
+    {
+        return;
+    }
+
+    // the ramp was filled with the value when it stopped moving
+    if (! interpolating)
+    {
+        return;
+    }
+
+    const int rampSamples = jmin (numSamples, rampSamplesLeft);
+    const float startValue = outputValue;
+
+    rampSamplesLeft -= rampSamples;
+
+    if (rampSamplesLeft <= 0)
+    {
+        smoothedValue = baseValue;
+        interpolating = false;
+    }
+    else
+    {
+        smoothedValue += rampStep * rampSamples;
+    }
+
+    const float endValue = getOutputValue (smoothedValue);
+    float *rampData = ramp;
+
+    if (convertToGain && startValue > 0 && endValue > 0)
+    {
+        // the first few values are multiplied up one at a time, then each chunk is a
+        // multiple of the one before so the rest can use the vector operations
+        const int chunkSize = 16;
+        const double ratio = pow ((double) endValue / startValue, 1.0 / rampSamples);
+        const float chunkRatio = (float) pow (ratio, (double) chunkSize);
+
+        double value = startValue;
+
+        for (int i = 0; i < jmin (chunkSize, rampSamples); ++i)
+        {
+            value *= ratio;
+            rampData [i] = (float) value;
+        }
+
+        for (int i = chunkSize; i < rampSamples; i += chunkSize)
+        {
+            FloatVectorOperations::copyWithMultiply (rampData + i, rampData + i - chunkSize, chunkRatio,
+                                                     jmin (chunkSize, rampSamples - i));
+        }
+    }
+    else
+    {
+        // no dependence between samples so the compiler can vectorise this
+        const float step = (endValue - startValue) / rampSamples;
+
+        for (int i = 0; i < rampSamples; ++i)
+        {
+            rampData [i] = startValue + step * (i + 1);
+        }
+    }
+
+    // land exactly on the value the next block starts from, once the ramp has
+    // finished the rest of it is filled so it needn't be touched again
+    rampData [rampSamples - 1] = endValue;
+    FloatVectorOperations::fill (rampData + rampSamples, endValue, (interpolating ? numSamples : rampSize) - rampSamples);
+
+    outputValue = endValue;
+}
+
+const float* SAFEParameter::getRamp() const
+{
+    return ramp;
 }
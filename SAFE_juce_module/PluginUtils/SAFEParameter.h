@@ -3,6 +3,12 @@
 
 /** 
  *  A class for handling SAFE plug-in parameters.
+ *
+ *  The value setters and getters can be called from any thread. New values
+ *  are left in a single atomic and the audio thread picks them up once per
+ *  block with updateValue(), so it never sees half a change however many
+ *  threads the host sets parameters from. The smoothing functions should
+ *  only be called on the audio thread.
  */
 class SAFEParameter
 {
@@ -42,6 +48,8 @@ public:
      *  can be used to set the parameter value without having to do any conversion
      *  yourself.
      *
+     *  The new value isn't used for processing until updateValue() is called.
+     *
      *  @param newValue  the new parameter value in the range 0-1
      */
     void setBaseValue (float newValue);
@@ -113,6 +121,14 @@ public:
      */
     void setInterpolationTime (double newInterpolationTime);
 
+    /** Pick up the most recent value the parameter was set to.
+     *
+     *  This should be called on the audio thread at the start of each block.
+     *
+     *  @return true if the parameter has been set since the last call
+     */
+    bool updateValue();
+
     /** Returns true if the parameter value is not yet equal to the value it was set to. */
     bool isInterpolating() const;
 
@@ -123,8 +139,44 @@ public:
      */
     void smoothValues();
 
+    //==========================================================================
+    //      Ramps
+    //==========================================================================
+    /** Smooth the parameter a sample at a time into a ramp buffer rather than
+     *  a control block at a time.
+     *
+     *  This allocates so it shouldn't be called while audio is being processed.
+     *
+     *  @param shouldUseRamps    whether to fill a ramp for each block
+     *  @param maximumBlockSize  the largest number of samples fillRamp() will be asked for
+     */
+    void setRampsEnabled (bool shouldUseRamps, int maximumBlockSize);
+
+    /** Fill the ramp with the parameter's value for each of the next samples.
+     *
+     *  This only needs calling while the parameter is interpolating, otherwise
+     *  the ramp already holds its value.
+     *
+     *  Parameters converted to gains ramp exponentially, which is a straight
+     *  line in decibels, others ramp linearly. Skewed parameters follow their
+     *  curve at the block ends and ramp straight between them.
+     *
+     *  @param numSamples  the number of samples in the block about to be processed
+     */
+    void fillRamp (int numSamples);
+
+    /** Returns the values written by the last call to fillRamp(). */
+    const float* getRamp() const;
+
 private:
-    float baseValue, minValue, maxValue, defaultValue, skewFactor, scaledValue, gainValue;
+    float minValue, maxValue, defaultValue, skewFactor;
+
+    // the base and scaled values packed together, written by any thread
+    Atomic <int64> targetValues;
+
+    // the values the audio thread has picked up
+    int64 currentValues;
+    float baseValue, scaledValue, gainValue;
     float smoothedValue;
 
     double sampleRate, controlRate, interpolationTime;
@@ -133,6 +185,11 @@ private:
     int controlBlockSize, interpolationBlockSize;
     int controlBlocksPerChange, currentControlBlock;
 
+    bool rampsEnabled;
+    HeapBlock <float> ramp;
+    int rampSize, rampSamplesLeft;
+    float rampStep;
+
     bool interpolating, initialised;
     float& outputValue;
     
@@ -142,9 +199,13 @@ private:
 
     double UIScaleFactor;
 
+    void setTargetValues (float newBaseValue, float newScaledValue);
+    void applyValues (int64 newValues);
+
     void updateBlockSizes();
 
     void startInterpolating();
+    float getOutputValue (float smoothedBaseValue) const;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SAFEParameter)
 };
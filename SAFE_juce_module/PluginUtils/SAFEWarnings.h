@@ -13,7 +13,8 @@ enum WarningID
     DescriptorNotOnServer, /**< Can't load something that doesn't exist. */
     DescriptorNotInFile, /**< Can't load something that doesn't exist. */
     DescriptorBoxEmpty, /**< Can't load nothing. */
-    CannotReachServer /**< No connection to the interwebz. */
+    CannotReachServer, /**< No connection to the interwebz. */
+    CannotSaveData /**< The data couldn't be written to disk. */
 };
 
 #endif // __SAFEWARNINGS__
@@ -0,0 +1,574 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace SemanticDataReaderHelpers
+{
+    // these have to match the files written by SemanticDataStore and AudioFeatureBinaryFormat
+    static const char logMagicNumber [4] = {'S', 'L', 'O', 'G'};
+    static const char recordMagicNumber [4] = {'S', 'R', 'E', 'C'};
+    static const char indexMagicNumber [4] = {'S', 'I', 'D', 'X'};
+    static const char featureMagicNumber [4] = {'S', 'A', 'F', 'F'};
+
+    static const int logHeaderSize = 16;
+    static const int indexHeaderSize = 8;
+    static const int recordHeaderSize = 8;
+    static const int recordTrailerSize = 8;
+    static const int featureHeaderSize = 16;
+    static const int firstAlignedFeatureVersion = 2;
+
+    static int getPadding (int64 numBytes, int alignment)
+    {
+        return (int) ((alignment - numBytes % alignment) % alignment);
+    }
+
+    static int readInt (const char *data)
+    {
+        return (int) ByteOrder::littleEndianInt (data);
+    }
+
+    /** Strings are an int32 length followed by UTF-8, padded to a 4 byte boundary. */
+    static String readString (const char *data)
+    {
+        return String::fromUTF8 (data + sizeof (int), readInt (data));
+    }
+
+    static const char* skipString (const char *data)
+    {
+        const int length = readInt (data);
+        return data + sizeof (int) + length + getPadding (length, 4);
+    }
+
+    //==========================================================================
+    /** Moves through a block of mapped memory, failing rather than going past the end. */
+    class MappedCursor
+    {
+    public:
+        MappedCursor (const char *blockStart, int64 blockSize)
+            : start (blockStart),
+              size (blockSize),
+              position (0),
+              failed (false)
+        {
+        }
+
+        bool hasFailed() const
+        {
+            return failed;
+        }
+
+        const char* getCurrent() const
+        {
+            return start + position;
+        }
+
+        const char* skip (int64 numBytes)
+        {
+            if (failed || numBytes < 0 || numBytes > size - position)
+            {
+                failed = true;
+                return nullptr;
+            }
+
+            const char *data = start + position;
+            position += numBytes;
+            return data;
+        }
+
+        int readInt()
+        {
+            const char *data = skip (sizeof (int));
+            return data != nullptr ? SemanticDataReaderHelpers::readInt (data) : 0;
+        }
+
+        double readDouble()
+        {
+            double value = 0.0;
+
+            if (const char *data = skip (sizeof (double)))
+            {
+                memcpy (&value, data, sizeof (double));
+            }
+
+            return value;
+        }
+
+        const char* skipString()
+        {
+            const char *data = getCurrent();
+            const int length = readInt();
+
+            skip (length < 0 ? -1 : (int64) length + getPadding (length, 4));
+            return failed ? nullptr : data;
+        }
+
+        void align (int alignment)
+        {
+            skip (getPadding (position, alignment));
+        }
+
+    private:
+        const char *start;
+        int64 size, position;
+        bool failed;
+    };
+
+    /** Returns true if a block holds features which can be viewed in place. */
+    static bool isAlignedFeatureBlock (const char *data, int size)
+    {
+        if (data == nullptr || size < featureHeaderSize || memcmp (data, featureMagicNumber, sizeof (featureMagicNumber)) != 0)
+        {
+            return false;
+        }
+
+        const int version = readInt (data + 4);
+        const int valueType = readInt (data + 8);
+        const int numFeatureSets = readInt (data + 12);
+
+        return version >= firstAlignedFeatureVersion
+            && version <= AudioFeatureBinaryFormat::currentVersion
+            && (valueType == AudioFeatureBinaryFormat::Float32Values || valueType == AudioFeatureBinaryFormat::Float64Values)
+            && numFeatureSets >= 0;
+    }
+}
+
+//==========================================================================
+//      Feature Set View
+//==========================================================================
+SemanticDataReader::FeatureSetView::FeatureSetView()
+    : valueType (AudioFeatureBinaryFormat::Float32Values),
+      numFeatures (0),
+      numValues (0),
+      timeStamps (nullptr),
+      durations (nullptr),
+      valueOffsets (nullptr),
+      values (nullptr)
+{
+}
+
+int SemanticDataReader::FeatureSetView::getNumValues (int feature) const
+{
+    jassert (isPositiveAndBelow (feature, numFeatures));
+
+    return valueOffsets [feature + 1] - valueOffsets [feature];
+}
+
+const float* SemanticDataReader::FeatureSetView::getFloatValues (int feature) const
+{
+    jassert (valueType == AudioFeatureBinaryFormat::Float32Values && isPositiveAndBelow (feature, numFeatures));
+
+    return static_cast <const float*> (values) + valueOffsets [feature];
+}
+
+const double* SemanticDataReader::FeatureSetView::getDoubleValues (int feature) const
+{
+    jassert (valueType == AudioFeatureBinaryFormat::Float64Values && isPositiveAndBelow (feature, numFeatures));
+
+    return static_cast <const double*> (values) + valueOffsets [feature];
+}
+
+//==========================================================================
+//      Record
+//==========================================================================
+SemanticDataReader::Record::Record()
+    : descriptors (nullptr),
+      numDescriptors (0),
+      pluginCode (nullptr),
+      numInputs (0),
+      numOutputs (0),
+      analysisTime (0),
+      numParameters (0),
+      parameters (nullptr),
+      metaData (nullptr),
+      sampleRate (0.0)
+{
+    features [UnprocessedAudio] = nullptr;
+    features [ProcessedAudio] = nullptr;
+    featureSizes [UnprocessedAudio] = 0;
+    featureSizes [ProcessedAudio] = 0;
+}
+
+bool SemanticDataReader::Record::isValid() const
+{
+    return descriptors != nullptr;
+}
+
+int SemanticDataReader::Record::getNumDescriptors() const
+{
+    return numDescriptors;
+}
+
+String SemanticDataReader::Record::getDescriptor (int index) const
+{
+    using namespace SemanticDataReaderHelpers;
+
+    if (! isPositiveAndBelow (index, numDescriptors))
+    {
+        return String::empty;
+    }
+
+    // the strings were all checked against the end of the record when it was found
+    const char *descriptor = descriptors;
+
+    for (int i = 0; i < index; ++i)
+    {
+        descriptor = skipString (descriptor);
+    }
+
+    return readString (descriptor);
+}
+
+StringArray SemanticDataReader::Record::getDescriptors() const
+{
+    using namespace SemanticDataReaderHelpers;
+
+    StringArray descriptorList;
+    const char *descriptor = descriptors;
+
+    for (int i = 0; i < numDescriptors; ++i)
+    {
+        descriptorList.add (readString (descriptor));
+        descriptor = skipString (descriptor);
+    }
+
+    return descriptorList;
+}
+
+String SemanticDataReader::Record::getPluginCode() const
+{
+    return isValid() ? SemanticDataReaderHelpers::readString (pluginCode) : String::empty;
+}
+
+int SemanticDataReader::Record::getNumInputs() const
+{
+    return numInputs;
+}
+
+int SemanticDataReader::Record::getNumOutputs() const
+{
+    return numOutputs;
+}
+
+int SemanticDataReader::Record::getAnalysisTime() const
+{
+    return analysisTime;
+}
+
+double SemanticDataReader::Record::getSampleRate() const
+{
+    return sampleRate;
+}
+
+int SemanticDataReader::Record::getNumParameters() const
+{
+    return numParameters;
+}
+
+const float* SemanticDataReader::Record::getParameters() const
+{
+    return parameters;
+}
+
+SAFEMetaData SemanticDataReader::Record::getMetaData() const
+{
+    using namespace SemanticDataReaderHelpers;
+
+    SAFEMetaData data;
+
+    if (! isValid())
+    {
+        return data;
+    }
+
+    const char *text = metaData;
+
+    data.genre = readString (text);
+    text = skipString (text);
+    data.instrument = readString (text);
+    text = skipString (text);
+    data.location = readString (text);
+    text = skipString (text);
+    data.experience = readString (text);
+    text = skipString (text);
+    data.age = readString (text);
+    text = skipString (text);
+    data.language = readString (text);
+
+    return data;
+}
+
+int SemanticDataReader::Record::getNumFeatureSets (FeatureSource source) const
+{
+    const char *featureData = features [source];
+
+    return featureData != nullptr ? SemanticDataReaderHelpers::readInt (featureData + 12) : 0;
+}
+
+bool SemanticDataReader::Record::getFeatureSet (FeatureSource source, int index, FeatureSetView &view) const
+{
+    using namespace SemanticDataReaderHelpers;
+
+    const int numFeatureSets = getNumFeatureSets (source);
+
+    if (! isPositiveAndBelow (index, numFeatureSets))
+    {
+        return false;
+    }
+
+    const char *featureData = features [source];
+    const AudioFeatureBinaryFormat::ValueType valueType = static_cast <AudioFeatureBinaryFormat::ValueType> (readInt (featureData + 8));
+    const int valueSize = AudioFeatureBinaryFormat::getValueSize (valueType);
+
+    // find where the columns start
+    MappedCursor columns (featureData, featureSizes [source]);
+    columns.skip (featureHeaderSize);
+
+    for (int i = 0; i < numFeatureSets; ++i)
+    {
+        columns.skipString();
+        columns.skip (5 * sizeof (int));
+    }
+
+    // go through the dictionary again, skipping the columns of each set before the one wanted
+    MappedCursor dictionary (featureData, featureSizes [source]);
+    dictionary.skip (featureHeaderSize);
+
+    for (int i = 0; i <= index; ++i)
+    {
+        const char *name = dictionary.skipString();
+        const int frameSize = dictionary.readInt();
+        const int stepSize = dictionary.readInt();
+        const int channel = dictionary.readInt();
+        const int numFeatures = dictionary.readInt();
+        const int numValues = dictionary.readInt();
+
+        if (dictionary.hasFailed() || columns.hasFailed() || numFeatures < 0 || numValues < 0)
+        {
+            return false;
+        }
+
+        const char *timeStamps = nullptr;
+        const char *durations = nullptr;
+        const char *valueOffsets = nullptr;
+        const char *values = nullptr;
+
+        if (numFeatures > 0)
+        {
+            timeStamps = columns.skip ((int64) numFeatures * sizeof (int));
+            durations = columns.skip ((int64) numFeatures * sizeof (int));
+            valueOffsets = columns.skip (((int64) numFeatures + 1) * sizeof (int));
+            columns.align (8);
+            values = columns.skip ((int64) numValues * valueSize);
+
+            if (columns.hasFailed())
+            {
+                return false;
+            }
+        }
+
+        if (i == index)
+        {
+            view.info.name = readString (name);
+            view.info.frameSize = frameSize;
+            view.info.stepSize = stepSize;
+            view.info.channel = channel;
+            view.valueType = valueType;
+            view.numFeatures = numFeatures;
+            view.numValues = numValues;
+            view.timeStamps = reinterpret_cast <const int*> (timeStamps);
+            view.durations = reinterpret_cast <const int*> (durations);
+            view.valueOffsets = reinterpret_cast <const int*> (valueOffsets);
+            view.values = values;
+
+            // the offsets are used to index the values so they have to be in range
+            return numFeatures == 0
+                || (view.valueOffsets [0] == 0 && view.valueOffsets [numFeatures] == numValues);
+        }
+    }
+
+    return false;
+}
+
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+SemanticDataReader::SemanticDataReader()
+    : recordOffsets (nullptr),
+      numRecords (0)
+{
+}
+
+SemanticDataReader::~SemanticDataReader()
+{
+}
+
+//==========================================================================
+//      Files
+//==========================================================================
+bool SemanticDataReader::open (const File &logFile)
+{
+    using namespace SemanticDataReaderHelpers;
+
+    close();
+
+   #if JUCE_BIG_ENDIAN
+    // the files are used in place so they have to be in the machine's byte order
+    (void) logFile;
+    jassertfalse;
+    return false;
+   #else
+    logMap = new MemoryMappedFile (logFile, MemoryMappedFile::readOnly);
+    indexMap = new MemoryMappedFile (SemanticDataStore::getIndexFile (logFile), MemoryMappedFile::readOnly);
+
+    const char *log = static_cast <const char*> (logMap->getData());
+    const char *index = static_cast <const char*> (indexMap->getData());
+
+    bool ok = log != nullptr && index != nullptr
+           && logMap->getSize() >= (size_t) logHeaderSize
+           && indexMap->getSize() >= (size_t) indexHeaderSize
+           && (indexMap->getSize() - indexHeaderSize) % sizeof (int64) == 0
+           && memcmp (log, logMagicNumber, sizeof (logMagicNumber)) == 0
+           && readInt (log + 4) == SemanticDataStore::currentVersion
+           && memcmp (index, indexMagicNumber, sizeof (indexMagicNumber)) == 0
+           && readInt (index + 4) == SemanticDataStore::currentVersion;
+
+    if (! ok)
+    {
+        close();
+        return false;
+    }
+
+    recordOffsets = reinterpret_cast <const int64*> (index + indexHeaderSize);
+    numRecords = (int) ((indexMap->getSize() - indexHeaderSize) / sizeof (int64));
+
+    // the index can get ahead of the log if a record was appended after the log was mapped
+    while (numRecords > 0 && getRecordSize (numRecords - 1) < 0)
+    {
+        --numRecords;
+    }
+
+    return true;
+   #endif
+}
+
+void SemanticDataReader::close()
+{
+    recordOffsets = nullptr;
+    numRecords = 0;
+
+    logMap = nullptr;
+    indexMap = nullptr;
+}
+
+bool SemanticDataReader::isOpen() const
+{
+    return recordOffsets != nullptr;
+}
+
+//==========================================================================
+//      Records
+//==========================================================================
+int SemanticDataReader::getNumRecords() const
+{
+    return numRecords;
+}
+
+SemanticDataReader::Record SemanticDataReader::getRecord (int index) const
+{
+    using namespace SemanticDataReaderHelpers;
+
+    const int64 recordSize = isPositiveAndBelow (index, numRecords) ? getRecordSize (index) : -1;
+
+    if (recordSize < 0)
+    {
+        return Record();
+    }
+
+    const char *payload = static_cast <const char*> (logMap->getData()) + recordOffsets [index] + recordHeaderSize;
+    MappedCursor cursor (payload, recordSize - recordHeaderSize - recordTrailerSize);
+    Record record;
+
+    record.numDescriptors = cursor.readInt();
+    record.descriptors = cursor.getCurrent();
+
+    for (int i = 0; i < record.numDescriptors && ! cursor.hasFailed(); ++i)
+    {
+        cursor.skipString();
+    }
+
+    record.pluginCode = cursor.skipString();
+    record.numInputs = cursor.readInt();
+    record.numOutputs = cursor.readInt();
+    record.analysisTime = cursor.readInt();
+
+    record.numParameters = cursor.readInt();
+    record.parameters = reinterpret_cast <const float*> (cursor.skip ((int64) record.numParameters * sizeof (float)));
+
+    // genre, instrument, location, experience, age and language
+    record.metaData = cursor.getCurrent();
+
+    for (int i = 0; i < 6; ++i)
+    {
+        cursor.skipString();
+    }
+
+    cursor.align (8);
+    record.sampleRate = cursor.readDouble();
+
+    for (int i = UnprocessedAudio; i <= ProcessedAudio; ++i)
+    {
+        record.featureSizes [i] = cursor.readInt();
+    }
+
+    for (int i = UnprocessedAudio; i <= ProcessedAudio; ++i)
+    {
+        record.features [i] = cursor.skip (record.featureSizes [i]);
+        cursor.align (8);
+    }
+
+    if (cursor.hasFailed() || record.numDescriptors < 0)
+    {
+        return Record();
+    }
+
+    // older features are still in the record but can't be used in place
+    for (int i = UnprocessedAudio; i <= ProcessedAudio; ++i)
+    {
+        if (! isAlignedFeatureBlock (record.features [i], record.featureSizes [i]))
+        {
+            record.features [i] = nullptr;
+            record.featureSizes [i] = 0;
+        }
+    }
+
+    return record;
+}
+
+//==========================================================================
+//      Private Methods
+//==========================================================================
+int64 SemanticDataReader::getRecordSize (int index) const
+{
+    using namespace SemanticDataReaderHelpers;
+
+    const char *log = static_cast <const char*> (logMap->getData());
+    const int64 logSize = (int64) logMap->getSize();
+    const int64 offset = recordOffsets [index];
+
+    if (offset < logHeaderSize || offset % 8 != 0
+        || offset + recordHeaderSize + recordTrailerSize > logSize
+        || memcmp (log + offset, recordMagicNumber, sizeof (recordMagicNumber)) != 0)
+    {
+        return -1;
+    }
+
+    const int payloadSize = readInt (log + offset + 4);
+
+    if (payloadSize < 0 || payloadSize % 8 != 0
+        || offset + recordHeaderSize + payloadSize + recordTrailerSize > logSize
+        || readInt (log + offset + recordHeaderSize + payloadSize + 4) != payloadSize)
+    {
+        return -1;
+    }
+
+    return recordHeaderSize + payloadSize + recordTrailerSize;
+}
@@ -0,0 +1,178 @@
+#ifndef __SEMANTICDATAREADER__
+#define __SEMANTICDATAREADER__
+
+/**
+ *  A read only view of the records in a SemanticDataStore log.
+ *
+ *  The log and its index are memory mapped, so opening a reader doesn't read
+ *  any records and any record can be looked at without reading the ones
+ *  before it. The parameters and feature columns are used in place in the
+ *  mapped file rather than being copied out.
+ *
+ *  A reader sees the records which were in the index when it was opened.
+ *  Records appended after that need the reader to be opened again.
+ *
+ *  The files are little endian, so a reader can only be opened on little
+ *  endian machines. Records whose features were saved before version 2 of
+ *  the AudioFeatureBinaryFormat, or were compressed, have no feature views as
+ *  their columns can't be used in place - use
+ *  SemanticDataStore::readRecordFeatures() for those.
+ */
+class SemanticDataReader
+{
+public:
+    /** The audio a set of features was taken from. */
+    enum FeatureSource
+    {
+        UnprocessedAudio = 0,
+        ProcessedAudio = 1
+    };
+
+    /** A set of features inside the mapped file.
+     *
+     *  The pointers are only valid while the reader which made them is open.
+     */
+    struct FeatureSetView
+    {
+        FeatureSetView();
+
+        /** Returns the number of values a feature has. */
+        int getNumValues (int feature) const;
+
+        /** Returns the values of a feature stored as float32. */
+        const float* getFloatValues (int feature) const;
+
+        /** Returns the values of a feature stored as float64. */
+        const double* getDoubleValues (int feature) const;
+
+        AudioFeatureBinaryFormat::FeatureSetInfo info;
+        AudioFeatureBinaryFormat::ValueType valueType;
+        int numFeatures, numValues;
+
+        const int *timeStamps;
+        const int *durations;
+        const int *valueOffsets;
+        const void *values;
+    };
+
+    //==========================================================================
+    //      Record
+    //==========================================================================
+    /** A record inside the mapped file.
+     *
+     *  Only the fixed size parts of the record are copied when it is found,
+     *  the strings are read when they are asked for. A record is only valid
+     *  while the reader which made it is open.
+     */
+    class Record
+    {
+    public:
+        /** Create an invalid record. */
+        Record();
+
+        /** Returns false if the record couldn't be found. */
+        bool isValid() const;
+
+        /** Returns the number of descriptors the record was saved with. */
+        int getNumDescriptors() const;
+
+        /** Returns one of the descriptors. */
+        String getDescriptor (int index) const;
+
+        /** Returns all the descriptors. */
+        StringArray getDescriptors() const;
+
+        /** Returns the code of the plug-in which saved the record. */
+        String getPluginCode() const;
+
+        int getNumInputs() const;
+        int getNumOutputs() const;
+        int getAnalysisTime() const;
+        double getSampleRate() const;
+
+        /** Returns the number of parameters. */
+        int getNumParameters() const;
+
+        /** Returns the parameters, straight from the mapped file. */
+        const float* getParameters() const;
+
+        /** Returns the metadata the user entered. */
+        SAFEMetaData getMetaData() const;
+
+        /** Returns the number of feature sets taken from some audio.
+         *
+         *  This is 0 if the features can't be viewed in place.
+         */
+        int getNumFeatureSets (FeatureSource source) const;
+
+        /** Find a set of features.
+         *
+         *  @return false if the feature set doesn't exist or can't be viewed in place
+         */
+        bool getFeatureSet (FeatureSource source, int index, FeatureSetView &view) const;
+
+    private:
+        friend class SemanticDataReader;
+
+        const char *descriptors;
+        int numDescriptors;
+        const char *pluginCode;
+        int numInputs, numOutputs, analysisTime;
+        int numParameters;
+        const float *parameters;
+        const char *metaData;
+        double sampleRate;
+        const char *features [2];
+        int featureSizes [2];
+    };
+
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a reader with no files. */
+    SemanticDataReader();
+
+    /** Destructor */
+    ~SemanticDataReader();
+
+    //==========================================================================
+    //      Files
+    //==========================================================================
+    /** Map a log file and its index.
+     *
+     *  @return false if either file is missing or isn't valid
+     */
+    bool open (const File &logFile);
+
+    /** Unmap the files. */
+    void close();
+
+    /** Returns true if a log file is mapped. */
+    bool isOpen() const;
+
+    //==========================================================================
+    //      Records
+    //==========================================================================
+    /** Returns the number of records which can be read. */
+    int getNumRecords() const;
+
+    /** Find a record.
+     *
+     *  The record's checksum isn't checked, SemanticDataStore does that when
+     *  it opens the log.
+     *
+     *  @return the record, which is invalid if it couldn't be found
+     */
+    Record getRecord (int index) const;
+
+private:
+    ScopedPointer <MemoryMappedFile> logMap, indexMap;
+    const int64 *recordOffsets;
+    int numRecords;
+
+    int64 getRecordSize (int index) const;
+
+    JUCE_DECLARE_NON_COPYABLE (SemanticDataReader)
+};
+
+#endif // __SEMANTICDATAREADER__
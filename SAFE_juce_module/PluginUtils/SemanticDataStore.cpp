@@ -0,0 +1,1612 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace SemanticDataStoreHelpers
+{
+    static const char logMagicNumber [4] = {'S', 'L', 'O', 'G'};
+    static const char recordMagicNumber [4] = {'S', 'R', 'E', 'C'};
+    static const char indexMagicNumber [4] = {'S', 'I', 'D', 'X'};
+    static const char descriptorIndexMagicNumber [4] = {'S', 'D', 'S', 'C'};
+
+    static const int logHeaderSize = 16;
+    static const int indexHeaderSize = 8;
+    static const int descriptorIndexHeaderSize = 8;
+
+    // version 2 added the plug-in code and parameters to the descriptor index entries
+    static const int descriptorIndexVersion = 2;
+    static const int recordHeaderSize = 8;
+    static const int recordTrailerSize = 8;
+
+    static int getPadding (int64 numBytes, int alignment)
+    {
+        return (int) ((alignment - numBytes % alignment) % alignment);
+    }
+
+    static bool writePadding (OutputStream &stream, int numBytes)
+    {
+        static const char zeros [8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+        jassert (numBytes <= (int) sizeof (zeros));
+        return numBytes == 0 || stream.write (zeros, numBytes);
+    }
+
+    //==========================================================================
+    static const uint32 initialChecksum = 1;
+
+    /** Adler-32, which is plenty to spot a record which was only partly written. */
+    static uint32 updateChecksum (uint32 checksum, const void *data, size_t numBytes)
+    {
+        const uint32 modulus = 65521;
+        const uint8 *bytes = static_cast <const uint8*> (data);
+        uint32 a = checksum & 0xffff;
+        uint32 b = checksum >> 16;
+
+        while (numBytes > 0)
+        {
+            // the sums can't overflow before the modulus is taken within this many bytes
+            size_t blockSize = jmin (numBytes, (size_t) 5552);
+
+            for (size_t i = 0; i < blockSize; ++i)
+            {
+                a += bytes [i];
+                b += a;
+            }
+
+            a %= modulus;
+            b %= modulus;
+
+            bytes += blockSize;
+            numBytes -= blockSize;
+        }
+
+        return (b << 16) | a;
+    }
+
+    /** Passes everything written on to another stream, keeping a checksum of it. */
+    class ChecksumOutputStream : public OutputStream
+    {
+    public:
+        ChecksumOutputStream (OutputStream &destinationStream)
+            : destination (destinationStream),
+              checksum (initialChecksum),
+              numBytesWritten (0)
+        {
+        }
+
+        void flush() override                   { destination.flush(); }
+        int64 getPosition() override            { return numBytesWritten; }
+
+        // the checksum only works if everything is written in order
+        bool setPosition (int64) override       { return false; }
+
+        bool write (const void *data, size_t numBytes) override
+        {
+            checksum = updateChecksum (checksum, data, numBytes);
+            numBytesWritten += (int64) numBytes;
+
+            return destination.write (data, numBytes);
+        }
+
+        uint32 getChecksum() const              { return checksum; }
+
+    private:
+        OutputStream &destination;
+        uint32 checksum;
+        int64 numBytesWritten;
+    };
+
+    //==========================================================================
+    static bool writeString (OutputStream &stream, const String &text)
+    {
+        int numBytes = (int) text.getNumBytesAsUTF8();
+
+        return stream.writeInt (numBytes)
+            && stream.write (text.toRawUTF8(), numBytes)
+            && writePadding (stream, getPadding (numBytes, 4));
+    }
+
+    static bool readString (InputStream &stream, String &text)
+    {
+        int numBytes = stream.readInt();
+
+        if (numBytes < 0 || numBytes > stream.getNumBytesRemaining())
+        {
+            return false;
+        }
+
+        HeapBlock <char> data ((size_t) numBytes + 1, true);
+
+        if (stream.read (data, numBytes) != numBytes)
+        {
+            return false;
+        }
+
+        text = String::fromUTF8 (data, numBytes);
+        stream.skipNextBytes (getPadding (numBytes, 4));
+
+        return true;
+    }
+
+    //==========================================================================
+    static double parseXmlValue (String::CharPointerType text)
+    {
+        // these are what SAFEFeatureExtractor::doubleToString() writes for non finite values
+        if (*text == 'N')
+        {
+            return std::numeric_limits <double>::quiet_NaN();
+        }
+        else if (*text == 'I')
+        {
+            return std::numeric_limits <double>::infinity();
+        }
+        else if (*text == '-' && text [1] == 'I')
+        {
+            return -std::numeric_limits <double>::infinity();
+        }
+
+        return CharacterFunctions::getDoubleValue (text);
+    }
+
+    /** Parse a comma separated list of values, skipping any empty ones. */
+    static void parseXmlValues (const String &text, Array <double> &values)
+    {
+        values.clearQuick();
+
+        String::CharPointerType position (text.getCharPointer());
+
+        for (;;)
+        {
+            position = position.findEndOfWhitespace();
+
+            if (position.isEmpty())
+            {
+                break;
+            }
+
+            if (*position != ',')
+            {
+                values.add (parseXmlValue (position));
+            }
+
+            while (! position.isEmpty() && *position != ',')
+            {
+                ++position;
+            }
+
+            if (! position.isEmpty())
+            {
+                ++position;
+            }
+        }
+    }
+
+    //==========================================================================
+    /** Reads the records from an xml data file written by an older version.
+     *
+     *  The file is read one SemanticData element at a time, so only one record
+     *  is ever held in memory. The features are gathered into stores which are
+     *  kept from one record to the next.
+     */
+    class XmlRecordReader
+    {
+    public:
+        XmlRecordReader (InputStream &stream)
+            : reader (stream),
+              failed (false)
+        {
+            // columns added to an allocated store get their memory straight away
+            for (int i = 0; i < numFeatureSources; ++i)
+            {
+                stores [i].allocate();
+            }
+        }
+
+        /** Read the next record.
+         *
+         *  @return false at the end of the file or if the file couldn't be parsed
+         */
+        bool readNextRecord (SemanticDataStore::RecordInfo &info)
+        {
+            if (! findNextRecord())
+            {
+                return false;
+            }
+
+            info = SemanticDataStore::RecordInfo();
+            readDescriptors (info);
+
+            for (int i = 0; i < numFeatureSources; ++i)
+            {
+                stores [i].clear();
+                columnInfos [i].clearQuick();
+            }
+
+            int source = -1;
+            int column = -1;
+            AudioFeatureBinaryFormat::FeatureSetInfo featureSetInfo;
+
+            for (;;)
+            {
+                XmlStreamReader::Event event = reader.readNext();
+
+                if (event != XmlStreamReader::StartOfElement && event != XmlStreamReader::EndOfElement)
+                {
+                    failed = true;
+                    return false;
+                }
+
+                const int depth = reader.getDepth();
+                const String &tagName = reader.getTagName();
+
+                if (event == XmlStreamReader::EndOfElement)
+                {
+                    if (depth == 1)
+                    {
+                        // the end of the SemanticData element
+                        return true;
+                    }
+                    else if (depth == 2)
+                    {
+                        source = -1;
+                    }
+                    else if (depth == 4)
+                    {
+                        column = -1;
+                    }
+                }
+                else if (depth == 3)
+                {
+                    if (tagName == "PlugInConfiguration")
+                    {
+                        info.pluginCode = reader.getStringAttribute ("PluginCode");
+                        info.numInputs = reader.getIntAttribute ("Inputs");
+                        info.numOutputs = reader.getIntAttribute ("Outputs");
+                        info.sampleRate = reader.getDoubleAttribute ("SampleRate");
+                        info.analysisTime = reader.getIntAttribute ("AnalysisTime");
+                    }
+                    else if (tagName == "ParameterSettings")
+                    {
+                        parseXmlValues (reader.getStringAttribute ("Values"), values);
+
+                        for (int i = 0; i < values.size(); ++i)
+                        {
+                            info.parameters.add ((float) values [i]);
+                        }
+                    }
+                    else if (tagName == "MetaData")
+                    {
+                        info.metaData.genre = reader.getStringAttribute ("Genre");
+                        info.metaData.instrument = reader.getStringAttribute ("Instrument");
+                        info.metaData.location = reader.getStringAttribute ("Location");
+                        info.metaData.experience = reader.getStringAttribute ("Experience");
+                        info.metaData.age = reader.getStringAttribute ("Age");
+                        info.metaData.language = reader.getStringAttribute ("Language");
+                    }
+                    else if (tagName == "UnprocessedAudioFeatures")
+                    {
+                        source = unprocessedFeatures;
+                    }
+                    else if (tagName == "ProcessedAudioFeatures")
+                    {
+                        source = processedFeatures;
+                    }
+                }
+                else if (depth == 4 && source >= 0 && tagName == "FeatureSet")
+                {
+                    featureSetInfo.name = reader.getStringAttribute ("FeatureName");
+                    featureSetInfo.frameSize = reader.getIntAttribute ("FrameSize");
+                    featureSetInfo.stepSize = reader.getIntAttribute ("StepSize");
+                }
+                else if (depth == 5 && source >= 0 && tagName == "Channel")
+                {
+                    // vamp features aren't tied to a channel
+                    String channelNumber = reader.getStringAttribute ("Number");
+                    featureSetInfo.channel = channelNumber == "NULL" ? -1 : channelNumber.getIntValue();
+
+                    column = addColumn (source, featureSetInfo);
+                }
+                else if (depth == 6 && column >= 0 && tagName == "Feature")
+                {
+                    parseXmlValues (reader.getStringAttribute ("Values"), values);
+
+                    double *featureValues = stores [source].addFeature (column,
+                                                                        reader.getIntAttribute ("Time"),
+                                                                        reader.getIntAttribute ("Duration"),
+                                                                        values.size());
+
+                    memcpy (featureValues, values.getRawDataPointer(), values.size() * sizeof (double));
+                }
+            }
+        }
+
+        /** Hand the features of the last record read to some writers.
+         *
+         *  The writers must be finished with before the next record is read.
+         */
+        void addFeatures (AudioFeatureBinaryFormat::Writer &unprocessedWriter, AudioFeatureBinaryFormat::Writer &processedWriter) const
+        {
+            AudioFeatureBinaryFormat::Writer *writers [numFeatureSources] = {&unprocessedWriter, &processedWriter};
+
+            // the columns can move while they grow so they are only handed over at the end
+            for (int i = 0; i < numFeatureSources; ++i)
+            {
+                for (int column = 0; column < columnInfos [i].size(); ++column)
+                {
+                    writers [i]->addFeatureSet (columnInfos [i].getReference (column), stores [i].getColumn (column));
+                }
+            }
+        }
+
+        /** Returns true if the file couldn't be parsed. */
+        bool hasFailed() const
+        {
+            return failed;
+        }
+
+    private:
+        enum
+        {
+            unprocessedFeatures = 0,
+            processedFeatures,
+            numFeatureSources
+        };
+
+        XmlStreamReader reader;
+        bool failed;
+
+        AudioFeatureStore stores [numFeatureSources];
+        Array <AudioFeatureBinaryFormat::FeatureSetInfo> columnInfos [numFeatureSources];
+        Array <double> values;
+
+        bool findNextRecord()
+        {
+            // the records are the SemanticData elements under the root
+            for (;;)
+            {
+                XmlStreamReader::Event event = reader.readNext();
+
+                if (event == XmlStreamReader::EndOfDocument)
+                {
+                    return false;
+                }
+                else if (event == XmlStreamReader::ParseError)
+                {
+                    failed = true;
+                    return false;
+                }
+                else if (event == XmlStreamReader::StartOfElement && reader.getDepth() == 2 && reader.getTagName() == "SemanticData")
+                {
+                    return true;
+                }
+            }
+        }
+
+        void readDescriptors (SemanticDataStore::RecordInfo &info)
+        {
+            // local files have Descriptor0, Descriptor1... and uploads have a single Descriptors list
+            for (int i = 0; i < reader.getNumAttributes(); ++i)
+            {
+                const String &attributeName = reader.getAttributeName (i);
+
+                if (attributeName == "Descriptors")
+                {
+                    info.descriptors.addTokens (reader.getAttributeValue (i), " ,;", String::empty);
+                }
+                else if (attributeName.startsWith ("Descriptor"))
+                {
+                    info.descriptors.add (reader.getAttributeValue (i));
+                }
+            }
+
+            info.descriptors.removeEmptyStrings();
+        }
+
+        int addColumn (int source, const AudioFeatureBinaryFormat::FeatureSetInfo &info)
+        {
+            const int column = columnInfos [source].size();
+            columnInfos [source].add (info);
+
+            // the records mostly have the same features so the columns are reused
+            if (column == stores [source].getNumColumns())
+            {
+                stores [source].addColumn (expectedNumFeatures, 1);
+            }
+
+            return column;
+        }
+
+        static const int expectedNumFeatures = 256;
+
+        JUCE_DECLARE_NON_COPYABLE (XmlRecordReader)
+    };
+
+    //==========================================================================
+    // the names migrateXmlFile() gives an xml file, so it is never read twice
+    static const char* const importingSuffix = "Importing";
+    static const char* const importedSuffix = "Imported";
+    static const char* const importFailedSuffix = "ImportFailed";
+
+    static File getMigratedXmlFile (const File &xmlFile, const char *suffix)
+    {
+        return xmlFile.getSiblingFile (xmlFile.getFileNameWithoutExtension() + suffix + ".xml").getNonexistentSibling();
+    }
+
+    static void deleteStoreFiles (const File &logFile)
+    {
+        logFile.deleteFile();
+        SemanticDataStore::getIndexFile (logFile).deleteFile();
+        SemanticDataStore::getDescriptorIndexFile (logFile).deleteFile();
+    }
+}
+
+//==========================================================================
+//      Record Info
+//==========================================================================
+SemanticDataStore::RecordInfo::RecordInfo()
+    : numInputs (0),
+      numOutputs (0),
+      sampleRate (0),
+      analysisTime (0)
+{
+}
+
+//==========================================================================
+//      Parameter Statistics
+//==========================================================================
+SemanticDataStore::ParameterStatistics::ParameterStatistics()
+    : numRecords (0)
+{
+}
+
+int SemanticDataStore::ParameterStatistics::getNumRecords() const
+{
+    return numRecords;
+}
+
+int SemanticDataStore::ParameterStatistics::getNumParameters() const
+{
+    return means.size();
+}
+
+double SemanticDataStore::ParameterStatistics::getMean (int parameter) const
+{
+    return means [parameter];
+}
+
+double SemanticDataStore::ParameterStatistics::getVariance (int parameter) const
+{
+    int count = counts [parameter];
+
+    return count > 1 ? sumsOfSquaredDeviations [parameter] / (count - 1) : 0;
+}
+
+void SemanticDataStore::ParameterStatistics::addParameters (const Array <float> &parameters)
+{
+    ++numRecords;
+
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        // plug-ins can gain parameters between versions
+        if (i >= means.size())
+        {
+            counts.add (0);
+            means.add (0);
+            sumsOfSquaredDeviations.add (0);
+        }
+
+        // Welford's update, which stays accurate without keeping the old values
+        double value = parameters [i];
+        int count = ++counts.getReference (i);
+        double &mean = means.getReference (i);
+
+        double deviation = value - mean;
+        mean += deviation / count;
+        sumsOfSquaredDeviations.getReference (i) += deviation * (value - mean);
+    }
+}
+
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+SemanticDataStore::SemanticDataStore()
+    : opened (false),
+      endOfRecords (0),
+      featureValueType (AudioFeatureBinaryFormat::Float32Values),
+      numRecordsWithDescriptorsIndexed (0),
+      descriptorIndexSize (0)
+{
+}
+
+SemanticDataStore::~SemanticDataStore()
+{
+}
+
+//==========================================================================
+//      Files
+//==========================================================================
+bool SemanticDataStore::open (const File &newLogFile)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    logFile = newLogFile;
+    indexFile = getIndexFile (logFile);
+    descriptorIndexFile = getDescriptorIndexFile (logFile);
+    opened = false;
+    recordOffsets.clear();
+    endOfRecords = 0;
+
+    // the descriptor index is read from the start again, nothing is written until it is open
+    rebuildDescriptorIndex();
+
+    if (logFile.getSize() == 0 && ! createLog())
+    {
+        return false;
+    }
+
+    {
+        FileInputStream stream (logFile);
+
+        char magic [4];
+
+        if (stream.failedToOpen()
+            || stream.read (magic, sizeof (magic)) != sizeof (magic)
+            || memcmp (magic, logMagicNumber, sizeof (magic)) != 0)
+        {
+            return false;
+        }
+
+        int version = stream.readInt();
+
+        if (version < 1 || version > currentVersion)
+        {
+            return false;
+        }
+    }
+
+    opened = true;
+
+    if (! loadIndex())
+    {
+        rebuildIndex();
+    }
+
+    // anything which isn't a whole record now was left by an append which never finished
+    scanForUnindexedRecords (true);
+
+    synchroniseDescriptorIndex();
+
+    return true;
+}
+
+bool SemanticDataStore::isOpen() const
+{
+    return opened;
+}
+
+bool SemanticDataStore::synchronise()
+{
+    using namespace SemanticDataStoreHelpers;
+
+    if (! opened)
+    {
+        return false;
+    }
+
+    // the index only changes size if another store has appended to it
+    int64 expectedIndexSize = indexHeaderSize + recordOffsets.size() * (int64) sizeof (int64);
+
+    if (indexFile.getSize() != expectedIndexSize && ! loadIndex())
+    {
+        rebuildIndex();
+    }
+
+    scanForUnindexedRecords (false);
+
+    synchroniseDescriptorIndex();
+
+    return true;
+}
+
+File SemanticDataStore::getIndexFile (const File &logFile)
+{
+    return logFile.withFileExtension ("index");
+}
+
+File SemanticDataStore::getDescriptorIndexFile (const File &logFile)
+{
+    return logFile.withFileExtension ("descriptors");
+}
+
+void SemanticDataStore::setFeatureValueType (AudioFeatureBinaryFormat::ValueType newValueType)
+{
+    featureValueType = newValueType;
+}
+
+//==========================================================================
+//      Records
+//==========================================================================
+int SemanticDataStore::getNumRecords() const
+{
+    return recordOffsets.size();
+}
+
+bool SemanticDataStore::appendRecord (const RecordInfo &info,
+                                      const AudioFeatureBinaryFormat::Writer &unprocessedFeatures,
+                                      const AudioFeatureBinaryFormat::Writer &processedFeatures)
+{
+    if (! synchronise())
+    {
+        return false;
+    }
+
+    FileOutputStream stream (logFile);
+
+    if (stream.failedToOpen() || ! stream.setPosition (endOfRecords))
+    {
+        return false;
+    }
+
+    int64 recordSize = writeRecord (stream, info, unprocessedFeatures, processedFeatures, featureValueType);
+
+    if (recordSize < 0)
+    {
+        return false;
+    }
+
+    Array <int64> newOffsets;
+    newOffsets.add (endOfRecords);
+
+    return finishAppending (stream, newOffsets, endOfRecords + recordSize);
+}
+
+bool SemanticDataStore::readRecordInfo (int index, RecordInfo &info) const
+{
+    using namespace SemanticDataStoreHelpers;
+
+    if (! isPositiveAndBelow (index, recordOffsets.size()))
+    {
+        return false;
+    }
+
+    FileInputStream fileStream (logFile);
+
+    if (fileStream.failedToOpen())
+    {
+        return false;
+    }
+
+    BufferedInputStream stream (fileStream, 4096);
+    char magic [4];
+
+    if (! stream.setPosition (recordOffsets [index])
+        || stream.read (magic, sizeof (magic)) != sizeof (magic)
+        || memcmp (magic, recordMagicNumber, sizeof (magic)) != 0)
+    {
+        return false;
+    }
+
+    stream.readInt();
+
+    return readInfo (stream, info);
+}
+
+bool SemanticDataStore::readRecordFeatures (int index,
+                                            AudioFeatureBinaryFormat::Reader &unprocessedFeatures,
+                                            AudioFeatureBinaryFormat::Reader &processedFeatures) const
+{
+    using namespace SemanticDataStoreHelpers;
+
+    if (! isPositiveAndBelow (index, recordOffsets.size()))
+    {
+        return false;
+    }
+
+    FileInputStream fileStream (logFile);
+
+    if (fileStream.failedToOpen())
+    {
+        return false;
+    }
+
+    BufferedInputStream stream (fileStream, 4096);
+    char magic [4];
+    RecordInfo info;
+
+    if (! stream.setPosition (recordOffsets [index])
+        || stream.read (magic, sizeof (magic)) != sizeof (magic)
+        || memcmp (magic, recordMagicNumber, sizeof (magic)) != 0)
+    {
+        return false;
+    }
+
+    stream.readInt();
+
+    // the features come after the rest of the record
+    if (! readInfo (stream, info))
+    {
+        return false;
+    }
+
+    int unprocessedSize = stream.readInt();
+    stream.readInt();
+
+    int64 processedStart = stream.getPosition() + unprocessedSize + getPadding (unprocessedSize, 8);
+
+    return unprocessedFeatures.read (stream)
+        && stream.setPosition (processedStart)
+        && processedFeatures.read (stream);
+}
+
+//==========================================================================
+//      Descriptors
+//==========================================================================
+const StringArray& SemanticDataStore::getDescriptors() const
+{
+    return descriptors;
+}
+
+const Array <int>& SemanticDataStore::getRecordsWithDescriptor (const String &descriptor) const
+{
+    static const Array <int> noRecords;
+
+    if (! descriptorSlots.contains (descriptor))
+    {
+        return noRecords;
+    }
+
+    return *descriptorRecords [descriptorSlots [descriptor]];
+}
+
+const SemanticDataStore::ParameterStatistics* SemanticDataStore::getParameterStatistics (const String &pluginCode, const String &descriptor) const
+{
+    String statisticsKey = getParameterStatisticsKey (pluginCode, descriptor);
+
+    if (! statisticsSlots.contains (statisticsKey))
+    {
+        return nullptr;
+    }
+
+    return parameterStatistics [statisticsSlots [statisticsKey]];
+}
+
+//==========================================================================
+//      Importing
+//==========================================================================
+int SemanticDataStore::importXmlFile (const File &xmlFile, ThreadPoolJob *job)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    if (! synchronise())
+    {
+        return -1;
+    }
+
+    FileInputStream xmlStream (xmlFile);
+
+    if (xmlStream.failedToOpen())
+    {
+        return -1;
+    }
+
+    FileOutputStream stream (logFile);
+
+    if (stream.failedToOpen() || ! stream.setPosition (endOfRecords))
+    {
+        return -1;
+    }
+
+    // everything is synced to disk in one go at the end
+    XmlRecordReader reader (xmlStream);
+    RecordInfo info;
+    Array <int64> newOffsets;
+    int64 newEndOfRecords = endOfRecords;
+    bool ok = true;
+
+    while (ok && reader.readNextRecord (info))
+    {
+        if (job != nullptr && job->shouldExit())
+        {
+            ok = false;
+            break;
+        }
+
+        AudioFeatureBinaryFormat::Writer unprocessedFeatures, processedFeatures;
+        reader.addFeatures (unprocessedFeatures, processedFeatures);
+
+        int64 recordSize = writeRecord (stream, info, unprocessedFeatures, processedFeatures, featureValueType);
+        ok = recordSize >= 0;
+
+        newOffsets.add (newEndOfRecords);
+        newEndOfRecords += recordSize;
+    }
+
+    if (! ok || reader.hasFailed())
+    {
+        // take the records written so far back off so a failed import leaves nothing behind
+        stream.setPosition (endOfRecords);
+        stream.truncate();
+        return -1;
+    }
+
+    if (! finishAppending (stream, newOffsets, newEndOfRecords))
+    {
+        return -1;
+    }
+
+    return newOffsets.size();
+}
+
+int SemanticDataStore::migrateXmlFile (const File &xmlFile, CriticalSection &logLock, ThreadPoolJob *job)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    // claim the file first, if it has already gone another store is importing it
+    const File importingFile = getMigratedXmlFile (xmlFile, importingSuffix);
+
+    if (! xmlFile.moveFileTo (importingFile))
+    {
+        return -1;
+    }
+
+    // parse into a store of its own so the log isn't locked for the whole import
+    const File stagingFile = importingFile.withFileExtension ("records");
+    deleteStoreFiles (stagingFile);
+
+    int numRecords = -1;
+    bool parsed = false;
+
+    {
+        SemanticDataStore stagingStore;
+        stagingStore.setFeatureValueType (featureValueType);
+
+        if (stagingStore.open (stagingFile))
+        {
+            numRecords = stagingStore.importXmlFile (importingFile, job);
+            parsed = numRecords >= 0;
+        }
+
+        if (parsed)
+        {
+            const ScopedLock lock (logLock);
+
+            if (! appendRecordsFrom (stagingStore))
+            {
+                numRecords = -1;
+            }
+        }
+    }
+
+    deleteStoreFiles (stagingFile);
+
+    if (numRecords >= 0)
+    {
+        importingFile.moveFileTo (getMigratedXmlFile (xmlFile, importedSuffix));
+    }
+    else if (parsed || (job != nullptr && job->shouldExit()))
+    {
+        // nothing is wrong with the file, so put it back to try again next time
+        importingFile.moveFileTo (xmlFile);
+    }
+    else
+    {
+        importingFile.moveFileTo (getMigratedXmlFile (xmlFile, importFailedSuffix));
+    }
+
+    return numRecords;
+}
+
+bool SemanticDataStore::isMigratedXmlFile (const File &xmlFile)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    // getNonexistentSibling() can add a number after the suffix
+    const String name = xmlFile.getFileNameWithoutExtension().trimCharactersAtEnd (" ()0123456789");
+
+    return name.endsWith (importingSuffix) || name.endsWith (importedSuffix) || name.endsWith (importFailedSuffix);
+}
+
+//==========================================================================
+//      Private Methods
+//==========================================================================
+bool SemanticDataStore::createLog()
+{
+    using namespace SemanticDataStoreHelpers;
+
+    logFile.deleteFile();
+    indexFile.deleteFile();
+    descriptorIndexFile.deleteFile();
+
+    FileOutputStream stream (logFile);
+
+    bool ok = ! stream.failedToOpen()
+           && stream.write (logMagicNumber, sizeof (logMagicNumber))
+           && stream.writeInt (currentVersion)
+           && writePadding (stream, logHeaderSize - 8);
+
+    stream.flush();
+
+    return ok && stream.getStatus().wasOk();
+}
+
+bool SemanticDataStore::loadIndex()
+{
+    using namespace SemanticDataStoreHelpers;
+
+    recordOffsets.clearQuick();
+    endOfRecords = logHeaderSize;
+
+    FileInputStream fileStream (indexFile);
+
+    if (fileStream.failedToOpen())
+    {
+        return false;
+    }
+
+    BufferedInputStream stream (fileStream, 4096);
+    int64 indexSize = stream.getTotalLength();
+
+    if (indexSize < indexHeaderSize || (indexSize - indexHeaderSize) % sizeof (int64) != 0)
+    {
+        return false;
+    }
+
+    char magic [4];
+
+    if (stream.read (magic, sizeof (magic)) != sizeof (magic)
+        || memcmp (magic, indexMagicNumber, sizeof (magic)) != 0
+        || stream.readInt() != currentVersion)
+    {
+        return false;
+    }
+
+    int numRecords = (int) ((indexSize - indexHeaderSize) / sizeof (int64));
+    int64 logSize = logFile.getSize();
+    int64 previousOffset = 0;
+
+    recordOffsets.ensureStorageAllocated (numRecords);
+
+    for (int i = 0; i < numRecords; ++i)
+    {
+        int64 offset = stream.readInt64();
+
+        if (offset < logHeaderSize || offset <= previousOffset || offset >= logSize)
+        {
+            recordOffsets.clearQuick();
+            return false;
+        }
+
+        recordOffsets.add (offset);
+        previousOffset = offset;
+    }
+
+    // checking the last record makes sure the index belongs with this log
+    if (numRecords > 0)
+    {
+        FileInputStream logStream (logFile);
+        int64 lastRecordSize = checkRecord (logStream, previousOffset, logSize);
+
+        if (lastRecordSize < 0)
+        {
+            recordOffsets.clearQuick();
+            return false;
+        }
+
+        endOfRecords = previousOffset + lastRecordSize;
+    }
+
+    return true;
+}
+
+bool SemanticDataStore::rebuildIndex()
+{
+    using namespace SemanticDataStoreHelpers;
+
+    recordOffsets.clearQuick();
+    endOfRecords = logHeaderSize;
+
+    indexFile.deleteFile();
+
+    {
+        FileOutputStream stream (indexFile);
+
+        if (stream.failedToOpen()
+            || ! stream.write (indexMagicNumber, sizeof (indexMagicNumber))
+            || ! stream.writeInt (currentVersion))
+        {
+            return false;
+        }
+    }
+
+    // the records are all found again by scanning the log
+    scanForUnindexedRecords (false);
+
+    return true;
+}
+
+bool SemanticDataStore::addToIndex (int firstRecord)
+{
+    if (firstRecord >= recordOffsets.size())
+    {
+        return true;
+    }
+
+    FileOutputStream stream (indexFile);
+
+    if (stream.failedToOpen())
+    {
+        return false;
+    }
+
+    for (int i = firstRecord; i < recordOffsets.size(); ++i)
+    {
+        if (! stream.writeInt64 (recordOffsets [i]))
+        {
+            return false;
+        }
+    }
+
+    stream.flush();
+
+    return stream.getStatus().wasOk();
+}
+
+void SemanticDataStore::scanForUnindexedRecords (bool removeIncompleteRecords)
+{
+    int64 logSize = logFile.getSize();
+
+    if (logSize <= endOfRecords)
+    {
+        return;
+    }
+
+    int firstNewRecord = recordOffsets.size();
+
+    {
+        FileInputStream stream (logFile);
+
+        if (stream.failedToOpen())
+        {
+            return;
+        }
+
+        for (;;)
+        {
+            int64 recordSize = checkRecord (stream, endOfRecords, logSize);
+
+            if (recordSize < 0)
+            {
+                break;
+            }
+
+            recordOffsets.add (endOfRecords);
+            endOfRecords += recordSize;
+        }
+    }
+
+    addToIndex (firstNewRecord);
+
+    if (removeIncompleteRecords && endOfRecords < logSize)
+    {
+        FileOutputStream stream (logFile);
+
+        if (! stream.failedToOpen() && stream.setPosition (endOfRecords))
+        {
+            stream.truncate();
+        }
+    }
+}
+
+bool SemanticDataStore::finishAppending (FileOutputStream &stream, const Array <int64> &newOffsets, int64 newEndOfRecords)
+{
+    // anything left after the new records is from an append which never finished
+    bool ok = stream.truncate().wasOk();
+
+    // the records have to be on disk before they go in the index
+    stream.flush();
+
+    if (! ok || ! stream.getStatus().wasOk())
+    {
+        return false;
+    }
+
+    int firstNewRecord = recordOffsets.size();
+
+    recordOffsets.addArray (newOffsets);
+    endOfRecords = newEndOfRecords;
+
+    // if this fails the records will be picked up from the log next time
+    addToIndex (firstNewRecord);
+    addToDescriptorIndex();
+
+    return true;
+}
+
+bool SemanticDataStore::appendRecordsFrom (const SemanticDataStore &otherStore)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    if (! synchronise())
+    {
+        return false;
+    }
+
+    const int64 numBytes = otherStore.endOfRecords - logHeaderSize;
+
+    if (otherStore.recordOffsets.size() == 0 || numBytes <= 0)
+    {
+        return true;
+    }
+
+    FileInputStream otherStream (otherStore.logFile);
+    FileOutputStream stream (logFile);
+
+    if (otherStream.failedToOpen() || stream.failedToOpen()
+        || ! otherStream.setPosition (logHeaderSize) || ! stream.setPosition (endOfRecords))
+    {
+        return false;
+    }
+
+    // the records are copied as they are, both logs keep them at the same alignment
+    if (stream.writeFromInputStream (otherStream, numBytes) != numBytes)
+    {
+        stream.setPosition (endOfRecords);
+        stream.truncate();
+        return false;
+    }
+
+    Array <int64> newOffsets;
+    newOffsets.ensureStorageAllocated (otherStore.recordOffsets.size());
+
+    for (int i = 0; i < otherStore.recordOffsets.size(); ++i)
+    {
+        newOffsets.add (otherStore.recordOffsets [i] - logHeaderSize + endOfRecords);
+    }
+
+    return finishAppending (stream, newOffsets, endOfRecords + numBytes);
+}
+
+void SemanticDataStore::synchroniseDescriptorIndex()
+{
+    // the file only changes size if another store has added to it
+    if (descriptorIndexFile.getSize() != descriptorIndexSize && ! readDescriptorIndex())
+    {
+        rebuildDescriptorIndex();
+    }
+
+    // start again without a usable file, or if the index has records which are no longer in the log
+    if (descriptorIndexSize == 0 || numRecordsWithDescriptorsIndexed > recordOffsets.size())
+    {
+        rebuildDescriptorIndex();
+    }
+
+    addToDescriptorIndex();
+}
+
+bool SemanticDataStore::readDescriptorIndex()
+{
+    using namespace SemanticDataStoreHelpers;
+
+    FileInputStream fileStream (descriptorIndexFile);
+
+    if (fileStream.failedToOpen())
+    {
+        return false;
+    }
+
+    BufferedInputStream stream (fileStream, 4096);
+    int64 fileSize = stream.getTotalLength();
+
+    if (fileSize < descriptorIndexSize)
+    {
+        return false;
+    }
+
+    if (descriptorIndexSize == 0)
+    {
+        char magic [4];
+
+        if (stream.read (magic, sizeof (magic)) != sizeof (magic)
+            || memcmp (magic, descriptorIndexMagicNumber, sizeof (magic)) != 0
+            || stream.readInt() != descriptorIndexVersion)
+        {
+            return false;
+        }
+
+        descriptorIndexSize = descriptorIndexHeaderSize;
+    }
+
+    // only the entries added since it was last read are needed
+    stream.setPosition (descriptorIndexSize);
+
+    RecordInfo info;
+
+    while (stream.getPosition() < fileSize)
+    {
+        int record = stream.readInt();
+
+        if (record != numRecordsWithDescriptorsIndexed || ! readDescriptorIndexEntry (stream, info))
+        {
+            break;
+        }
+
+        addRecordToDescriptorIndex (record, info);
+        descriptorIndexSize = stream.getPosition();
+    }
+
+    if (descriptorIndexSize < fileSize)
+    {
+        // a partly written entry is cut off so the next one can go after the last whole one
+        FileOutputStream outputStream (descriptorIndexFile);
+
+        if (outputStream.failedToOpen()
+            || ! outputStream.setPosition (descriptorIndexSize)
+            || outputStream.truncate().failed())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SemanticDataStore::rebuildDescriptorIndex()
+{
+    using namespace SemanticDataStoreHelpers;
+
+    descriptorSlots.clear();
+    descriptors.clearQuick();
+    descriptorRecords.clear();
+    statisticsSlots.clear();
+    parameterStatistics.clear();
+    numRecordsWithDescriptorsIndexed = 0;
+    descriptorIndexSize = 0;
+
+    if (! opened)
+    {
+        return;
+    }
+
+    descriptorIndexFile.deleteFile();
+
+    FileOutputStream stream (descriptorIndexFile);
+
+    if (! stream.failedToOpen()
+        && stream.write (descriptorIndexMagicNumber, sizeof (descriptorIndexMagicNumber))
+        && stream.writeInt (descriptorIndexVersion))
+    {
+        descriptorIndexSize = descriptorIndexHeaderSize;
+    }
+}
+
+void SemanticDataStore::addToDescriptorIndex()
+{
+    using namespace SemanticDataStoreHelpers;
+
+    if (numRecordsWithDescriptorsIndexed >= recordOffsets.size())
+    {
+        return;
+    }
+
+    FileOutputStream stream (descriptorIndexFile);
+
+    // if the file can't be written to the descriptors are still kept in memory
+    bool writeToFile = ! stream.failedToOpen() && stream.getPosition() == descriptorIndexSize;
+
+    for (int record = numRecordsWithDescriptorsIndexed; record < recordOffsets.size(); ++record)
+    {
+        RecordInfo info;
+
+        // a record which can't be read still gets an empty entry to keep them in order
+        readRecordInfo (record, info);
+
+        addRecordToDescriptorIndex (record, info);
+
+        writeToFile = writeToFile
+                   && stream.writeInt (record)
+                   && writeDescriptorIndexEntry (stream, info);
+    }
+
+    stream.flush();
+
+    if (writeToFile && stream.getStatus().wasOk())
+    {
+        descriptorIndexSize = stream.getPosition();
+    }
+}
+
+void SemanticDataStore::addRecordToDescriptorIndex (int record, const RecordInfo &info)
+{
+    for (int i = 0; i < info.descriptors.size(); ++i)
+    {
+        const String &descriptor = info.descriptors [i];
+
+        if (! descriptorSlots.contains (descriptor))
+        {
+            descriptorSlots.set (descriptor, descriptors.size());
+            descriptors.add (descriptor);
+            descriptorRecords.add (new Array <int>());
+        }
+
+        Array <int> &records = *descriptorRecords [descriptorSlots [descriptor]];
+
+        // a record might have the same descriptor more than once
+        if (records.size() > 0 && records.getLast() == record)
+        {
+            continue;
+        }
+
+        records.add (record);
+
+        // the running statistics are kept for each plug-in code separately
+        String statisticsKey = getParameterStatisticsKey (info.pluginCode, descriptor);
+
+        if (! statisticsSlots.contains (statisticsKey))
+        {
+            statisticsSlots.set (statisticsKey, parameterStatistics.size());
+            parameterStatistics.add (new ParameterStatistics());
+        }
+
+        parameterStatistics [statisticsSlots [statisticsKey]]->addParameters (info.parameters);
+    }
+
+    numRecordsWithDescriptorsIndexed = record + 1;
+}
+
+String SemanticDataStore::getParameterStatisticsKey (const String &pluginCode, const String &descriptor)
+{
+    return pluginCode + "\n" + descriptor;
+}
+
+bool SemanticDataStore::writeDescriptorIndexEntry (OutputStream &stream, const RecordInfo &info)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    bool ok = writeString (stream, info.pluginCode)
+           && stream.writeInt (info.parameters.size());
+
+    for (int i = 0; ok && i < info.parameters.size(); ++i)
+    {
+        ok = stream.writeFloat (info.parameters [i]);
+    }
+
+    ok = ok && stream.writeInt (info.descriptors.size());
+
+    for (int i = 0; ok && i < info.descriptors.size(); ++i)
+    {
+        ok = writeString (stream, info.descriptors [i]);
+    }
+
+    return ok;
+}
+
+bool SemanticDataStore::readDescriptorIndexEntry (InputStream &stream, RecordInfo &info)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    info.parameters.clearQuick();
+    info.descriptors.clearQuick();
+
+    if (! readString (stream, info.pluginCode))
+    {
+        return false;
+    }
+
+    int numParameters = stream.readInt();
+
+    if (numParameters < 0 || numParameters * (int64) sizeof (float) > stream.getNumBytesRemaining())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numParameters; ++i)
+    {
+        info.parameters.add (stream.readFloat());
+    }
+
+    int numDescriptors = stream.readInt();
+
+    if (numDescriptors < 0 || numDescriptors > stream.getNumBytesRemaining())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numDescriptors; ++i)
+    {
+        String descriptor;
+
+        if (! readString (stream, descriptor))
+        {
+            return false;
+        }
+
+        info.descriptors.add (descriptor);
+    }
+
+    return true;
+}
+
+int64 SemanticDataStore::writeRecord (OutputStream &stream, const RecordInfo &info,
+                                      const AudioFeatureBinaryFormat::Writer &unprocessedFeatures,
+                                      const AudioFeatureBinaryFormat::Writer &processedFeatures,
+                                      AudioFeatureBinaryFormat::ValueType valueType)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    // everything but the features is small enough to gather up first to find the record size
+    MemoryOutputStream infoStream;
+
+    infoStream.writeInt (info.descriptors.size());
+
+    for (int i = 0; i < info.descriptors.size(); ++i)
+    {
+        writeString (infoStream, info.descriptors [i]);
+    }
+
+    writeString (infoStream, info.pluginCode);
+    infoStream.writeInt (info.numInputs);
+    infoStream.writeInt (info.numOutputs);
+    infoStream.writeInt (info.analysisTime);
+
+    infoStream.writeInt (info.parameters.size());
+
+    for (int i = 0; i < info.parameters.size(); ++i)
+    {
+        infoStream.writeFloat (info.parameters [i]);
+    }
+
+    writeString (infoStream, info.metaData.genre);
+    writeString (infoStream, info.metaData.instrument);
+    writeString (infoStream, info.metaData.location);
+    writeString (infoStream, info.metaData.experience);
+    writeString (infoStream, info.metaData.age);
+    writeString (infoStream, info.metaData.language);
+
+    int64 unprocessedSize = unprocessedFeatures.getNumBytes (valueType);
+    int64 processedSize = processedFeatures.getNumBytes (valueType);
+
+    writePadding (infoStream, getPadding ((int64) infoStream.getDataSize(), 8));
+    infoStream.writeDouble (info.sampleRate);
+    infoStream.writeInt ((int) unprocessedSize);
+    infoStream.writeInt ((int) processedSize);
+
+    int64 payloadSize = (int64) infoStream.getDataSize()
+                      + unprocessedSize + getPadding (unprocessedSize, 8)
+                      + processedSize + getPadding (processedSize, 8);
+
+    if (payloadSize > std::numeric_limits <int>::max())
+    {
+        return -1;
+    }
+
+    // the payload is checksummed as it goes so the features are never held in memory
+    ChecksumOutputStream payloadStream (stream);
+
+    bool ok = stream.write (recordMagicNumber, sizeof (recordMagicNumber))
+           && stream.writeInt ((int) payloadSize)
+           && payloadStream.write (infoStream.getData(), infoStream.getDataSize())
+           && unprocessedFeatures.write (payloadStream, valueType)
+           && writePadding (payloadStream, getPadding (unprocessedSize, 8))
+           && processedFeatures.write (payloadStream, valueType)
+           && writePadding (payloadStream, getPadding (processedSize, 8))
+           && payloadStream.getPosition() == payloadSize
+           && stream.writeInt ((int) payloadStream.getChecksum())
+           && stream.writeInt ((int) payloadSize);
+
+    return ok ? recordHeaderSize + payloadSize + recordTrailerSize : -1;
+}
+
+int64 SemanticDataStore::checkRecord (InputStream &stream, int64 offset, int64 logSize)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    char magic [4];
+
+    if (offset + recordHeaderSize + recordTrailerSize > logSize
+        || ! stream.setPosition (offset)
+        || stream.read (magic, sizeof (magic)) != sizeof (magic)
+        || memcmp (magic, recordMagicNumber, sizeof (magic)) != 0)
+    {
+        return -1;
+    }
+
+    int payloadSize = stream.readInt();
+
+    if (payloadSize < 0 || payloadSize % 8 != 0 || offset + recordHeaderSize + payloadSize + recordTrailerSize > logSize)
+    {
+        return -1;
+    }
+
+    uint32 checksum = initialChecksum;
+    char buffer [4096];
+
+    for (int remaining = payloadSize; remaining > 0;)
+    {
+        int numToRead = jmin (remaining, (int) sizeof (buffer));
+
+        if (stream.read (buffer, numToRead) != numToRead)
+        {
+            return -1;
+        }
+
+        checksum = updateChecksum (checksum, buffer, (size_t) numToRead);
+        remaining -= numToRead;
+    }
+
+    uint32 storedChecksum = (uint32) stream.readInt();
+    int storedPayloadSize = stream.readInt();
+
+    if (storedChecksum != checksum || storedPayloadSize != payloadSize)
+    {
+        return -1;
+    }
+
+    return recordHeaderSize + payloadSize + recordTrailerSize;
+}
+
+bool SemanticDataStore::readInfo (InputStream &stream, RecordInfo &info)
+{
+    using namespace SemanticDataStoreHelpers;
+
+    info.descriptors.clearQuick();
+    info.parameters.clearQuick();
+
+    int numDescriptors = stream.readInt();
+
+    if (numDescriptors < 0 || numDescriptors > stream.getNumBytesRemaining())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numDescriptors; ++i)
+    {
+        String descriptor;
+
+        if (! readString (stream, descriptor))
+        {
+            return false;
+        }
+
+        info.descriptors.add (descriptor);
+    }
+
+    if (! readString (stream, info.pluginCode))
+    {
+        return false;
+    }
+
+    info.numInputs = stream.readInt();
+    info.numOutputs = stream.readInt();
+    info.analysisTime = stream.readInt();
+
+    int numParameters = stream.readInt();
+
+    if (numParameters < 0 || numParameters > stream.getNumBytesRemaining())
+    {
+        return false;
+    }
+
+    info.parameters.ensureStorageAllocated (numParameters);
+
+    for (int i = 0; i < numParameters; ++i)
+    {
+        info.parameters.add (stream.readFloat());
+    }
+
+    bool ok = readString (stream, info.metaData.genre)
+           && readString (stream, info.metaData.instrument)
+           && readString (stream, info.metaData.location)
+           && readString (stream, info.metaData.experience)
+           && readString (stream, info.metaData.age)
+           && readString (stream, info.metaData.language);
+
+    if (! ok)
+    {
+        return false;
+    }
+
+    // the sample rate is after the padding
+    stream.skipNextBytes (getPadding (stream.getPosition(), 8));
+    info.sampleRate = stream.readDouble();
+
+    return ! stream.isExhausted();
+}
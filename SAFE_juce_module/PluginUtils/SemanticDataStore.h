@@ -0,0 +1,296 @@
+#ifndef __SEMANTICDATASTORE__
+#define __SEMANTICDATASTORE__
+
+/**
+ *  An append only store for semantic data records.
+ *
+ *  Records are appended to a log file and never rewritten, so saving a record
+ *  costs the same however many records have been saved before it. A small
+ *  index file next to the log holds the offset of each record so any record
+ *  can be found without reading the ones before it.
+ *
+ *  Log file:
+ *      4 bytes     magic number "SLOG"
+ *      int32       format version
+ *      8 bytes     reserved
+ *      records, each starting on an 8 byte boundary
+ *
+ *  Record:
+ *      4 bytes     magic number "SREC"
+ *      int32       payload size in bytes, a multiple of 8
+ *      payload
+ *      uint32      Adler-32 checksum of the payload
+ *      int32       payload size again
+ *
+ *  Payload:
+ *      int32       number of descriptors, followed by the descriptors
+ *      string      plug-in code
+ *      int32       number of inputs
+ *      int32       number of outputs
+ *      int32       analysis time in milliseconds
+ *      int32       number of parameters, followed by the parameters as float32
+ *      string      genre, instrument, location, experience, age and language
+ *      padding up to an 8 byte boundary
+ *      float64     sample rate
+ *      int32       size of the unprocessed features in bytes
+ *      int32       size of the processed features in bytes
+ *      the unprocessed features in the AudioFeatureBinaryFormat, padded to 8 bytes
+ *      the processed features in the AudioFeatureBinaryFormat, padded to 8 bytes
+ *
+ *  Strings are an int32 length followed by UTF-8, padded to a 4 byte boundary.
+ *
+ *  Index file:
+ *      4 bytes     magic number "SIDX"
+ *      int32       format version
+ *      int64       offset of each record in the log
+ *
+ *  Descriptor index file:
+ *      4 bytes     magic number "SDSC"
+ *      int32       format version
+ *      an entry for each record, in order:
+ *      int32       record index
+ *      string      plug-in code
+ *      int32       number of parameters, followed by the parameters as float32
+ *      int32       number of descriptors, followed by the descriptors
+ *
+ *  Everything is little endian.
+ *
+ *  A record only counts once its trailer has been written and its checksum
+ *  matches, so an append which is cut short leaves the store as it was. The
+ *  index is only a cache of the record offsets; records missing from it are
+ *  picked up from the log and it is rebuilt if it doesn't match the log. The
+ *  descriptor index is kept in memory as a hash table from each descriptor to
+ *  the records saved with it, along with running statistics of the parameters
+ *  saved with each descriptor, and is looked after in the same way.
+ *
+ *  A store isn't thread safe. Anything sharing the files should hold the
+ *  AnalysisScheduler's lock for the log file while using the store.
+ */
+class SemanticDataStore
+{
+public:
+    /** The parts of a record which aren't audio features. */
+    struct RecordInfo
+    {
+        RecordInfo();
+
+        StringArray descriptors;
+        String pluginCode;
+        int numInputs, numOutputs;
+        double sampleRate;
+        int analysisTime;
+        Array <float> parameters;
+        SAFEMetaData metaData;
+    };
+
+    /** Running statistics of the parameters saved with a descriptor.
+     *
+     *  These are updated as each record is added, so averaged settings are
+     *  available without going back over the records.
+     */
+    class ParameterStatistics
+    {
+    public:
+        /** Create some statistics with no records. */
+        ParameterStatistics();
+
+        /** Returns the number of records the statistics are taken from. */
+        int getNumRecords() const;
+
+        /** Returns the number of parameters there are statistics for. */
+        int getNumParameters() const;
+
+        /** Returns the mean value of a parameter. */
+        double getMean (int parameter) const;
+
+        /** Returns the sample variance of a parameter. */
+        double getVariance (int parameter) const;
+
+        /** Add the parameters from a record. */
+        void addParameters (const Array <float> &parameters);
+
+    private:
+        int numRecords;
+        Array <int> counts;
+        Array <double> means, sumsOfSquaredDeviations;
+    };
+
+    /** The version of the log and index formats written. */
+    static const int currentVersion = 1;
+
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a store with no files. */
+    SemanticDataStore();
+
+    /** Destructor */
+    ~SemanticDataStore();
+
+    //==========================================================================
+    //      Files
+    //==========================================================================
+    /** Open a log file, creating it if it doesn't exist.
+     *
+     *  Any records missing from the index are added to it and anything left
+     *  at the end of the log by an unfinished append is removed.
+     *
+     *  @return false if the file exists but isn't a log or can't be written to
+     */
+    bool open (const File &logFile);
+
+    /** Returns true if a log file is open. */
+    bool isOpen() const;
+
+    /** Catch up with any records appended to the files by other stores. */
+    bool synchronise();
+
+    /** Returns the index file which goes with a log file. */
+    static File getIndexFile (const File &logFile);
+
+    /** Returns the descriptor index file which goes with a log file. */
+    static File getDescriptorIndexFile (const File &logFile);
+
+    /** Set the type the features of new records are stored as.
+     *
+     *  This is float32 by default. With CompressedValues each feature set is
+     *  kept to the precision given in its FeatureSetInfo.
+     */
+    void setFeatureValueType (AudioFeatureBinaryFormat::ValueType newValueType);
+
+    //==========================================================================
+    //      Records
+    //==========================================================================
+    /** Returns the number of records in the store. */
+    int getNumRecords() const;
+
+    /** Append a record to the store.
+     *
+     *  The record is on disk by the time this returns true.
+     *
+     *  @param info                 the parts of the record which aren't features
+     *  @param unprocessedFeatures  the features of the unprocessed audio
+     *  @param processedFeatures    the features of the processed audio
+     */
+    bool appendRecord (const RecordInfo &info,
+                       const AudioFeatureBinaryFormat::Writer &unprocessedFeatures,
+                       const AudioFeatureBinaryFormat::Writer &processedFeatures);
+
+    /** Read the parts of a record which aren't features.
+     *
+     *  @return false if the record couldn't be read
+     */
+    bool readRecordInfo (int index, RecordInfo &info) const;
+
+    /** Read the features of a record.
+     *
+     *  @return false if the record couldn't be read
+     */
+    bool readRecordFeatures (int index,
+                             AudioFeatureBinaryFormat::Reader &unprocessedFeatures,
+                             AudioFeatureBinaryFormat::Reader &processedFeatures) const;
+
+    //==========================================================================
+    //      Descriptors
+    //==========================================================================
+    /** Returns every descriptor in the store, in the order they were first saved. */
+    const StringArray& getDescriptors() const;
+
+    /** Returns the indices of the records saved with a descriptor, oldest first.
+     *
+     *  The array is empty if no records have the descriptor.
+     */
+    const Array <int>& getRecordsWithDescriptor (const String &descriptor) const;
+
+    /** Returns the statistics of the parameters saved with a descriptor.
+     *
+     *  @param pluginCode  the code of the plug-in the parameters belong to
+     *  @param descriptor  the descriptor
+     *
+     *  @return the statistics, or nullptr if the plug-in has no records with the descriptor
+     */
+    const ParameterStatistics* getParameterStatistics (const String &pluginCode, const String &descriptor) const;
+
+    //==========================================================================
+    //      Importing
+    //==========================================================================
+    /** Import all the records in an xml data file written by an older version.
+     *
+     *  The file is streamed in a record at a time, so the memory used doesn't
+     *  depend on the size of the file. The records are all written before
+     *  anything is synced to disk, so this is much quicker than appending them
+     *  one at a time. If anything goes wrong none of the records are imported.
+     *
+     *  @param xmlFile  the file to import
+     *  @param job      if given, the import stops and fails when the job is asked to exit
+     *
+     *  @return the number of records imported, or -1 if the file couldn't be parsed
+     */
+    int importXmlFile (const File &xmlFile, ThreadPoolJob *job = nullptr);
+
+    /** Move the records in an xml data file into the store and rename the file.
+     *
+     *  The xml is parsed into a store of its own next to it, so other stores
+     *  using the log are only held up by logLock while the finished records are
+     *  copied across. The file is renamed to <name>Imported.xml when its records
+     *  are in the store, or to <name>ImportFailed.xml if it can't be parsed, so
+     *  it is only ever read once. If the job is stopped, or the records can't
+     *  be copied into the log, the file is left where it was to try again later.
+     *
+     *  @param xmlFile  the file to import
+     *  @param logLock  the lock held by everything which writes to the log
+     *  @param job      if given, the import stops when the job is asked to exit
+     *
+     *  @return the number of records imported, or -1 if nothing was imported
+     */
+    int migrateXmlFile (const File &xmlFile, CriticalSection &logLock, ThreadPoolJob *job = nullptr);
+
+    /** Returns true if a file was renamed by migrateXmlFile(). */
+    static bool isMigratedXmlFile (const File &xmlFile);
+
+private:
+    File logFile, indexFile;
+    bool opened;
+
+    Array <int64> recordOffsets;
+    int64 endOfRecords;
+    AudioFeatureBinaryFormat::ValueType featureValueType;
+
+    File descriptorIndexFile;
+    HashMap <String, int> descriptorSlots;
+    StringArray descriptors;
+    OwnedArray <Array <int> > descriptorRecords;
+    HashMap <String, int> statisticsSlots;
+    OwnedArray <ParameterStatistics> parameterStatistics;
+    int numRecordsWithDescriptorsIndexed;
+    int64 descriptorIndexSize;
+
+    bool createLog();
+    bool loadIndex();
+    bool rebuildIndex();
+    bool addToIndex (int firstRecord);
+    void scanForUnindexedRecords (bool removeIncompleteRecords);
+    bool finishAppending (FileOutputStream &stream, const Array <int64> &newOffsets, int64 newEndOfRecords);
+    bool appendRecordsFrom (const SemanticDataStore &otherStore);
+
+    void synchroniseDescriptorIndex();
+    bool readDescriptorIndex();
+    void rebuildDescriptorIndex();
+    void addToDescriptorIndex();
+    void addRecordToDescriptorIndex (int record, const RecordInfo &info);
+
+    static String getParameterStatisticsKey (const String &pluginCode, const String &descriptor);
+    static bool writeDescriptorIndexEntry (OutputStream &stream, const RecordInfo &info);
+    static bool readDescriptorIndexEntry (InputStream &stream, RecordInfo &info);
+
+    static int64 writeRecord (OutputStream &stream, const RecordInfo &info,
+                              const AudioFeatureBinaryFormat::Writer &unprocessedFeatures,
+                              const AudioFeatureBinaryFormat::Writer &processedFeatures,
+                              AudioFeatureBinaryFormat::ValueType valueType);
+    static int64 checkRecord (InputStream &stream, int64 offset, int64 logSize);
+    static bool readInfo (InputStream &stream, RecordInfo &info);
+
+    JUCE_DECLARE_NON_COPYABLE (SemanticDataStore)
+};
+
+#endif // __SEMANTICDATASTORE__
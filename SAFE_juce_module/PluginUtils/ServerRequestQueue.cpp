@@ -0,0 +1,364 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace ServerRequestQueueHelpers
+{
+    // how long a connection attempt can take before the server counts as unreachable
+    static const int connectionTimeOut = 5000;
+
+    static StringArray parseDescriptorList (const String &response)
+    {
+        StringArray descriptors;
+        descriptors.addTokens (response.removeCharacters ("()[]{}<>"), true);
+        descriptors.removeEmptyStrings();
+
+        return descriptors;
+    }
+
+    /** The server sends a "name, value" line for each parameter. */
+    static Array <double> parseAverageParameters (const String &response)
+    {
+        Array <double> parameters;
+
+        if (response.trim() == "Descriptor not found.")
+        {
+            return parameters;
+        }
+
+        StringArray parameterSettings;
+        parameterSettings.addTokens (response, "\n", "");
+        parameterSettings.removeEmptyStrings();
+
+        for (int i = 0; i < parameterSettings.size(); ++i)
+        {
+            parameters.add (parameterSettings [i].fromFirstOccurrenceOf (", ", false, false).getDoubleValue());
+        }
+
+        return parameters;
+    }
+}
+
+//==========================================================================
+//      Listener
+//==========================================================================
+void ServerRequestQueue::Listener::descriptorListReceived (const String& /*pluginCode*/, const StringArray& /*descriptors*/,
+                                                           bool /*reachedServer*/)
+{
+}
+
+void ServerRequestQueue::Listener::averageParametersReceived (const String& /*pluginCode*/, const String& /*descriptor*/,
+                                                              const Array <double>& /*parameters*/, bool /*reachedServer*/)
+{
+}
+
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+ServerRequestQueue::ServerRequestQueue()
+    : Thread ("ServerRequestQueue"),
+      serverURL (SAFE_SERVER_URL)
+{
+    initialise();
+}
+
+ServerRequestQueue::ServerRequestQueue (const String &serverURLInit)
+    : Thread ("ServerRequestQueue"),
+      serverURL (serverURLInit)
+{
+    initialise();
+}
+
+ServerRequestQueue::~ServerRequestQueue()
+{
+    stopThread (ServerRequestQueueHelpers::connectionTimeOut + 1000);
+    cancelPendingUpdate();
+}
+
+void ServerRequestQueue::initialise()
+{
+    cacheTime = SAFE_SERVER_CACHE_MILLISECONDS;
+
+    startThread();
+}
+
+//==========================================================================
+//      Requests
+//==========================================================================
+void ServerRequestQueue::requestDescriptorList (const String &pluginCode, Listener *listener, bool useCache)
+{
+    addRequest (DescriptorList, pluginCode, String::empty, listener, useCache);
+}
+
+void ServerRequestQueue::requestAverageParameters (const String &pluginCode, const String &descriptor, Listener *listener)
+{
+    addRequest (AverageParameters, pluginCode, descriptor, listener, true);
+}
+
+void ServerRequestQueue::removeListener (Listener *listener)
+{
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = 0; i < requests.size(); ++i)
+        {
+            requests [i]->listeners.removeAllInstancesOf (listener);
+        }
+    }
+
+    for (int i = 0; i < finishedRequests.size(); ++i)
+    {
+        finishedRequests [i]->listeners.removeAllInstancesOf (listener);
+    }
+}
+
+void ServerRequestQueue::addRequest (RequestType type, const String &pluginCode, const String &descriptor,
+                                     Listener *listener, bool useCache)
+{
+    jassert (listener != nullptr);
+
+    const ScopedLock sl (lock);
+
+    String key = getKey (type, pluginCode, descriptor);
+
+    // join a request for the same thing if one is already being made
+    for (int i = 0; i < requests.size(); ++i)
+    {
+        Request *request = requests [i];
+
+        if (! request->finished && request->key == key)
+        {
+            request->listeners.addIfNotAlreadyThere (listener);
+            return;
+        }
+    }
+
+    Request *request = new Request;
+    request->type = type;
+    request->pluginCode = pluginCode;
+    request->descriptor = descriptor;
+    request->key = key;
+    request->listeners.add (listener);
+    request->started = false;
+    request->finished = false;
+    request->reachedServer = false;
+
+    requests.add (request);
+
+    const CachedResponse *cachedResponse = useCache ? findCachedResponse (key) : nullptr;
+
+    if (cachedResponse != nullptr)
+    {
+        // cached results still arrive asynchronously, so listeners see the same thing either way
+        request->started = true;
+        request->finished = true;
+        request->reachedServer = true;
+        request->response = cachedResponse->response;
+
+        triggerAsyncUpdate();
+    }
+    else
+    {
+        notify();
+    }
+}
+
+String ServerRequestQueue::getKey (RequestType type, const String &pluginCode, const String &descriptor) const
+{
+    return String ((int) type) + "/" + pluginCode + "/" + descriptor;
+}
+
+const ServerRequestQueue::CachedResponse* ServerRequestQueue::findCachedResponse (const String &key) const
+{
+    const uint32 now = Time::getMillisecondCounter();
+
+    for (int i = 0; i < cache.size(); ++i)
+    {
+        const CachedResponse *cachedResponse = cache [i];
+
+        if (cachedResponse->key == key)
+        {
+            return now - cachedResponse->timeReceived < (uint32) cacheTime ? cachedResponse : nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+//==========================================================================
+//      Settings
+//==========================================================================
+void ServerRequestQueue::setServerURL (const String &newServerURL)
+{
+    const ScopedLock sl (lock);
+
+    serverURL = newServerURL;
+    cache.clear();
+}
+
+void ServerRequestQueue::setCacheTime (int milliseconds)
+{
+    const ScopedLock sl (lock);
+
+    cacheTime = jmax (0, milliseconds);
+}
+
+void ServerRequestQueue::clearCache()
+{
+    const ScopedLock sl (lock);
+
+    cache.clear();
+}
+
+//==========================================================================
+//      The Thread Callback
+//==========================================================================
+void ServerRequestQueue::run()
+{
+    using namespace ServerRequestQueueHelpers;
+
+    while (! threadShouldExit())
+    {
+        Request *request;
+        URL url;
+
+        {
+            const ScopedLock sl (lock);
+
+            request = getNextRequest();
+
+            if (request != nullptr)
+            {
+                url = getRequestURL (*request);
+            }
+        }
+
+        if (request == nullptr)
+        {
+            // addRequest() wakes the thread up
+            wait (-1);
+            continue;
+        }
+
+        int statusCode = 0;
+        ScopedPointer <InputStream> stream (url.createInputStream (false, nullptr, nullptr, String::empty,
+                                                                   connectionTimeOut, nullptr, &statusCode));
+
+        // not every platform reports the status, so 0 counts as success
+        const bool reachedServer = stream != nullptr && (statusCode == 0 || (statusCode >= 200 && statusCode < 300));
+        String response = reachedServer ? stream->readEntireStreamAsString() : String::empty;
+
+        {
+            const ScopedLock sl (lock);
+
+            request->finished = true;
+            request->reachedServer = reachedServer;
+            request->response = response;
+
+            // failures aren't cached, so asking again tries the server again
+            if (reachedServer)
+            {
+                CachedResponse *cachedResponse = nullptr;
+
+                for (int i = 0; i < cache.size() && cachedResponse == nullptr; ++i)
+                {
+                    if (cache [i]->key == request->key)
+                    {
+                        cachedResponse = cache [i];
+                    }
+                }
+
+                if (cachedResponse == nullptr)
+                {
+                    cachedResponse = new CachedResponse;
+                    cachedResponse->key = request->key;
+                    cache.add (cachedResponse);
+                }
+
+                cachedResponse->response = response;
+                cachedResponse->timeReceived = Time::getMillisecondCounter();
+            }
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+ServerRequestQueue::Request* ServerRequestQueue::getNextRequest()
+{
+    for (int i = 0; i < requests.size(); ++i)
+    {
+        Request *request = requests [i];
+
+        if (! request->started)
+        {
+            request->started = true;
+            return request;
+        }
+    }
+
+    return nullptr;
+}
+
+URL ServerRequestQueue::getRequestURL (const Request &request) const
+{
+    if (request.type == DescriptorList)
+    {
+        return URL (serverURL + "listdescriptors.php").withParameter ("Plugin", request.pluginCode);
+    }
+
+    return URL (serverURL + "getaverageparameters.php").withParameter ("Plugin", request.pluginCode)
+                                                       .withParameter ("Descriptor", request.descriptor);
+}
+
+//==========================================================================
+//      Passing on Results
+//==========================================================================
+void ServerRequestQueue::handleAsyncUpdate()
+{
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = 0; i < requests.size();)
+        {
+            if (requests [i]->finished)
+            {
+                finishedRequests.add (requests.removeAndReturn (i));
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    // listeners can make new requests or remove themselves while they are being told
+    while (finishedRequests.size() > 0)
+    {
+        Request *request = finishedRequests [0];
+
+        if (request->listeners.size() > 0)
+        {
+            sendResult (*request, request->listeners.remove (0));
+        }
+        else
+        {
+            finishedRequests.remove (0);
+        }
+    }
+}
+
+void ServerRequestQueue::sendResult (const Request &request, Listener *listener)
+{
+    using namespace ServerRequestQueueHelpers;
+
+    if (request.type == DescriptorList)
+    {
+        listener->descriptorListReceived (request.pluginCode, parseDescriptorList (request.response),
+                                          request.reachedServer);
+    }
+    else
+    {
+        listener->averageParametersReceived (request.pluginCode, request.descriptor,
+                                             parseAverageParameters (request.response), request.reachedServer);
+    }
+}
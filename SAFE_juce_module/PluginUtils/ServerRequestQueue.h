@@ -0,0 +1,163 @@
+#ifndef __SERVERREQUESTQUEUE__
+#define __SERVERREQUESTQUEUE__
+
+/**
+ *  Fetches descriptor lists and averaged parameters from the SAFE server
+ *  without blocking the thread which asks for them.
+ *
+ *  Requests are made on a background thread and the results are passed to
+ *  listeners on the message thread. Asking for something which is already
+ *  being fetched doesn't fetch it again, the listener just gets the same
+ *  result. Results are cached for a while so opening the load screen again
+ *  doesn't go back to the server.
+ *
+ *  The server address and the time results are cached for are set with the
+ *  SAFE_SERVER_URL and SAFE_SERVER_CACHE_MILLISECONDS flags.
+ *
+ *  Use it through a SharedResourcePointer so all plug-in instances share it.
+ *  Requests should be made, and listeners removed, on the message thread.
+ */
+class ServerRequestQueue : private Thread,
+                           private AsyncUpdater
+{
+public:
+    //==========================================================================
+    //      Listener
+    //==========================================================================
+    /** Receives the results of requests, on the message thread. */
+    class Listener
+    {
+    public:
+        /** Destructor */
+        virtual ~Listener() {}
+
+        /** Called when a list of descriptors has been fetched.
+         *
+         *  @param pluginCode      the plug-in the descriptors are for
+         *  @param descriptors     the descriptors on the server
+         *  @param reachedServer   false if the server couldn't be reached
+         */
+        virtual void descriptorListReceived (const String &pluginCode, const StringArray &descriptors,
+                                             bool reachedServer);
+
+        /** Called when the averaged parameters for a descriptor have been fetched.
+         *
+         *  @param pluginCode      the plug-in the parameters are for
+         *  @param descriptor      the descriptor the parameters were averaged for
+         *  @param parameters      the parameter values, this is empty if the
+         *                         descriptor isn't on the server
+         *  @param reachedServer   false if the server couldn't be reached
+         */
+        virtual void averageParametersReceived (const String &pluginCode, const String &descriptor,
+                                                const Array <double> &parameters, bool reachedServer);
+    };
+
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a queue which fetches from SAFE_SERVER_URL. */
+    ServerRequestQueue();
+
+    /** Create a queue which fetches from a given server.
+     *
+     *  @param serverURLInit  the address the server's scripts are under
+     */
+    ServerRequestQueue (const String &serverURLInit);
+
+    /** Destructor */
+    ~ServerRequestQueue();
+
+    //==========================================================================
+    //      Requests
+    //==========================================================================
+    /** Fetch the descriptors saved on the server for a plug-in.
+     *
+     *  @param pluginCode  the plug-in to get the descriptors for
+     *  @param listener    the listener to tell when they arrive
+     *  @param useCache    if false the server is asked again even if the
+     *                     descriptors are cached
+     */
+    void requestDescriptorList (const String &pluginCode, Listener *listener, bool useCache = true);
+
+    /** Fetch the parameters averaged over the records saved with a descriptor.
+     *
+     *  @param pluginCode  the plug-in to get the parameters for
+     *  @param descriptor  the descriptor to get the parameters for
+     *  @param listener    the listener to tell when they arrive
+     */
+    void requestAverageParameters (const String &pluginCode, const String &descriptor, Listener *listener);
+
+    /** Stop a listener being told about any requests it has made.
+     *
+     *  This must be called before a listener is deleted.
+     */
+    void removeListener (Listener *listener);
+
+    //==========================================================================
+    //      Settings
+    //==========================================================================
+    /** Set the address the server's scripts are under. This clears the cache. */
+    void setServerURL (const String &newServerURL);
+
+    /** Set how long results are cached for. */
+    void setCacheTime (int milliseconds);
+
+    /** Forget all the cached results. */
+    void clearCache();
+
+private:
+    //==========================================================================
+    //      Private Members
+    //==========================================================================
+    enum RequestType
+    {
+        DescriptorList,
+        AverageParameters
+    };
+
+    struct Request
+    {
+        RequestType type;
+        String pluginCode, descriptor, key;
+        Array <Listener*> listeners;
+
+        bool started, finished, reachedServer;
+        String response;
+    };
+
+    struct CachedResponse
+    {
+        String key;
+        String response;
+        uint32 timeReceived;
+    };
+
+    String serverURL;
+    int cacheTime;
+
+    OwnedArray <Request> requests;
+    OwnedArray <CachedResponse> cache;
+    CriticalSection lock;
+
+    // requests whose listeners are being told, only used on the message thread
+    OwnedArray <Request> finishedRequests;
+
+    void initialise();
+
+    void addRequest (RequestType type, const String &pluginCode, const String &descriptor,
+                     Listener *listener, bool useCache);
+    String getKey (RequestType type, const String &pluginCode, const String &descriptor) const;
+    const CachedResponse* findCachedResponse (const String &key) const;
+
+    void run();
+    void handleAsyncUpdate();
+
+    Request* getNextRequest();
+    URL getRequestURL (const Request &request) const;
+
+    static void sendResult (const Request &request, Listener *listener);
+
+    JUCE_DECLARE_NON_COPYABLE (ServerRequestQueue)
+};
+
+#endif // __SERVERREQUESTQUEUE__
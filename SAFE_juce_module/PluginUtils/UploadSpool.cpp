@@ -0,0 +1,456 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace UploadSpoolHelpers
+{
+    static const char* const recordExtension = ".record";
+    static const char* const partialExtension = ".partial";
+
+    // how long a connection attempt can take before the upload counts as failed, on
+    // some platforms this can't be interrupted so the destructor waits a bit longer
+    static const int connectionTimeOut = 5000;
+
+    // an upload slower than this for this long, or longer than the whole limit, counts as failed
+    static const int lowSpeedLimit = 256;
+    static const int lowSpeedTime = 30;
+    static const int transferTimeOut = 300000;
+
+    // only the status code matters, the rest of the response is skipped up to this size
+    static const int maxResponseSize = 65536;
+
+    /** Stops an upload part way through if the spool is shutting down. */
+    static bool shouldContinueUpload (void *context, int /*bytesSent*/, int /*totalBytes*/)
+    {
+        return ! static_cast <Thread*> (context)->threadShouldExit();
+    }
+
+    #if JUCE_LINUX
+    /** The server's response isn't needed, this stops cURL printing it. */
+    static size_t ignoreResponse (char* /*data*/, size_t size, size_t numItems, void* /*context*/)
+    {
+        return size * numItems;
+    }
+
+    /** cURL calls this about once a second, returning non-zero aborts the transfer. */
+    static int curlProgress (void *context, curl_off_t /*downloadTotal*/, curl_off_t /*downloaded*/,
+                             curl_off_t /*uploadTotal*/, curl_off_t /*uploaded*/)
+    {
+        return shouldContinueUpload (context, 0, 0) ? 0 : 1;
+    }
+    #endif
+}
+
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+UploadSpool::UploadSpool()
+    : Thread ("UploadSpool"),
+      spoolDirectory (File::getSpecialLocation (File::userDocumentsDirectory).getChildFile ("SAFEPluginData")
+                                                                               .getChildFile ("UploadSpool")),
+      serverURL (SAFE_UPLOAD_URL),
+      uploadLock ("SAFEUploadSpool")
+{
+    initialise();
+}
+
+UploadSpool::UploadSpool (const File &spoolDirectoryInit, const String &serverURLInit)
+    : Thread ("UploadSpool"),
+      spoolDirectory (spoolDirectoryInit),
+      serverURL (serverURLInit),
+      uploadLock ("SAFEUploadSpool")
+{
+    initialise();
+}
+
+UploadSpool::~UploadSpool()
+{
+    stopThread (UploadSpoolHelpers::connectionTimeOut + 1000);
+}
+
+void UploadSpool::initialise()
+{
+    rejectedDirectory = spoolDirectory.getChildFile ("Rejected");
+    maxBatchRecords = jmax (1, SAFE_UPLOAD_MAX_BATCH_RECORDS);
+    compressionEnabled = SAFE_UPLOAD_COMPRESSION != 0;
+    minRetryDelay = 5000;
+    maxRetryDelay = 600000;
+
+    spoolDirectory.createDirectory();
+
+    // records left from earlier sessions are sent straight away
+    startThread();
+}
+
+//==========================================================================
+//      Records
+//==========================================================================
+bool UploadSpool::addRecord (const MemoryBlock &record)
+{
+    using namespace UploadSpoolHelpers;
+
+    // the names start with the time so the records sort oldest first
+    String name = String::toHexString ((int64) Time::currentTimeMillis()).paddedLeft ('0', 16)
+                  + "-" + String::toHexString (Random::getSystemRandom().nextInt64());
+
+    File partialFile = spoolDirectory.getChildFile (name + partialExtension);
+
+    // the uploader only looks at finished records, so it never sends half a file
+    if (! partialFile.replaceWithData (record.getData(), record.getSize()))
+    {
+        partialFile.deleteFile();
+        return false;
+    }
+
+    if (! partialFile.moveFileTo (spoolDirectory.getChildFile (name + recordExtension).getNonexistentSibling (false)))
+    {
+        partialFile.deleteFile();
+        return false;
+    }
+
+    notify();
+
+    return true;
+}
+
+int UploadSpool::getNumRecords() const
+{
+    return getRecordFiles().size();
+}
+
+const File& UploadSpool::getSpoolDirectory() const
+{
+    return spoolDirectory;
+}
+
+Array <File> UploadSpool::getRecordFiles() const
+{
+    using namespace UploadSpoolHelpers;
+
+    Array <File> files;
+    spoolDirectory.findChildFiles (files, File::findFiles, false, String ("*") + recordExtension);
+
+    StringArray names;
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        names.add (files.getReference (i).getFileName());
+    }
+
+    names.sort (false);
+
+    Array <File> sortedFiles;
+
+    for (int i = 0; i < names.size(); ++i)
+    {
+        sortedFiles.add (spoolDirectory.getChildFile (names [i]));
+    }
+
+    return sortedFiles;
+}
+
+//==========================================================================
+//      Settings
+//==========================================================================
+void UploadSpool::setServerURL (const String &newServerURL)
+{
+    const ScopedLock lock (settingsLock);
+    serverURL = newServerURL;
+}
+
+String UploadSpool::getServerURL() const
+{
+    const ScopedLock lock (settingsLock);
+    return serverURL;
+}
+
+void UploadSpool::setMaxBatchRecords (int newMaxBatchRecords)
+{
+    const ScopedLock lock (settingsLock);
+    maxBatchRecords = jmax (1, newMaxBatchRecords);
+}
+
+void UploadSpool::setCompressionEnabled (bool shouldCompress)
+{
+    const ScopedLock lock (settingsLock);
+    compressionEnabled = shouldCompress;
+}
+
+void UploadSpool::setRetryDelays (int minimumMilliseconds, int maximumMilliseconds)
+{
+    const ScopedLock lock (settingsLock);
+    minRetryDelay = jmax (1, minimumMilliseconds);
+    maxRetryDelay = jmax (minRetryDelay, maximumMilliseconds);
+}
+
+//==========================================================================
+//      The Thread Callback
+//==========================================================================
+void UploadSpool::run()
+{
+    int retryDelay = 0;
+
+    while (! threadShouldExit())
+    {
+        if (getRecordFiles().size() == 0)
+        {
+            // addRecord() wakes the thread up
+            wait (-1);
+            continue;
+        }
+
+        String url;
+        int batchRecords, minDelay, maxDelay;
+        bool compress;
+
+        {
+            const ScopedLock lock (settingsLock);
+
+            url = serverURL;
+            batchRecords = maxBatchRecords;
+            compress = compressionEnabled;
+            minDelay = minRetryDelay;
+            maxDelay = maxRetryDelay;
+        }
+
+        UploadResult result = Failed;
+
+        // another process could be sending records from the same spool
+        if (uploadLock.enter (0))
+        {
+            // look again, the other process may have sent some while we waited
+            Array <File> records = getRecordFiles();
+            records.removeRange (batchRecords, records.size());
+
+            File batchFile = spoolDirectory.getChildFile (compress ? "Batch.xml.gz" : "Batch.xml");
+
+            if (records.size() == 0)
+            {
+                result = Uploaded;
+            }
+            else if (writeBatchFile (records, batchFile, compress))
+            {
+                result = uploadBatchFile (batchFile, url, compress);
+            }
+
+            batchFile.deleteFile();
+
+            for (int i = 0; i < records.size() && result != Failed; ++i)
+            {
+                const File &record = records.getReference (i);
+
+                if (result == Uploaded)
+                {
+                    record.deleteFile();
+                }
+                else
+                {
+                    // records the server won't take are kept, but not sent again
+                    rejectedDirectory.createDirectory();
+                    record.moveFileTo (rejectedDirectory.getChildFile (record.getFileName()).getNonexistentSibling (false));
+                }
+            }
+
+            uploadLock.exit();
+        }
+
+        if (result != Failed)
+        {
+            retryDelay = 0;
+            continue;
+        }
+
+        retryDelay = retryDelay == 0 ? minDelay : jmin (retryDelay * 2, maxDelay);
+
+        // a bit of randomness stops lots of plug-ins retrying in step
+        const uint32 retryTime = Time::getMillisecondCounter() + (uint32) (retryDelay + random.nextInt (retryDelay / 4 + 1));
+
+        // new records don't cut the delay short
+        while (! threadShouldExit() && Time::getMillisecondCounter() < retryTime)
+        {
+            wait ((int) (retryTime - Time::getMillisecondCounter()));
+        }
+    }
+}
+
+//==========================================================================
+//      Uploading
+//==========================================================================
+bool UploadSpool::writeBatchFile (const Array <File> &records, const File &batchFile, bool compress)
+{
+    batchFile.deleteFile();
+
+    FileOutputStream fileStream (batchFile);
+
+    if (! fileStream.openedOk())
+    {
+        return false;
+    }
+
+    // gzip rather than zlib headers, so the server can use standard tools
+    ScopedPointer <GZIPCompressorOutputStream> compressor;
+
+    if (compress)
+    {
+        compressor = new GZIPCompressorOutputStream (&fileStream, 9, false, 15 + 16);
+    }
+
+    OutputStream &stream = compress ? static_cast <OutputStream&> (*compressor) : fileStream;
+    const bool isBatch = records.size() > 1;
+    bool ok = stream.writeText ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n", false, false);
+
+    if (isBatch)
+    {
+        ok = ok && stream.writeText ("<SemanticDataBatch Records=\"" + String (records.size()) + "\">\n", false, false);
+    }
+
+    for (int i = 0; i < records.size() && ok; ++i)
+    {
+        FileInputStream recordStream (records.getReference (i));
+
+        ok = recordStream.openedOk()
+             && stream.writeFromInputStream (recordStream, -1) == recordStream.getTotalLength()
+             && stream.writeText ("\n", false, false);
+    }
+
+    if (isBatch)
+    {
+        ok = ok && stream.writeText ("</SemanticDataBatch>\n", false, false);
+    }
+
+    // the compressor has to finish before the file can be checked
+    compressor = nullptr;
+    fileStream.flush();
+
+    return ok && fileStream.getStatus().wasOk();
+}
+
+UploadSpool::UploadResult UploadSpool::uploadBatchFile (const File &batchFile, const String &url, bool compressed)
+{
+    const String mimeType = compressed ? "application/gzip" : "text/xml";
+
+    #if JUCE_LINUX
+    using namespace UploadSpoolHelpers;
+
+    if (curl.curl == nullptr)
+    {
+        return Failed;
+    }
+
+    struct curl_httppost *formpost = nullptr;
+    struct curl_httppost *lastptr = nullptr;
+    struct curl_slist *headerlist = nullptr;
+    static const char buf[] = "Expect:";
+
+    const String filePath = batchFile.getFullPathName();
+
+    curl_formadd (&formpost,
+                  &lastptr,
+                  CURLFORM_COPYNAME, "DataFile",
+                  CURLFORM_FILE, filePath.toRawUTF8(),
+                  CURLFORM_CONTENTTYPE, mimeType.toRawUTF8(),
+                  CURLFORM_END);
+
+    if (compressed)
+    {
+        curl_formadd (&formpost,
+                      &lastptr,
+                      CURLFORM_COPYNAME, "Encoding",
+                      CURLFORM_COPYCONTENTS, "gzip",
+                      CURLFORM_END);
+    }
+
+    curl_formadd (&formpost,
+                  &lastptr,
+                  CURLFORM_COPYNAME, "submit",
+                  CURLFORM_COPYCONTENTS, "send",
+                  CURLFORM_END);
+
+    headerlist = curl_slist_append (headerlist, buf);
+
+    curl_easy_reset (curl.curl);
+    curl_easy_setopt (curl.curl, CURLOPT_URL, url.toRawUTF8());
+    curl_easy_setopt (curl.curl, CURLOPT_HTTPPOST, formpost);
+    curl_easy_setopt (curl.curl, CURLOPT_HTTPHEADER, headerlist);
+    curl_easy_setopt (curl.curl, CURLOPT_WRITEFUNCTION, ignoreResponse);
+    curl_easy_setopt (curl.curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt (curl.curl, CURLOPT_CONNECTTIMEOUT_MS, (long) connectionTimeOut);
+
+    // a stalled server mustn't keep the thread past the time the destructor waits for it
+    curl_easy_setopt (curl.curl, CURLOPT_LOW_SPEED_LIMIT, (long) lowSpeedLimit);
+    curl_easy_setopt (curl.curl, CURLOPT_LOW_SPEED_TIME, (long) lowSpeedTime);
+    curl_easy_setopt (curl.curl, CURLOPT_TIMEOUT_MS, (long) transferTimeOut);
+    curl_easy_setopt (curl.curl, CURLOPT_XFERINFOFUNCTION, curlProgress);
+    curl_easy_setopt (curl.curl, CURLOPT_XFERINFODATA, static_cast <Thread*> (this));
+    curl_easy_setopt (curl.curl, CURLOPT_NOPROGRESS, 0L);
+
+    CURLcode res = curl_easy_perform (curl.curl);
+
+    long statusCode = 0;
+
+    if (res == CURLE_OK)
+    {
+        curl_easy_getinfo (curl.curl, CURLINFO_RESPONSE_CODE, &statusCode);
+    }
+
+    curl_formfree (formpost);
+    curl_slist_free_all (headerlist);
+
+    return getResultFromStatusCode ((int) statusCode);
+    #else
+    URL dataUpload (url);
+    dataUpload = dataUpload.withFileToUpload ("DataFile", batchFile, mimeType);
+
+    if (compressed)
+    {
+        dataUpload = dataUpload.withParameter ("Encoding", "gzip");
+    }
+
+    using namespace UploadSpoolHelpers;
+
+    int statusCode = 0;
+    ScopedPointer <InputStream> stream (dataUpload.createInputStream (true, shouldContinueUpload, static_cast <Thread*> (this),
+                                                                      String::empty, connectionTimeOut,
+                                                                      nullptr, &statusCode));
+
+    if (stream == nullptr || threadShouldExit())
+    {
+        return Failed;
+    }
+
+    // let the server finish handling the upload before it counts as sent, but
+    // don't wait on a response which never ends
+    char buffer [1024];
+    int numBytesRead = 0;
+
+    while (numBytesRead < maxResponseSize && ! threadShouldExit())
+    {
+        const int numBytes = stream->read (buffer, sizeof (buffer));
+
+        if (numBytes <= 0)
+        {
+            break;
+        }
+
+        numBytesRead += numBytes;
+    }
+
+    return threadShouldExit() ? Failed : getResultFromStatusCode (statusCode);
+    #endif
+}
+
+UploadSpool::UploadResult UploadSpool::getResultFromStatusCode (int statusCode) const
+{
+    if (statusCode >= 200 && statusCode < 300)
+    {
+        return Uploaded;
+    }
+
+    // the server is there but won't take the records, sending them again won't help,
+    // apart from timeouts and being told to slow down
+    if (statusCode >= 400 && statusCode < 500 && statusCode != 408 && statusCode != 429)
+    {
+        return Rejected;
+    }
+
+    return Failed;
+}
@@ -0,0 +1,133 @@
+#ifndef __UPLOADSPOOL__
+#define __UPLOADSPOOL__
+
+/**
+ *  An on-disk queue of semantic data waiting to be sent to the SAFE server.
+ *
+ *  Adding a record only writes it to a file in the spool directory, so saving
+ *  never waits for the network. A background thread sends the spooled
+ *  records in batches, oldest first. Failed uploads are retried with a
+ *  growing delay. Records stay on disk until the server takes them, so they
+ *  survive the host being closed and are sent the next time a plug-in runs.
+ *  Uploads which stall count as failed, and one in progress when the spool
+ *  is deleted is abandoned, so a dead server can't hold up the host.
+ *
+ *  Each record is a SemanticData element without an xml declaration. A batch
+ *  of one record is uploaded exactly as the plug-ins always have, as an xml
+ *  file in the DataFile field. Larger batches wrap their records in a
+ *  SemanticDataBatch element. Compressed uploads are gzipped and have an
+ *  Encoding field set to "gzip".
+ *
+ *  The default server, batch size and compression are set with the
+ *  SAFE_UPLOAD_URL, SAFE_UPLOAD_MAX_BATCH_RECORDS and SAFE_UPLOAD_COMPRESSION
+ *  flags. Uploads from different processes sharing a spool are kept apart
+ *  with an InterProcessLock.
+ *
+ *  Use it through a SharedResourcePointer so all plug-in instances share it.
+ */
+class UploadSpool : private Thread
+{
+public:
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a spool in SAFEPluginData/UploadSpool which uploads to SAFE_UPLOAD_URL. */
+    UploadSpool();
+
+    /** Create a spool in a given directory which uploads to a given server.
+     *
+     *  @param spoolDirectoryInit  the directory to keep the records in, it is
+     *                             created if it doesn't exist
+     *  @param serverURLInit       the address records are posted to
+     */
+    UploadSpool (const File &spoolDirectoryInit, const String &serverURLInit);
+
+    /** Destructor, records which haven't been sent yet stay in the spool. */
+    ~UploadSpool();
+
+    //==========================================================================
+    //      Records
+    //==========================================================================
+    /** Add a record to the spool.
+     *
+     *  The record is written to disk and the uploader is woken up, this
+     *  doesn't wait for it to be sent.
+     *
+     *  @param record  the record's xml
+     *
+     *  @return false if the record couldn't be written to the spool
+     */
+    bool addRecord (const MemoryBlock &record);
+
+    /** Returns the number of records waiting to be sent. */
+    int getNumRecords() const;
+
+    /** Returns the directory the records are kept in. */
+    const File& getSpoolDirectory() const;
+
+    //==========================================================================
+    //      Settings
+    //==========================================================================
+    /** Set the address records are posted to. */
+    void setServerURL (const String &newServerURL);
+
+    /** Returns the address records are posted to. */
+    String getServerURL() const;
+
+    /** Set the largest number of records sent in one upload. */
+    void setMaxBatchRecords (int newMaxBatchRecords);
+
+    /** Set whether uploads are gzipped. */
+    void setCompressionEnabled (bool shouldCompress);
+
+    /** Set the delays between failed uploads.
+     *
+     *  The delay doubles after each failure, starting at the minimum, until
+     *  it reaches the maximum. It goes back to the minimum once an upload
+     *  succeeds.
+     *
+     *  @param minimumMilliseconds  the delay after the first failure
+     *  @param maximumMilliseconds  the longest delay
+     */
+    void setRetryDelays (int minimumMilliseconds, int maximumMilliseconds);
+
+private:
+    //==========================================================================
+    //      Private Members
+    //==========================================================================
+    File spoolDirectory, rejectedDirectory;
+    String serverURL;
+    int maxBatchRecords;
+    bool compressionEnabled;
+    int minRetryDelay, maxRetryDelay;
+    CriticalSection settingsLock;
+
+    InterProcessLock uploadLock;
+    Random random;
+
+    #if JUCE_LINUX
+    CurlHolder curl;
+    #endif
+
+    void initialise();
+    void run();
+
+    /** The results of trying to upload a batch. */
+    enum UploadResult
+    {
+        Uploaded,
+        Failed,
+        Rejected
+    };
+
+    /** Returns the records in the spool, oldest first. */
+    Array <File> getRecordFiles() const;
+
+    bool writeBatchFile (const Array <File> &records, const File &batchFile, bool compress);
+    UploadResult uploadBatchFile (const File &batchFile, const String &url, bool compressed);
+    UploadResult getResultFromStatusCode (int statusCode) const;
+
+    JUCE_DECLARE_NON_COPYABLE (UploadSpool)
+};
+
+#endif // __UPLOADSPOOL__
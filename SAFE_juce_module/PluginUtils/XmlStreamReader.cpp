@@ -0,0 +1,495 @@
+//==========================================================================
+//      Helpers
+//==========================================================================
+namespace XmlStreamReaderHelpers
+{
+    static const int readBlockSize = 65536;
+
+    static bool isWhitespace (int character)
+    {
+        return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+    }
+}
+
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+XmlStreamReader::XmlStreamReader (InputStream &inputStream)
+    : stream (inputStream),
+      bufferSize (0),
+      bufferPosition (0),
+      closeEmptyElement (false),
+      finished (false)
+{
+    buffer.malloc (XmlStreamReaderHelpers::readBlockSize);
+}
+
+XmlStreamReader::~XmlStreamReader()
+{
+}
+
+//==========================================================================
+//      Reading
+//==========================================================================
+XmlStreamReader::Event XmlStreamReader::readNext()
+{
+    if (finished)
+    {
+        return errorMessage.isEmpty() ? EndOfDocument : ParseError;
+    }
+
+    attributeNames.clearQuick();
+    attributeValues.clearQuick();
+
+    // the end of an empty element comes straight after its start
+    if (closeEmptyElement)
+    {
+        closeEmptyElement = false;
+        openElements.remove (openElements.size() - 1);
+
+        return EndOfElement;
+    }
+
+    for (;;)
+    {
+        if (bufferPosition == bufferSize && ! fillBuffer())
+        {
+            if (openElements.size() > 0)
+            {
+                return fail ("unexpected end of document inside <" + openElements [openElements.size() - 1] + ">");
+            }
+
+            finished = true;
+            return EndOfDocument;
+        }
+
+        // any text between the tags is skipped
+        const char *start = buffer + bufferPosition;
+        const char *tagStart = static_cast <const char*> (memchr (start, '<', (size_t) (bufferSize - bufferPosition)));
+
+        if (tagStart == nullptr)
+        {
+            bufferPosition = bufferSize;
+            continue;
+        }
+
+        bufferPosition += (int) (tagStart - start) + 1;
+
+        const int character = peekCharacter();
+
+        if (character == '?')
+        {
+            if (! skipPast ("?>"))
+            {
+                return fail ("unterminated processing instruction");
+            }
+        }
+        else if (character == '!')
+        {
+            ++bufferPosition;
+
+            const int nextCharacter = peekCharacter();
+            bool skipped;
+
+            if (nextCharacter == '-')
+            {
+                skipped = skipPast ("-->");
+            }
+            else if (nextCharacter == '[')
+            {
+                skipped = skipPast ("]]>");
+            }
+            else
+            {
+                skipped = skipDocumentType();
+            }
+
+            if (! skipped)
+            {
+                return fail ("unterminated comment or declaration");
+            }
+        }
+        else if (character == '/')
+        {
+            ++bufferPosition;
+            return readEndTag();
+        }
+        else
+        {
+            return readStartTag();
+        }
+    }
+}
+
+const String& XmlStreamReader::getTagName() const
+{
+    return tagName;
+}
+
+int XmlStreamReader::getDepth() const
+{
+    return openElements.size();
+}
+
+const String& XmlStreamReader::getErrorMessage() const
+{
+    return errorMessage;
+}
+
+//==========================================================================
+//      Attributes
+//==========================================================================
+int XmlStreamReader::getNumAttributes() const
+{
+    return attributeNames.size();
+}
+
+const String& XmlStreamReader::getAttributeName (int index) const
+{
+    return attributeNames [index];
+}
+
+const String& XmlStreamReader::getAttributeValue (int index) const
+{
+    return attributeValues [index];
+}
+
+String XmlStreamReader::getStringAttribute (const String &name, const String &defaultValue) const
+{
+    const int index = attributeNames.indexOf (name);
+
+    return index >= 0 ? attributeValues [index] : defaultValue;
+}
+
+int XmlStreamReader::getIntAttribute (const String &name, int defaultValue) const
+{
+    const int index = attributeNames.indexOf (name);
+
+    return index >= 0 ? attributeValues [index].getIntValue() : defaultValue;
+}
+
+double XmlStreamReader::getDoubleAttribute (const String &name, double defaultValue) const
+{
+    const int index = attributeNames.indexOf (name);
+
+    return index >= 0 ? attributeValues [index].getDoubleValue() : defaultValue;
+}
+
+//==========================================================================
+//      Private Methods
+//==========================================================================
+int XmlStreamReader::peekCharacter()
+{
+    if (bufferPosition == bufferSize && ! fillBuffer())
+    {
+        return -1;
+    }
+
+    return (unsigned char) buffer [bufferPosition];
+}
+
+int XmlStreamReader::readCharacter()
+{
+    const int character = peekCharacter();
+
+    if (character >= 0)
+    {
+        ++bufferPosition;
+    }
+
+    return character;
+}
+
+bool XmlStreamReader::fillBuffer()
+{
+    bufferSize = jmax (0, stream.read (buffer, XmlStreamReaderHelpers::readBlockSize));
+    bufferPosition = 0;
+
+    return bufferSize > 0;
+}
+
+void XmlStreamReader::skipWhitespace()
+{
+    while (XmlStreamReaderHelpers::isWhitespace (peekCharacter()))
+    {
+        ++bufferPosition;
+    }
+}
+
+bool XmlStreamReader::skipPast (const char *terminator)
+{
+    // the last few characters read are kept to compare with the terminator
+    const int terminatorLength = (int) strlen (terminator);
+    char recent [4] = {0, 0, 0, 0};
+
+    jassert (terminatorLength <= (int) sizeof (recent));
+
+    for (;;)
+    {
+        const int character = readCharacter();
+
+        if (character < 0)
+        {
+            return false;
+        }
+
+        memmove (recent, recent + 1, sizeof (recent) - 1);
+        recent [sizeof (recent) - 1] = (char) character;
+
+        if (memcmp (recent + sizeof (recent) - terminatorLength, terminator, (size_t) terminatorLength) == 0)
+        {
+            return true;
+        }
+    }
+}
+
+bool XmlStreamReader::skipDocumentType()
+{
+    // a DTD can have its own declarations in brackets
+    int depth = 0;
+
+    for (;;)
+    {
+        const int character = readCharacter();
+
+        if (character < 0)
+        {
+            return false;
+        }
+        else if (character == '[')
+        {
+            ++depth;
+        }
+        else if (character == ']')
+        {
+            --depth;
+        }
+        else if (character == '>' && depth <= 0)
+        {
+            return true;
+        }
+    }
+}
+
+bool XmlStreamReader::readName (String &name)
+{
+    text.reset();
+
+    while (isNameCharacter (peekCharacter()))
+    {
+        text.writeByte (buffer [bufferPosition++]);
+    }
+
+    if (text.getDataSize() == 0)
+    {
+        return false;
+    }
+
+    name = String::fromUTF8 (static_cast <const char*> (text.getData()), (int) text.getDataSize());
+    return true;
+}
+
+bool XmlStreamReader::readAttributeValue (char quote, String &value)
+{
+    text.reset();
+
+    for (;;)
+    {
+        if (bufferPosition == bufferSize && ! fillBuffer())
+        {
+            return false;
+        }
+
+        // plain characters are copied in runs straight from the buffer
+        const char *runStart = buffer + bufferPosition;
+        const char *bufferEnd = buffer + bufferSize;
+        const char *runEnd = runStart;
+
+        while (runEnd < bufferEnd && *runEnd != quote && *runEnd != '&' && *runEnd != '<')
+        {
+            ++runEnd;
+        }
+
+        text.write (runStart, (size_t) (runEnd - runStart));
+        bufferPosition += (int) (runEnd - runStart);
+
+        if (runEnd == bufferEnd)
+        {
+            continue;
+        }
+
+        ++bufferPosition;
+
+        if (*runEnd == quote)
+        {
+            break;
+        }
+        else if (*runEnd == '<' || ! readEntity())
+        {
+            return false;
+        }
+    }
+
+    value = String::fromUTF8 (static_cast <const char*> (text.getData()), (int) text.getDataSize());
+    return true;
+}
+
+bool XmlStreamReader::readEntity()
+{
+    char entity [12];
+    int length = 0;
+
+    for (;;)
+    {
+        const int character = readCharacter();
+
+        if (character < 0 || length == (int) sizeof (entity) - 1)
+        {
+            return false;
+        }
+        else if (character == ';')
+        {
+            break;
+        }
+
+        entity [length++] = (char) character;
+    }
+
+    entity [length] = 0;
+
+    juce_wchar character;
+
+    if (strcmp (entity, "amp") == 0)            character = '&';
+    else if (strcmp (entity, "lt") == 0)        character = '<';
+    else if (strcmp (entity, "gt") == 0)        character = '>';
+    else if (strcmp (entity, "quot") == 0)      character = '"';
+    else if (strcmp (entity, "apos") == 0)      character = '\'';
+    else if (entity [0] == '#' && (entity [1] == 'x' || entity [1] == 'X'))
+    {
+        character = (juce_wchar) String::fromUTF8 (entity + 2).getHexValue32();
+    }
+    else if (entity [0] == '#')
+    {
+        character = (juce_wchar) String::fromUTF8 (entity + 1).getIntValue();
+    }
+    else
+    {
+        // without a DTD nothing else can be defined
+        return false;
+    }
+
+    if (character == 0)
+    {
+        return false;
+    }
+
+    char encoded [8];
+    CharPointer_UTF8 destination (encoded);
+    destination.write (character);
+
+    text.write (encoded, (size_t) (destination.getAddress() - encoded));
+    return true;
+}
+
+XmlStreamReader::Event XmlStreamReader::readStartTag()
+{
+    if (! readName (tagName))
+    {
+        return fail ("expected a tag name");
+    }
+
+    for (;;)
+    {
+        skipWhitespace();
+
+        const int character = peekCharacter();
+
+        if (character == '>')
+        {
+            ++bufferPosition;
+            break;
+        }
+        else if (character == '/')
+        {
+            ++bufferPosition;
+
+            if (readCharacter() != '>')
+            {
+                return fail ("expected '>' after '/' in <" + tagName + ">");
+            }
+
+            closeEmptyElement = true;
+            break;
+        }
+
+        String name, value;
+
+        if (! readName (name))
+        {
+            return fail ("unexpected character in <" + tagName + ">");
+        }
+
+        skipWhitespace();
+
+        if (readCharacter() != '=')
+        {
+            return fail ("expected '=' after attribute " + name + " in <" + tagName + ">");
+        }
+
+        skipWhitespace();
+
+        const int quote = readCharacter();
+
+        if ((quote != '"' && quote != '\'') || ! readAttributeValue ((char) quote, value))
+        {
+            return fail ("bad value for attribute " + name + " in <" + tagName + ">");
+        }
+
+        attributeNames.add (name);
+        attributeValues.add (value);
+    }
+
+    openElements.add (tagName);
+    return StartOfElement;
+}
+
+XmlStreamReader::Event XmlStreamReader::readEndTag()
+{
+    if (! readName (tagName))
+    {
+        return fail ("expected a tag name after '</'");
+    }
+
+    skipWhitespace();
+
+    if (readCharacter() != '>')
+    {
+        return fail ("expected '>' after </" + tagName);
+    }
+
+    if (openElements.size() == 0 || openElements [openElements.size() - 1] != tagName)
+    {
+        return fail ("</" + tagName + "> doesn't match the open element");
+    }
+
+    openElements.remove (openElements.size() - 1);
+    return EndOfElement;
+}
+
+XmlStreamReader::Event XmlStreamReader::fail (const String &message)
+{
+    errorMessage = message;
+    finished = true;
+
+    return ParseError;
+}
+
+bool XmlStreamReader::isNameCharacter (int character)
+{
+    // anything outside ascii is allowed so names in other scripts pass through
+    return (character >= 'a' && character <= 'z')
+        || (character >= 'A' && character <= 'Z')
+        || (character >= '0' && character <= '9')
+        || character == '_' || character == ':' || character == '-' || character == '.'
+        || character >= 0x80;
+}
@@ -0,0 +1,109 @@
+#ifndef __XMLSTREAMREADER__
+#define __XMLSTREAMREADER__
+
+/**
+ *  Reads xml straight from an InputStream without building an XmlElement.
+ *
+ *  The document is handed back one event at a time - the start or end of an
+ *  element - so the memory used only depends on how deeply the elements are
+ *  nested and how long their attributes are, not on the size of the document.
+ *  Text, comments, processing instructions, CDATA sections and DTDs are
+ *  skipped over, so this is only suited to documents which keep their data
+ *  in attributes, like the ones XmlStreamWriter writes.
+ */
+class XmlStreamReader
+{
+public:
+    /** The events the reader produces. */
+    enum Event
+    {
+        StartOfElement,
+        EndOfElement,
+        EndOfDocument,
+        ParseError
+    };
+
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a reader for a stream.
+     *
+     *  @param inputStream  the stream to read from, this must outlive the reader
+     */
+    XmlStreamReader (InputStream &inputStream);
+
+    /** Destructor */
+    ~XmlStreamReader();
+
+    //==========================================================================
+    //      Reading
+    //==========================================================================
+    /** Read up to the next event.
+     *
+     *  An empty element produces a StartOfElement followed by an EndOfElement.
+     *  Once EndOfDocument or ParseError has been returned it keeps being returned.
+     */
+    Event readNext();
+
+    /** Returns the tag name of the element the last event belonged to. */
+    const String& getTagName() const;
+
+    /** Returns the number of elements which are open.
+     *
+     *  After a StartOfElement this includes the new element, after an
+     *  EndOfElement it no longer includes the closed one.
+     */
+    int getDepth() const;
+
+    /** Returns a description of what went wrong after a ParseError. */
+    const String& getErrorMessage() const;
+
+    //==========================================================================
+    //      Attributes
+    //==========================================================================
+    /** These describe the attributes of the element after a StartOfElement. */
+    int getNumAttributes() const;
+    const String& getAttributeName (int index) const;
+    const String& getAttributeValue (int index) const;
+
+    /** Returns the value of an attribute, or a default if the element doesn't have it. */
+    String getStringAttribute (const String &name, const String &defaultValue = String::empty) const;
+    int getIntAttribute (const String &name, int defaultValue = 0) const;
+    double getDoubleAttribute (const String &name, double defaultValue = 0.0) const;
+
+private:
+    //==========================================================================
+    //      Private Members
+    //==========================================================================
+    InputStream &stream;
+
+    HeapBlock <char> buffer;
+    int bufferSize, bufferPosition;
+
+    StringArray openElements;
+    String tagName;
+    StringArray attributeNames, attributeValues;
+    bool closeEmptyElement, finished;
+    String errorMessage;
+
+    MemoryOutputStream text;
+
+    int peekCharacter();
+    int readCharacter();
+    bool fillBuffer();
+    void skipWhitespace();
+    bool skipPast (const char *terminator);
+    bool skipDocumentType();
+    bool readName (String &name);
+    bool readAttributeValue (char quote, String &value);
+    bool readEntity();
+    Event readStartTag();
+    Event readEndTag();
+    Event fail (const String &message);
+
+    static bool isNameCharacter (int character);
+
+    JUCE_DECLARE_NON_COPYABLE (XmlStreamReader)
+};
+
+#endif // __XMLSTREAMREADER__
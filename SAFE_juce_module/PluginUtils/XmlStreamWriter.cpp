@@ -0,0 +1,213 @@
+//==========================================================================
+//      Constructor and Destructor
+//==========================================================================
+XmlStreamWriter::XmlStreamWriter (OutputStream &outputStream, int initialIndent)
+    : stream (outputStream),
+      indent (initialIndent),
+      startTagOpen (false),
+      attributeOpen (false),
+      succeeded (true)
+{
+}
+
+XmlStreamWriter::~XmlStreamWriter()
+{
+    if (attributeOpen)
+    {
+        endAttribute();
+    }
+
+    while (openElements.size() > 0)
+    {
+        endElement();
+    }
+}
+
+//==========================================================================
+//      Writing
+//==========================================================================
+void XmlStreamWriter::writeHeader()
+{
+    // the same declaration XmlElement writes
+    jassert (openElements.size() == 0);
+
+    write ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+    write (newLine.getDefault());
+    write (newLine.getDefault());
+}
+
+void XmlStreamWriter::startElement (const String &tagName)
+{
+    jassert (! attributeOpen);
+
+    if (startTagOpen)
+    {
+        closeStartTag();
+    }
+
+    writeIndent (openElements.size());
+    write ("<");
+    write (tagName.toRawUTF8());
+
+    openElements.add (tagName);
+    startTagOpen = true;
+}
+
+void XmlStreamWriter::endElement()
+{
+    jassert (! attributeOpen);
+
+    if (openElements.size() == 0)
+    {
+        // there is nothing to close
+        jassertfalse;
+        return;
+    }
+
+    if (startTagOpen)
+    {
+        // elements without children close themselves
+        write ("/>");
+        startTagOpen = false;
+    }
+    else
+    {
+        writeIndent (openElements.size() - 1);
+        write ("</");
+        write (openElements [openElements.size() - 1].toRawUTF8());
+        write (">");
+    }
+
+    write (newLine.getDefault());
+
+    openElements.remove (openElements.size() - 1);
+}
+
+void XmlStreamWriter::addAttribute (const String &name, const String &value)
+{
+    startAttribute (name);
+    writeAttributeText (value);
+    endAttribute();
+}
+
+void XmlStreamWriter::addAttribute (const String &name, int value)
+{
+    addAttribute (name, String (value));
+}
+
+void XmlStreamWriter::addAttribute (const String &name, double value)
+{
+    addAttribute (name, String (value));
+}
+
+void XmlStreamWriter::startAttribute (const String &name)
+{
+    // attributes have to come before any child elements
+    jassert (startTagOpen && ! attributeOpen);
+
+    write (" ");
+    write (name.toRawUTF8());
+    write ("=\"");
+
+    attributeOpen = true;
+}
+
+void XmlStreamWriter::writeAttributeText (const String &text)
+{
+    jassert (attributeOpen);
+
+    writeEscaped (text);
+}
+
+void XmlStreamWriter::endAttribute()
+{
+    jassert (attributeOpen);
+
+    write ("\"");
+
+    attributeOpen = false;
+}
+
+int XmlStreamWriter::getNumOpenElements() const
+{
+    return openElements.size();
+}
+
+bool XmlStreamWriter::wasSuccessful() const
+{
+    return succeeded;
+}
+
+//==========================================================================
+//      Private Methods
+//==========================================================================
+void XmlStreamWriter::closeStartTag()
+{
+    write (">");
+    write (newLine.getDefault());
+
+    startTagOpen = false;
+}
+
+void XmlStreamWriter::writeIndent (int level)
+{
+    for (int i = 0; i < 2 * (indent + level); ++i)
+    {
+        write (" ");
+    }
+}
+
+void XmlStreamWriter::write (const char *text)
+{
+    if (! stream.write (text, strlen (text)))
+    {
+        succeeded = false;
+    }
+}
+
+void XmlStreamWriter::writeEscaped (const String &text)
+{
+    String::CharPointerType character (text.getCharPointer());
+
+    // plain ascii characters are written in runs straight from the string
+    const char *runStart = character.getAddress();
+
+    for (;;)
+    {
+        const char *characterStart = character.getAddress();
+        const juce_wchar currentCharacter = character.getAndAdvance();
+
+        bool plainCharacter = currentCharacter >= 32 && currentCharacter < 127
+                              && currentCharacter != '&' && currentCharacter != '<' && currentCharacter != '>'
+                              && currentCharacter != '"' && currentCharacter != '\'';
+
+        if (plainCharacter)
+        {
+            continue;
+        }
+
+        if (characterStart > runStart && ! stream.write (runStart, (size_t) (characterStart - runStart)))
+        {
+            succeeded = false;
+        }
+
+        runStart = character.getAddress();
+
+        switch (currentCharacter)
+        {
+            case 0:     return;
+            case '&':   write ("&amp;"); break;
+            case '<':   write ("&lt;"); break;
+            case '>':   write ("&gt;"); break;
+            case '"':   write ("&quot;"); break;
+            case '\'':  write ("&apos;"); break;
+
+            default:
+                // control characters and anything outside ascii become character references
+                write ("&#");
+                write (String ((int) currentCharacter).toRawUTF8());
+                write (";");
+                break;
+        }
+    }
+}
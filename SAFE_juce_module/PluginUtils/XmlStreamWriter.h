@@ -0,0 +1,92 @@
+#ifndef __XMLSTREAMWRITER__
+#define __XMLSTREAMWRITER__
+
+/**
+ *  Writes xml straight to an OutputStream without building an XmlElement.
+ *
+ *  Elements are opened and closed in order and their attributes are written
+ *  as they are added, so the memory used only depends on how deeply the
+ *  elements are nested. Attribute values and text are escaped the same way
+ *  as XmlElement does it, so anything written can be read back with an
+ *  XmlDocument.
+ */
+class XmlStreamWriter
+{
+public:
+    //==========================================================================
+    //      Constructor and Destructor
+    //==========================================================================
+    /** Create a writer for a stream.
+     *
+     *  @param outputStream   the stream to write to, this must outlive the writer
+     *  @param initialIndent  the number of levels to indent the top level elements,
+     *                        useful when adding elements to an existing document
+     */
+    XmlStreamWriter (OutputStream &outputStream, int initialIndent = 0);
+
+    /** Destructor, closes any elements which are still open. */
+    ~XmlStreamWriter();
+
+    //==========================================================================
+    //      Writing
+    //==========================================================================
+    /** Write the standard xml declaration. This should come before any elements. */
+    void writeHeader();
+
+    /** Open a new element.
+     *
+     *  Any elements which are already open will become its parents.
+     */
+    void startElement (const String &tagName);
+
+    /** Close the most recently opened element. */
+    void endElement();
+
+    /** Add an attribute to the most recently opened element.
+     *
+     *  This must be called before any child elements are started.
+     */
+    void addAttribute (const String &name, const String &value);
+    void addAttribute (const String &name, int value);
+    void addAttribute (const String &name, double value);
+
+    /** Start an attribute whose value will be written in pieces.
+     *
+     *  Use this for long values such as lists of numbers which would otherwise
+     *  have to be built up in a String first. Follow it with calls to
+     *  writeAttributeText() and then endAttribute().
+     */
+    void startAttribute (const String &name);
+
+    /** Write part of the value of an attribute opened with startAttribute(). */
+    void writeAttributeText (const String &text);
+
+    /** Finish an attribute opened with startAttribute(). */
+    void endAttribute();
+
+    /** Returns the number of elements which are currently open. */
+    int getNumOpenElements() const;
+
+    /** Returns true if all the writes to the stream so far have succeeded. */
+    bool wasSuccessful() const;
+
+private:
+    //==========================================================================
+    //      Private Members
+    //==========================================================================
+    OutputStream &stream;
+    int indent;
+
+    StringArray openElements;
+    bool startTagOpen, elementHasChildren, attributeOpen;
+    bool succeeded;
+
+    void closeStartTag();
+    void writeIndent (int level);
+    void write (const char *text);
+    void writeEscaped (const String &text);
+
+    JUCE_DECLARE_NON_COPYABLE (XmlStreamWriter)
+};
+
+#endif // __XMLSTREAMWRITER__
@@ -36,6 +36,22 @@ namespace juce
 
 #include "PluginUtils/LibXtractHolder.cpp"
 #include "PluginUtils/LibXtractFeatures.cpp"
+#include "PluginUtils/LibXtractFeatureGraph.cpp"
+#include "PluginUtils/AnalysisThreadPool.cpp"
+#include "PluginUtils/AnalysisScheduler.cpp"
+#include "PluginUtils/UploadSpool.cpp"
+#include "PluginUtils/ServerRequestQueue.cpp"
+#include "PluginUtils/FeatureKernels.cpp"
+#include "PluginUtils/AnalysisWindows.cpp"
+#include "PluginUtils/AudioFeatureStore.cpp"
+#include "PluginUtils/PreRollBuffer.cpp"
+#include "PluginUtils/RealtimeSemaphore.cpp"
+#include "PluginUtils/FeatureValueCodec.cpp"
+#include "PluginUtils/AudioFeatureBinaryFormat.cpp"
+#include "PluginUtils/XmlStreamWriter.cpp"
+#include "PluginUtils/XmlStreamReader.cpp"
+#include "PluginUtils/SemanticDataStore.cpp"
+#include "PluginUtils/SemanticDataReader.cpp"
 #include "PluginUtils/SAFEFeatureExtractor.cpp"
 #include "PluginUtils/SAFEParameter.cpp"
 #include "PluginUtils/SAFEAudioProcessor.cpp"
@@ -11,10 +11,78 @@
 #include <complex>
 #include <map>
 
+#if JUCE_INTEL
+    #include <emmintrin.h>
+    #define SAFE_USE_SSE_INTRINSICS 1
+#elif JUCE_ARM && defined (__aarch64__)
+    #include <arm_neon.h>
+    #define SAFE_USE_NEON_INTRINSICS 1
+#endif
+
 #if JUCE_LINUX
     #include <curl/curl.h>
 #endif
 
+#if JUCE_LINUX || JUCE_ANDROID
+    #include <semaphore.h>
+    #include <errno.h>
+#elif JUCE_MAC || JUCE_IOS
+    #include <dispatch/dispatch.h>
+#endif
+
+//=============================================================================
+/** Config: SAFE_ANALYSIS_SCHEDULER_THREADS
+    The number of worker threads shared by all plug-ins for saving analysed data.
+    If this is 0 one thread is used for each CPU.
+*/
+#ifndef SAFE_ANALYSIS_SCHEDULER_THREADS
+    #define SAFE_ANALYSIS_SCHEDULER_THREADS 0
+#endif
+
+/** Config: SAFE_ANALYSIS_SCHEDULER_MAX_JOBS
+    The maximum number of save jobs which can be waiting or running at once.
+*/
+#ifndef SAFE_ANALYSIS_SCHEDULER_MAX_JOBS
+    #define SAFE_ANALYSIS_SCHEDULER_MAX_JOBS 64
+#endif
+
+/** Config: SAFE_UPLOAD_URL
+    The address semantic data is posted to when it is sent to the server.
+*/
+#ifndef SAFE_UPLOAD_URL
+    #define SAFE_UPLOAD_URL "http://193.60.133.151/newsafe/uploadterm.php"
+#endif
+
+/** Config: SAFE_UPLOAD_MAX_BATCH_RECORDS
+    The largest number of records sent to the server in one upload. Anything more
+    than 1 needs a server which understands SemanticDataBatch files.
+*/
+#ifndef SAFE_UPLOAD_MAX_BATCH_RECORDS
+    #define SAFE_UPLOAD_MAX_BATCH_RECORDS 1
+#endif
+
+/** Config: SAFE_UPLOAD_COMPRESSION
+    Set this to 1 to gzip uploads to the server. The server has to be able to
+    unzip them.
+*/
+#ifndef SAFE_UPLOAD_COMPRESSION
+    #define SAFE_UPLOAD_COMPRESSION 0
+#endif
+
+/** Config: SAFE_SERVER_URL
+    The address the server's descriptor and parameter scripts are under.
+*/
+#ifndef SAFE_SERVER_URL
+    #define SAFE_SERVER_URL "http://193.60.133.151/newsafe/"
+#endif
+
+/** Config: SAFE_SERVER_CACHE_MILLISECONDS
+    How long descriptor lists and parameters fetched from the server are kept for.
+*/
+#ifndef SAFE_SERVER_CACHE_MILLISECONDS
+    #define SAFE_SERVER_CACHE_MILLISECONDS 300000
+#endif
+
 //=============================================================================
 namespace juce
 {
@@ -22,6 +90,9 @@ namespace juce
 #include "LookAndFeel/SAFEColours.h"
 #include "LookAndFeel/SAFELookAndFeel.h"
 
+// the descriptor load screen listens for server requests
+#include "PluginUtils/ServerRequestQueue.h"
+
 #include "UIComponents/SAFEButton.h"
 #include "UIComponents/SAFESlider.h"
 #include "UIComponents/XYSlider.h"
@@ -44,6 +115,21 @@ namespace juce
 #endif
 
 #include "PluginUtils/LibXtractFeatures.h"
+#include "PluginUtils/LibXtractFeatureGraph.h"
+#include "PluginUtils/AnalysisThreadPool.h"
+#include "PluginUtils/AnalysisScheduler.h"
+#include "PluginUtils/UploadSpool.h"
+#include "PluginUtils/FeatureKernels.h"
+#include "PluginUtils/AnalysisWindows.h"
+#include "PluginUtils/AudioFeatureStore.h"
+#include "PluginUtils/PreRollBuffer.h"
+#include "PluginUtils/RealtimeSemaphore.h"
+#include "PluginUtils/FeatureValueCodec.h"
+#include "PluginUtils/AudioFeatureBinaryFormat.h"
+#include "PluginUtils/XmlStreamWriter.h"
+#include "PluginUtils/XmlStreamReader.h"
+#include "PluginUtils/SemanticDataStore.h"
+#include "PluginUtils/SemanticDataReader.h"
 #include "PluginUtils/SAFEFeatureExtractor.h"
 #include "PluginUtils/SAFEParameter.h"
 #include "PluginUtils/SAFEAudioProcessor.h"
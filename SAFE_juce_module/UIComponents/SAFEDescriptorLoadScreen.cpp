@@ -1,11 +1,12 @@
 //==========================================================================
 //      Constructor and Destructor
 //==========================================================================
-SAFEDescriptorLoadScreen::SAFEDescriptorLoadScreen (const String &pluginCodeInit)
+SAFEDescriptorLoadScreen::SAFEDescriptorLoadScreen (SAFEAudioProcessor &processorInit)
     : refreshButton (""),
       closeButton (""),
       loadButton (""),
-      pluginCode (pluginCodeInit)
+      processor (processorInit),
+      pluginCode (processorInit.getPluginCode())
 {
     // add the main title
     addAndMakeVisible (&titleLabel);
@@ -41,6 +42,7 @@ SAFEDescriptorLoadScreen::SAFEDescriptorLoadScreen (const String &pluginCodeInit
 
 SAFEDescriptorLoadScreen::~SAFEDescriptorLoadScreen()
 {
+    serverRequests->removeListener (this);
 }
 
 //==========================================================================
@@ -76,32 +78,36 @@ void SAFEDescriptorLoadScreen::listBoxItemDoubleClicked (int row, const MouseEve
 //==========================================================================
 //      Get Descriptors
 //==========================================================================
-void SAFEDescriptorLoadScreen::updateDescriptors (bool fromServer, const XmlElement* localSemanticDataElement)
+void SAFEDescriptorLoadScreen::updateDescriptors (bool fromServer, bool useCache)
 {
     getDataFromServer = fromServer;
-    localSemanticData = localSemanticDataElement;
-
-    allDescriptors.clear();
 
     if (fromServer)
     {
-        URL descriptorURL ("http://193.60.133.151/newsafe/listdescriptors.php");
-        descriptorURL = descriptorURL.withParameter ("Plugin", pluginCode);
-
-        String loadableDescriptors = descriptorURL.readEntireTextStream();
-        loadableDescriptors = loadableDescriptors.removeCharacters ("()[]{}<>");
-        allDescriptors.addTokens (loadableDescriptors, true);
+        // the list is empty until the server answers
+        setDescriptors (StringArray());
+        serverRequests->requestDescriptorList (pluginCode, this, useCache);
     }
-    else if (localSemanticDataElement)
+    else
     {
-        forEachXmlChildElement (*localSemanticDataElement, entry)
-        {
-            for (int i = 0; i < entry->getNumAttributes(); ++i)
-            {
-                allDescriptors.add (entry->getStringAttribute (String ("Descriptor") + String (i)));
-            }
-        }
+        // read the store again, other instances may have saved since the list was last shown
+        setDescriptors (processor.getLocalDescriptors());
     }
+}
+
+void SAFEDescriptorLoadScreen::descriptorListReceived (const String &pluginCodeReceived, const StringArray &descriptors, bool reachedServer)
+{
+    // the user may have switched to the local descriptors while we waited
+    if (getDataFromServer && pluginCodeReceived == pluginCode)
+    {
+        // without the server show what has been saved locally, loading falls back on it too
+        setDescriptors (reachedServer ? descriptors : processor.getLocalDescriptors());
+    }
+}
+
+void SAFEDescriptorLoadScreen::setDescriptors (const StringArray& descriptors)
+{
+    allDescriptors = descriptors;
     
     allDescriptors.removeEmptyStrings();
     allDescriptors.removeDuplicates (true);
@@ -127,7 +133,7 @@ void SAFEDescriptorLoadScreen::buttonClicked (Button *buttonThatWasClicked)
 {
     if (buttonThatWasClicked == &refreshButton)
     {
-        updateDescriptors (getDataFromServer, localSemanticData);
+        updateDescriptors (getDataFromServer, false);
     }
 }
 
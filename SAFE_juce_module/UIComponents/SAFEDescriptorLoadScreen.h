@@ -1,6 +1,8 @@
 #ifndef __SAFEDESCRIPTORLOADSCREEN__
 #define __SAFEDESCRIPTORLOADSCREEN__
 
+class SAFEAudioProcessor;
+
 /**
  *  The dialogue box for loading descriptors in the plug-ins.
  */
@@ -8,7 +10,8 @@ class SAFEDescriptorLoadScreen : public SAFEExtraScreen,
                                  public ListBoxModel,
                                  public Button::Listener,
                                  public TextEditor::Listener,
-                                 public KeyListener
+                                 public KeyListener,
+                                 public ServerRequestQueue::Listener
 {
 public:
     //==========================================================================
@@ -16,10 +19,11 @@ public:
     //==========================================================================
     /** Create a new descriptor load screen. 
      *
-     *  @param pluginCodeInit  the unique code of the plug-in this component
-     *                         is being used in
+     *  @param processorInit  the processor of the plug-in this component is
+     *                        being used in, the local descriptors are read
+     *                        from it
      */
-    SAFEDescriptorLoadScreen (const String &pluginCodeInit);
+    SAFEDescriptorLoadScreen (SAFEAudioProcessor &processorInit);
 
     /** Destructor */
     ~SAFEDescriptorLoadScreen();
@@ -41,13 +45,19 @@ public:
     //==========================================================================
     /** Update the list of descriptors.
      *
-     *  @param fromServer                if true the descriptor list will be populated
-     *                                   by the descriptors on the server otherwise the
-     *                                   local descriptor file will be used
-     *  @param localSemanticDataElement  a pointer to the XMLElement from the local descriptor 
-     *                                   file
+     *  The descriptors on the server are fetched in the background, the list
+     *  is filled in when they arrive.
+     *
+     *  @param fromServer  if true the descriptor list will be populated by the
+     *                     descriptors on the server otherwise the descriptors
+     *                     the processor has saved locally will be used
+     *  @param useCache    if false the server is asked for the descriptors
+     *                     again even if they were fetched recently
      */
-    void updateDescriptors (bool fromServer, const XmlElement* localSemanticDataElement);
+    void updateDescriptors (bool fromServer, bool useCache = true);
+
+    /** Implementation of function from ServerRequestQueue::Listener */
+    void descriptorListReceived (const String &pluginCodeReceived, const StringArray &descriptors, bool reachedServer);
 
     /** Returns the currently selected descriptor. */
     String getSelectedDescriptor();
@@ -88,10 +98,14 @@ private:
     SAFEButton refreshButton;
     String previousSearchTerm;
 
+    SAFEAudioProcessor &processor;
     String pluginCode;
 
     bool getDataFromServer;
-    const XmlElement *localSemanticData;
+
+    SharedResourcePointer <ServerRequestQueue> serverRequests;
+
+    void setDescriptors (const StringArray& descriptors);
 
     //==========================================================================
     //      Descriptor Search
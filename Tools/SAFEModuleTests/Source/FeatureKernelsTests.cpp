@@ -0,0 +1,234 @@
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Checks the fused kernels in FeatureKernels give the same results as the
+// libxtract functions they replace.
+
+namespace
+{
+    class FeatureKernelsTests : public UnitTest
+    {
+    public:
+        FeatureKernelsTests()
+            : UnitTest ("FeatureKernels"),
+              random (0x5afe)
+        {
+        }
+
+        void runTest() override
+        {
+            // lengths which leave every possible tail after the four sample vector loops
+            const int lengths [] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 64, 1023, 4096, 4099};
+            const int numLengths = sizeof (lengths) / sizeof (lengths [0]);
+
+            beginTest ("Temporal statistics match libxtract");
+
+            for (int i = 0; i < numLengths; ++i)
+            {
+                checkTemporalStatistics (lengths [i], false);
+            }
+
+            beginTest ("Temporal statistics match libxtract with zeros in the signal");
+
+            for (int i = 0; i < numLengths; ++i)
+            {
+                checkTemporalStatistics (lengths [i], true);
+            }
+
+            beginTest ("Temporal statistics of a DC signal");
+
+            for (int i = 0; i < numLengths; ++i)
+            {
+                checkConstantSignal (lengths [i]);
+            }
+
+            beginTest ("Spectral moments match libxtract");
+
+            for (int i = 0; i < numLengths; ++i)
+            {
+                if (lengths [i] > 1)
+                {
+                    checkSpectralMoments (lengths [i], 0);
+                }
+            }
+
+            beginTest ("Spectral moments of peak spectra match libxtract");
+
+            for (int numPeaks = 2; numPeaks <= 8; ++numPeaks)
+            {
+                checkSpectralMoments (2048, numPeaks);
+                checkSpectralMoments (2047, numPeaks);
+            }
+
+            beginTest ("Spectral moments of a single peak");
+
+            for (int i = 0; i < 100; ++i)
+            {
+                checkSinglePeak (2048);
+            }
+        }
+
+    private:
+        Random random;
+
+        void expectClose (double actual, double expected, double tolerance, const String &what)
+        {
+            const double error = std::abs (actual - expected);
+
+            expect (error <= tolerance * jmax (1.0, std::abs (expected)),
+                    what + ": got " + String (actual, 12) + ", libxtract gave " + String (expected, 12));
+        }
+
+        void checkTemporalStatistics (int numSamples, bool addZeros)
+        {
+            HeapBlock <float> data ((size_t) jmax (1, numSamples));
+            HeapBlock <double> doubleData ((size_t) jmax (1, numSamples));
+            HeapBlock <double> absoluteData ((size_t) jmax (1, numSamples));
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                data [i] = (addZeros && random.nextInt (4) == 0) ? 0.0f : random.nextFloat() * 2.0f - 1.0f;
+                doubleData [i] = data [i];
+                absoluteData [i] = std::abs (doubleData [i]);
+            }
+
+            FeatureKernels::TemporalStatistics statistics;
+            FeatureKernels::temporalStatistics (data, numSamples, statistics);
+
+            const String length = String (numSamples) + " samples";
+
+            // libxtract divides by the number of samples, so there is nothing to compare with
+            if (numSamples == 0)
+            {
+                expectEquals (statistics.mean, 0.0, length + " mean");
+                expectEquals (statistics.variance, 0.0, length + " variance");
+                expectEquals (statistics.standardDeviation, 0.0, length + " standard deviation");
+                expectEquals (statistics.rmsAmplitude, 0.0, length + " rms amplitude");
+                expectEquals (statistics.zeroCrossingRate, 0.0, length + " zero crossing rate");
+                expectEquals (statistics.peak, 0.0f, length + " peak");
+                return;
+            }
+
+            const double tolerance = 1.0e-9;
+            double mean, variance, standardDeviation, rmsAmplitude, zeroCrossingRate, peak;
+
+            xtract_mean (doubleData, numSamples, nullptr, &mean);
+            xtract_rms_amplitude (doubleData, numSamples, nullptr, &rmsAmplitude);
+            xtract_zcr (doubleData, numSamples, nullptr, &zeroCrossingRate);
+            xtract_highest_value (absoluteData, numSamples, nullptr, &peak);
+
+            expectClose (statistics.mean, mean, tolerance, length + " mean");
+            expectClose (statistics.rmsAmplitude, rmsAmplitude, tolerance, length + " rms amplitude");
+            expectClose (statistics.zeroCrossingRate, zeroCrossingRate, tolerance, length + " zero crossing rate");
+            expectEquals ((double) statistics.peak, peak, length + " peak");
+
+            // the sample variance of one sample divides by zero in libxtract, the kernel gives zero
+            if (numSamples == 1)
+            {
+                expectEquals (statistics.variance, 0.0, length + " variance");
+                expectEquals (statistics.standardDeviation, 0.0, length + " standard deviation");
+                return;
+            }
+
+            xtract_variance (doubleData, numSamples, &mean, &variance);
+            xtract_standard_deviation (doubleData, numSamples, &variance, &standardDeviation);
+
+            expectClose (statistics.variance, variance, tolerance, length + " variance");
+            expectClose (statistics.standardDeviation, standardDeviation, tolerance, length + " standard deviation");
+        }
+
+        void checkConstantSignal (int numSamples)
+        {
+            HeapBlock <float> data ((size_t) jmax (1, numSamples));
+            FloatVectorOperations::fill (data, 0.3f, numSamples);
+
+            FeatureKernels::TemporalStatistics statistics;
+            FeatureKernels::temporalStatistics (data, numSamples, statistics);
+
+            const String length = String (numSamples) + " samples";
+
+            // the variance comes from a difference of sums so it must not come out negative
+            expect (statistics.variance >= 0.0, length + " variance is negative");
+            expect (statistics.standardDeviation == statistics.standardDeviation, length + " standard deviation is NaN");
+            expectClose (statistics.standardDeviation, 0.0, 1.0e-6, length + " standard deviation");
+            expectEquals (statistics.zeroCrossingRate, 0.0, length + " zero crossing rate");
+        }
+
+        /** Fill a spectrum in the libxtract layout, amplitudes then frequencies.
+         *
+         *  With numPeaks of 0 every bin has some energy, otherwise only that many
+         *  bins do, like a peak or harmonic spectrum.
+         */
+        void fillSpectrum (double *spectrum, int numBins, int numPeaks)
+        {
+            const double binWidth = 44100.0 / (2 * numBins);
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                spectrum [bin] = numPeaks == 0 ? random.nextDouble() : 0.0;
+                spectrum [numBins + bin] = numPeaks == 0 ? bin * binWidth : 0.0;
+            }
+
+            // each peak gets its own stretch of the spectrum so they can't land on top of each other
+            for (int peak = 0; peak < numPeaks; ++peak)
+            {
+                const int bin = peak * (numBins / numPeaks) + random.nextInt (numBins / numPeaks);
+
+                spectrum [bin] = 0.1 + random.nextDouble();
+                spectrum [numBins + bin] = (bin + random.nextDouble() - 0.5) * binWidth;
+            }
+        }
+
+        void checkSpectralMoments (int numBins, int numPeaks)
+        {
+            HeapBlock <double> spectrum ((size_t) (2 * numBins));
+            fillSpectrum (spectrum, numBins, numPeaks);
+
+            FeatureKernels::SpectralMoments moments;
+            FeatureKernels::spectralMoments (spectrum, numBins, moments);
+
+            double centroid, variance, standardDeviation, skewness, kurtosis;
+
+            xtract_spectral_centroid (spectrum, 2 * numBins, nullptr, &centroid);
+            xtract_spectral_variance (spectrum, 2 * numBins, &centroid, &variance);
+            xtract_spectral_standard_deviation (spectrum, 2 * numBins, &variance, &standardDeviation);
+
+            double arguments [2] = {centroid, standardDeviation};
+            xtract_spectral_skewness (spectrum, 2 * numBins, arguments, &skewness);
+            xtract_spectral_kurtosis (spectrum, 2 * numBins, arguments, &kurtosis);
+
+            const String spectrumName = String (numBins) + " bins, " + String (numPeaks) + " peaks";
+            const double tolerance = 1.0e-6;
+
+            expectClose (moments.centroid, centroid, tolerance, spectrumName + " centroid");
+            expectClose (moments.variance, variance, tolerance, spectrumName + " variance");
+            expectClose (moments.standardDeviation, standardDeviation, tolerance, spectrumName + " standard deviation");
+            expectClose (moments.skewness, skewness, tolerance, spectrumName + " skewness");
+            expectClose (moments.kurtosis, kurtosis, tolerance, spectrumName + " kurtosis");
+        }
+
+        void checkSinglePeak (int numBins)
+        {
+            HeapBlock <double> spectrum ((size_t) (2 * numBins));
+            fillSpectrum (spectrum, numBins, 1);
+
+            FeatureKernels::SpectralMoments moments;
+            FeatureKernels::spectralMoments (spectrum, numBins, moments);
+
+            double centroid, variance;
+
+            xtract_spectral_centroid (spectrum, 2 * numBins, nullptr, &centroid);
+            xtract_spectral_variance (spectrum, 2 * numBins, &centroid, &variance);
+
+            expectClose (moments.centroid, centroid, 1.0e-9, "single peak centroid");
+            expectClose (moments.variance, variance, 1.0e-9, "single peak variance");
+
+            // libxtract divides zero by zero for the skewness and kurtosis here
+            expectEquals (moments.variance, 0.0, "single peak variance");
+            expectEquals (moments.standardDeviation, 0.0, "single peak standard deviation");
+            expectEquals (moments.skewness, 0.0, "single peak skewness");
+            expectEquals (moments.kurtosis, 0.0, "single peak kurtosis");
+        }
+    };
+
+    static FeatureKernelsTests featureKernelsTests;
+}
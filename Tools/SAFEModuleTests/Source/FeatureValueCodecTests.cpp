@@ -0,0 +1,241 @@
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <limits>
+
+// Checks compressed feature values come back within half a quantisation step,
+// both straight through the FeatureValueCodec and through the binary format.
+
+namespace
+{
+    class FeatureValueCodecTests : public UnitTest
+    {
+    public:
+        FeatureValueCodecTests()
+            : UnitTest ("FeatureValueCodec"),
+              random (0x5afe)
+        {
+        }
+
+        void runTest() override
+        {
+            const double steps [] = {1.0e-6, 1.0e-3, 0.5, 100.0};
+            const int numSteps = sizeof (steps) / sizeof (steps [0]);
+
+            beginTest ("Slowly changing features");
+
+            for (int i = 0; i < numSteps; ++i)
+            {
+                AudioFeatureStore store;
+                fillRandomWalk (store, 500, 1, 1);
+                checkRoundTrip (store, steps [i], "random walk, step " + String (steps [i]));
+            }
+
+            beginTest ("Features with different numbers of values");
+
+            for (int i = 0; i < numSteps; ++i)
+            {
+                AudioFeatureStore store;
+                fillRandomWalk (store, 500, 0, 24);
+                checkRoundTrip (store, steps [i], "varying value counts, step " + String (steps [i]));
+            }
+
+            beginTest ("Values which can't be quantised are stored raw");
+
+            for (int i = 0; i < numSteps; ++i)
+            {
+                AudioFeatureStore store;
+                fillSpecialValues (store);
+                checkRoundTrip (store, steps [i], "special values, step " + String (steps [i]));
+            }
+
+            beginTest ("Large residuals use the escape code");
+
+            for (int i = 0; i < numSteps; ++i)
+            {
+                AudioFeatureStore store;
+                fillJumps (store, steps [i]);
+                checkRoundTrip (store, steps [i], "jumps, step " + String (steps [i]));
+            }
+
+            beginTest ("Empty columns");
+
+            {
+                AudioFeatureStore store;
+                store.addColumn (1, 1);
+                store.allocate();
+                checkRoundTrip (store, 0.1, "no features");
+
+                store.addFeature (0, 0, 10, 0);
+                store.addFeature (0, 10, 10, 0);
+                checkRoundTrip (store, 0.1, "features without values");
+            }
+        }
+
+    private:
+        Random random;
+
+        //==========================================================================
+        void fillRandomWalk (AudioFeatureStore &store, int numFeatures, int minNumValues, int maxNumValues)
+        {
+            store.addColumn (numFeatures, maxNumValues);
+            store.allocate();
+
+            Array <double> previous;
+            previous.insertMultiple (0, 0.0, maxNumValues);
+
+            for (int feature = 0; feature < numFeatures; ++feature)
+            {
+                const int numValues = minNumValues + random.nextInt (maxNumValues - minNumValues + 1);
+                double *values = store.addFeature (0, feature * 10, 10, numValues);
+
+                for (int i = 0; i < numValues; ++i)
+                {
+                    previous.set (i, previous [i] + (random.nextDouble() - 0.5) * 4.0);
+                    values [i] = previous [i];
+                }
+            }
+        }
+
+        void fillSpecialValues (AudioFeatureStore &store)
+        {
+            const double specialValues [] = {std::numeric_limits <double>::quiet_NaN(),
+                                             std::numeric_limits <double>::infinity(),
+                                             -std::numeric_limits <double>::infinity(),
+                                             1.0e300, -1.0e300,
+                                             std::numeric_limits <double>::max()};
+            const int numSpecialValues = sizeof (specialValues) / sizeof (specialValues [0]);
+
+            store.addColumn (64, 8);
+            store.allocate();
+
+            // ordinary values either side, so the predictions carry on past the raw ones
+            for (int feature = 0; feature < 64; ++feature)
+            {
+                const int numValues = 1 + random.nextInt (8);
+                double *values = store.addFeature (0, feature * 10, 10, numValues);
+
+                for (int i = 0; i < numValues; ++i)
+                {
+                    values [i] = random.nextInt (3) == 0 ? specialValues [random.nextInt (numSpecialValues)]
+                                                         : random.nextDouble() * 10.0;
+                }
+            }
+        }
+
+        void fillJumps (AudioFeatureStore &store, double step)
+        {
+            store.addColumn (400, 1);
+            store.allocate();
+
+            // long runs of tiny residuals shrink the rice parameter, then each
+            // jump needs far more than the 24 leading ones the code allows
+            const double jumpSize = step * 1.0e9;
+            double value = 0.0;
+
+            for (int feature = 0; feature < 400; ++feature)
+            {
+                if (feature % 50 == 49)
+                {
+                    value += (random.nextBool() ? jumpSize : -jumpSize) * (1.0 + random.nextDouble());
+                }
+
+                value += (random.nextDouble() - 0.5) * step;
+                *store.addFeature (0, feature * 10, 10, 1) = value;
+            }
+        }
+
+        //==========================================================================
+        void checkRoundTrip (const AudioFeatureStore &store, double step, const String &what)
+        {
+            const AudioFeatureColumn features = store.getColumn (0);
+
+            // straight through the codec
+            MemoryOutputStream encoded;
+            FeatureValueCodec::encode (features, step, encoded);
+
+            HeapBlock <double> decoded ((size_t) jmax (1, features.getValueOffsets() [features.size()]));
+
+            expect (FeatureValueCodec::decode (encoded.getData(), encoded.getDataSize(), step,
+                                               features.getValueOffsets(), features.size(), decoded),
+                    what + ": the codec couldn't decode its own output");
+
+            for (int feature = 0; feature < features.size(); ++feature)
+            {
+                checkValues (features.getValues (feature), decoded + features.getValueOffsets() [feature],
+                             features.getNumValues (feature), step, what + ", codec");
+            }
+
+            // and through the binary format, which stores the step as twice the precision
+            AudioFeatureBinaryFormat::FeatureSetInfo info;
+            info.name = "Feature";
+            info.frameSize = 512;
+            info.stepSize = 256;
+            info.channel = 0;
+            info.precision = step / 2.0;
+
+            AudioFeatureBinaryFormat::Writer writer;
+            writer.addFeatureSet (info, features);
+
+            MemoryOutputStream written;
+            expect (writer.write (written, AudioFeatureBinaryFormat::CompressedValues), what + ": couldn't write the features");
+            expectEquals ((int64) written.getDataSize(), writer.getNumBytes (AudioFeatureBinaryFormat::CompressedValues),
+                          what + ": getNumBytes() doesn't match what was written");
+
+            MemoryInputStream input (written.getData(), written.getDataSize(), false);
+            AudioFeatureBinaryFormat::Reader reader;
+
+            if (! reader.read (input))
+            {
+                expect (false, what + ": couldn't read the features back");
+                return;
+            }
+
+            expectEquals (reader.getNumFeatureSets(), 1, what + ": number of feature sets");
+
+            const AudioFeatureColumn readFeatures = reader.getFeatures (0);
+            expectEquals (readFeatures.size(), features.size(), what + ": number of features");
+
+            if (readFeatures.size() != features.size())
+            {
+                return;
+            }
+
+            for (int feature = 0; feature < features.size(); ++feature)
+            {
+                expectEquals (readFeatures.getTimeStamp (feature), features.getTimeStamp (feature), what + ": time stamp");
+                expectEquals (readFeatures.getNumValues (feature), features.getNumValues (feature), what + ": number of values");
+
+                if (readFeatures.getNumValues (feature) == features.getNumValues (feature))
+                {
+                    checkValues (features.getValues (feature), readFeatures.getValues (feature),
+                                 features.getNumValues (feature), step, what + ", binary format");
+                }
+            }
+        }
+
+        void checkValues (const double *original, const double *decoded, int numValues, double step, const String &what)
+        {
+            const double maxQuantisedValue = 4503599627370496.0;
+
+            for (int i = 0; i < numValues; ++i)
+            {
+                // anything the codec can't quantise has to come back exactly
+                if (! (std::abs (original [i] / step) < maxQuantisedValue))
+                {
+                    expect (memcmp (original + i, decoded + i, sizeof (double)) == 0,
+                            what + ": " + String (original [i]) + " wasn't stored raw, got " + String (decoded [i]));
+                    continue;
+                }
+
+                // allow for the rounding of the multiply by the step
+                const double error = std::abs (decoded [i] - original [i]);
+                const double allowed = step / 2.0 + std::abs (original [i]) * 4.0 * std::numeric_limits <double>::epsilon();
+
+                expect (error <= allowed,
+                        what + ": " + String (original [i], 12) + " came back as " + String (decoded [i], 12)
+                             + ", more than half a step out");
+            }
+        }
+    };
+
+    static FeatureValueCodecTests featureValueCodecTests;
+}
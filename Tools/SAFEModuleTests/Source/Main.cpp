@@ -0,0 +1,39 @@
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <iostream>
+
+// Runs the unit tests for the SAFE module. The tests are the UnitTest objects
+// in the other files of this project, they register themselves when the
+// program starts. It returns 1 if any check failed, so it can be used in a
+// build script.
+
+namespace
+{
+    class ConsoleTestRunner : public UnitTestRunner
+    {
+    public:
+        void logMessage (const String &message) override
+        {
+            std::cout << message << std::endl;
+        }
+    };
+}
+
+int main (int /*argc*/, char* /*argv*/[])
+{
+    // some of the tests need a message thread to get their results back on
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    ConsoleTestRunner runner;
+    runner.runAllTests();
+
+    int numFailures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+    {
+        numFailures += runner.getResult (i)->failures;
+    }
+
+    std::cout << std::endl << (numFailures == 0 ? String ("All tests passed") : String (numFailures) + " checks failed") << std::endl;
+
+    return numFailures > 0 ? 1 : 0;
+}
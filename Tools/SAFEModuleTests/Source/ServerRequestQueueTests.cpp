@@ -0,0 +1,142 @@
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "StubServer.h"
+
+// Checks the ServerRequestQueue against a stub server on the loopback
+// interface: requests for the same thing are joined, cached answers run out
+// and failures aren't cached.
+
+namespace
+{
+    /** Keeps the last descriptor list it was sent. */
+    class ResultListener : public ServerRequestQueue::Listener
+    {
+    public:
+        ResultListener()
+            : numResults (0),
+              reachedServer (false)
+        {
+        }
+
+        void descriptorListReceived (const String& /*pluginCode*/, const StringArray &newDescriptors,
+                                     bool newReachedServer) override
+        {
+            ++numResults;
+            descriptors = newDescriptors;
+            reachedServer = newReachedServer;
+        }
+
+        int numResults;
+        StringArray descriptors;
+        bool reachedServer;
+    };
+
+    //==========================================================================
+    class ServerRequestQueueTests : public UnitTest
+    {
+    public:
+        ServerRequestQueueTests()
+            : UnitTest ("ServerRequestQueue")
+        {
+        }
+
+        void runTest() override
+        {
+            const String pluginCode = "Test";
+            const String path = "/listdescriptors.php";
+
+            StubServer server;
+
+            beginTest ("Starting the stub server");
+
+            if (! server.start())
+            {
+                expect (false, "couldn't listen on any port");
+                return;
+            }
+
+            server.setResponse (path, "warm bright punchy");
+
+            ResultListener first, second, third;
+            ServerRequestQueue queue (server.getURL());
+            queue.setCacheTime (60000);
+
+            beginTest ("Requests for the same thing are joined");
+
+            server.setResponseDelay (500);
+            queue.requestDescriptorList (pluginCode, &first);
+
+            // the first request is waiting on the server by now
+            pumpMessages (100);
+            queue.requestDescriptorList (pluginCode, &second);
+
+            expect (waitForResults (first, 1) && waitForResults (second, 1), "the results didn't arrive");
+            expectEquals (server.getNumRequests (path), 1, "requests to the server");
+            expect (first.reachedServer && second.reachedServer, "the server wasn't reached");
+            expectEquals (first.descriptors.joinIntoString (" "), String ("warm bright punchy"), "first descriptors");
+            expectEquals (second.descriptors.joinIntoString (" "), String ("warm bright punchy"), "second descriptors");
+
+            server.setResponseDelay (0);
+
+            beginTest ("Cached results are used until they run out");
+
+            queue.requestDescriptorList (pluginCode, &third);
+
+            expect (waitForResults (third, 1), "the cached result didn't arrive");
+            expectEquals (server.getNumRequests (path), 1, "requests to the server with a cached result");
+            expect (third.reachedServer, "cached results count as reaching the server");
+
+            queue.setCacheTime (300);
+            pumpMessages (500);
+            queue.requestDescriptorList (pluginCode, &third);
+
+            expect (waitForResults (third, 2), "the result didn't arrive");
+            expectEquals (server.getNumRequests (path), 2, "requests to the server after the cache ran out");
+
+            beginTest ("Failures aren't cached");
+
+            queue.setCacheTime (60000);
+            queue.clearCache();
+            server.setStatusCode (500);
+
+            queue.requestDescriptorList (pluginCode, &first);
+
+            expect (waitForResults (first, 2), "the failure wasn't reported");
+            expect (! first.reachedServer, "a server error counted as reaching the server");
+            expectEquals (first.descriptors.size(), 0, "descriptors from a failed request");
+            expectEquals (server.getNumRequests (path), 3, "requests to the failing server");
+
+            server.setStatusCode (200);
+            queue.requestDescriptorList (pluginCode, &first);
+
+            expect (waitForResults (first, 3), "the result didn't arrive");
+            expectEquals (server.getNumRequests (path), 4, "requests to the server after a failure");
+            expect (first.reachedServer, "the server wasn't reached after a failure");
+            expectEquals (first.descriptors.size(), 3, "descriptors after a failure");
+
+            queue.removeListener (&first);
+            queue.removeListener (&second);
+            queue.removeListener (&third);
+        }
+
+    private:
+        static void pumpMessages (int milliseconds)
+        {
+            MessageManager::getInstance()->runDispatchLoopUntil (milliseconds);
+        }
+
+        /** The results come back on the message thread, so keep it running until they do. */
+        static bool waitForResults (const ResultListener &listener, int numResults)
+        {
+            const uint32 timeOut = Time::getMillisecondCounter() + 10000;
+
+            while (listener.numResults < numResults && Time::getMillisecondCounter() < timeOut)
+            {
+                pumpMessages (20);
+            }
+
+            return listener.numResults >= numResults;
+        }
+    };
+
+    static ServerRequestQueueTests serverRequestQueueTests;
+}
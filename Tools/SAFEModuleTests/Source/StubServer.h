@@ -0,0 +1,205 @@
+#ifndef __STUBSERVER__
+#define __STUBSERVER__
+
+/**
+ *  A tiny http server on the loopback interface for the tests to talk to.
+ *
+ *  Every request gets the same status code and the response set for its
+ *  path. The requests are counted by path, and any body is read before the
+ *  answer is sent so uploads finish cleanly.
+ */
+class StubServer : public Thread
+{
+public:
+    StubServer()
+        : Thread ("StubServer"),
+          port (0)
+    {
+        statusCode.set (200);
+    }
+
+    ~StubServer()
+    {
+        stop();
+    }
+
+    /** Start listening on the first free port it can find. */
+    bool start()
+    {
+        for (int portToTry = 50123; portToTry < 50223; ++portToTry)
+        {
+            if (listener.createListener (portToTry, "127.0.0.1"))
+            {
+                port = portToTry;
+                startThread();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /** Stop listening, connections to the port are refused after this. */
+    void stop()
+    {
+        // closing the listener wakes the thread up
+        listener.close();
+        stopThread (4000);
+    }
+
+    String getURL() const
+    {
+        return "http://127.0.0.1:" + String (port) + "/";
+    }
+
+    void setResponse (const String &path, const String &body)
+    {
+        const ScopedLock sl (lock);
+        responses.set (path, body);
+    }
+
+    /** Hold each response back for a while, so requests can pile up. */
+    void setResponseDelay (int milliseconds)
+    {
+        responseDelay.set (milliseconds);
+    }
+
+    /** Set the status every request is answered with, 200 by default. */
+    void setStatusCode (int newStatusCode)
+    {
+        statusCode.set (newStatusCode);
+    }
+
+    int getNumRequests (const String &path) const
+    {
+        const ScopedLock sl (lock);
+        return requestCounts [path];
+    }
+
+private:
+    StreamingSocket listener;
+    int port;
+
+    CriticalSection lock;
+    HashMap <String, String> responses;
+    HashMap <String, int> requestCounts;
+    Atomic <int> responseDelay, statusCode;
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            ScopedPointer <StreamingSocket> connection (listener.waitForNextConnection());
+
+            if (connection == nullptr)
+            {
+                return;
+            }
+
+            handleConnection (*connection);
+        }
+    }
+
+    void handleConnection (StreamingSocket &connection)
+    {
+        MemoryOutputStream received;
+        int headerSize = -1;
+        int64 contentLength = 0;
+        char buffer [4096];
+
+        // the headers, then as much body as they say there is
+        while (headerSize < 0 || (int64) received.getDataSize() < headerSize + contentLength)
+        {
+            if (connection.waitUntilReady (true, 2000) != 1)
+            {
+                return;
+            }
+
+            const int numBytes = connection.read (buffer, sizeof (buffer), false);
+
+            if (numBytes <= 0)
+            {
+                return;
+            }
+
+            received.write (buffer, (size_t) numBytes);
+
+            if (headerSize < 0)
+            {
+                headerSize = findEndOfHeaders (received);
+
+                if (headerSize >= 0)
+                {
+                    contentLength = getContentLength (String::fromUTF8 (static_cast <const char*> (received.getData()), headerSize));
+                }
+            }
+        }
+
+        // "POST /upload.php HTTP/1.1" or "GET /listdescriptors.php?Plugin=TEST HTTP/1.1"
+        const String path = String::fromUTF8 (static_cast <const char*> (received.getData()), headerSize)
+                                .upToFirstOccurrenceOf ("\r\n", false, false)
+                                .fromFirstOccurrenceOf (" ", false, false)
+                                .upToFirstOccurrenceOf (" ", false, false)
+                                .upToFirstOccurrenceOf ("?", false, false);
+        String body;
+
+        {
+            const ScopedLock sl (lock);
+            requestCounts.set (path, requestCounts [path] + 1);
+            body = responses [path];
+        }
+
+        Thread::sleep (responseDelay.get());
+
+        const int status = statusCode.get();
+
+        if (status < 200 || status >= 300)
+        {
+            body = "Error " + String (status);
+        }
+
+        const String reply = "HTTP/1.0 " + String (status) + " Stub\r\n"
+                           + "Content-Type: text/plain\r\n"
+                           + "Content-Length: " + String ((int) body.getNumBytesAsUTF8()) + "\r\n"
+                           + "Connection: close\r\n\r\n"
+                           + body;
+
+        connection.write (reply.toRawUTF8(), (int) reply.getNumBytesAsUTF8());
+    }
+
+    /** Returns the size of the headers including the blank line, or -1 if they haven't all arrived. */
+    static int findEndOfHeaders (const MemoryOutputStream &data)
+    {
+        const char *bytes = static_cast <const char*> (data.getData());
+
+        for (int i = 3; i < (int) data.getDataSize(); ++i)
+        {
+            if (bytes [i - 3] == '\r' && bytes [i - 2] == '\n' && bytes [i - 1] == '\r' && bytes [i] == '\n')
+            {
+                return i + 1;
+            }
+        }
+
+        return -1;
+    }
+
+    static int64 getContentLength (const String &headers)
+    {
+        StringArray lines;
+        lines.addLines (headers);
+
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            if (lines [i].startsWithIgnoreCase ("Content-Length:"))
+            {
+                return jmax ((int64) 0, lines [i].fromFirstOccurrenceOf (":", false, false).trim().getLargeIntValue());
+            }
+        }
+
+        return 0;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (StubServer)
+};
+
+#endif // __STUBSERVER__
@@ -0,0 +1,186 @@
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "StubServer.h"
+
+// Checks what the UploadSpool does with a record for each kind of answer
+// from a stub server on the loopback interface: records the server takes are
+// deleted, records it refuses are moved aside, and anything else is kept and
+// sent again.
+
+namespace
+{
+    class UploadSpoolTests : public UnitTest
+    {
+    public:
+        UploadSpoolTests()
+            : UnitTest ("UploadSpool")
+        {
+        }
+
+        void runTest() override
+        {
+            StubServer server;
+
+            beginTest ("Starting the stub server");
+
+            if (! server.start())
+            {
+                expect (false, "couldn't listen on any port");
+                return;
+            }
+
+            const String uploadURL = server.getURL() + "upload.php";
+            int numUploads = 0;
+
+            beginTest ("Records the server takes are deleted");
+
+            {
+                TestSpool spool (uploadURL);
+                spool->addRecord (makeRecord());
+
+                expect (waitUntilEmpty (*spool), "the record wasn't sent");
+                expectEquals (server.getNumRequests (path), ++numUploads, "uploads");
+                expectEquals (spool.getNumRejected(), 0, "rejected records");
+            }
+
+            beginTest ("Records the server refuses are moved aside");
+
+            {
+                const int refusals [] = {400, 403, 404, 413};
+
+                for (int i = 0; i < (int) (sizeof (refusals) / sizeof (refusals [0])); ++i)
+                {
+                    server.setStatusCode (refusals [i]);
+
+                    TestSpool spool (uploadURL);
+                    spool->addRecord (makeRecord());
+
+                    expect (waitUntilEmpty (*spool), "the record wasn't taken out of the spool after a " + String (refusals [i]));
+                    expectEquals (server.getNumRequests (path), ++numUploads, "uploads");
+                    expectEquals (spool.getNumRejected(), 1, "rejected records after a " + String (refusals [i]));
+                }
+            }
+
+            beginTest ("Records are kept and sent again after a failure");
+
+            {
+                const int failures [] = {500, 503, 408, 429};
+
+                for (int i = 0; i < (int) (sizeof (failures) / sizeof (failures [0])); ++i)
+                {
+                    server.setStatusCode (failures [i]);
+
+                    TestSpool spool (uploadURL);
+                    spool->addRecord (makeRecord());
+
+                    // the first try and at least one retry
+                    expect (waitForUploads (server, numUploads + 2), "the record wasn't sent again after a " + String (failures [i]));
+                    expectEquals (spool->getNumRecords(), 1, "records in the spool after a " + String (failures [i]));
+                    expectEquals (spool.getNumRejected(), 0, "rejected records after a " + String (failures [i]));
+
+                    // once the server takes it, it goes
+                    server.setStatusCode (200);
+
+                    expect (waitUntilEmpty (*spool), "the record wasn't sent once the server recovered");
+                    expectEquals (spool.getNumRejected(), 0, "rejected records once the server recovered");
+
+                    numUploads = server.getNumRequests (path);
+                }
+            }
+
+            beginTest ("Records are kept and sent again when the server can't be reached");
+
+            {
+                server.stop();
+
+                TestSpool spool (uploadURL);
+                spool->addRecord (makeRecord());
+
+                // long enough for a few connection attempts to be refused
+                Thread::sleep (1000);
+
+                expectEquals (spool->getNumRecords(), 1, "records in the spool without a server");
+                expectEquals (spool.getNumRejected(), 0, "rejected records without a server");
+
+                StubServer newServer;
+                expect (newServer.start(), "couldn't listen on any port");
+
+                spool->setServerURL (newServer.getURL() + "upload.php");
+
+                expect (waitUntilEmpty (*spool), "the record wasn't sent once there was a server");
+                expectEquals (newServer.getNumRequests (path), 1, "uploads once there was a server");
+                expectEquals (spool.getNumRejected(), 0, "rejected records once there was a server");
+            }
+        }
+
+    private:
+        static const char* const path;
+
+        /** A spool in a directory of its own which retries quickly, deleted afterwards. */
+        class TestSpool
+        {
+        public:
+            TestSpool (const String &url)
+                : directory (File::getSpecialLocation (File::tempDirectory).getChildFile ("SAFEUploadSpoolTests")
+                                                                            .getNonexistentSibling (false))
+            {
+                spool = new UploadSpool (directory, url);
+                spool->setRetryDelays (100, 200);
+                spool->setCompressionEnabled (false);
+            }
+
+            ~TestSpool()
+            {
+                spool = nullptr;
+                directory.deleteRecursively();
+            }
+
+            UploadSpool* operator->() const     { return spool; }
+            UploadSpool& operator*() const      { return *spool; }
+
+            int getNumRejected() const
+            {
+                return directory.getChildFile ("Rejected").getNumberOfChildFiles (File::findFiles);
+            }
+
+        private:
+            File directory;
+            ScopedPointer <UploadSpool> spool;
+
+            JUCE_DECLARE_NON_COPYABLE (TestSpool)
+        };
+
+        static MemoryBlock makeRecord()
+        {
+            const String record = "<SemanticData Descriptors=\"warm\"/>";
+            return MemoryBlock (record.toRawUTF8(), record.getNumBytesAsUTF8());
+        }
+
+        static bool waitUntilEmpty (const UploadSpool &spool)
+        {
+            const uint32 timeOut = Time::getMillisecondCounter() + 10000;
+
+            while (spool.getNumRecords() > 0 && Time::getMillisecondCounter() < timeOut)
+            {
+                Thread::sleep (20);
+            }
+
+            return spool.getNumRecords() == 0;
+        }
+
+        static bool waitForUploads (const StubServer &server, int numUploads)
+        {
+            const uint32 timeOut = Time::getMillisecondCounter() + 10000;
+
+            while (server.getNumRequests (path) < numUploads && Time::getMillisecondCounter() < timeOut)
+            {
+                Thread::sleep (20);
+            }
+
+            return server.getNumRequests (path) >= numUploads;
+        }
+    };
+
+    const char* const UploadSpoolTests::path = "/upload.php";
+
+    static UploadSpoolTests uploadSpoolTests;
+}
@@ -0,0 +1,140 @@
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <iostream>
+
+// Converts the xml data files written by older versions of the SAFE plug-ins
+// into the record store the plug-ins use now. Each file is streamed in a record
+// at a time, so files of any size can be converted.
+//
+// By default each <Plugin>Data.xml file becomes a <Plugin>Data.records file next
+// to it, which is where the plug-ins look for their data. Use --output to put the
+// records from all the files into one store instead.
+//
+// A converted file is renamed <name>Imported.xml, and one which can't be parsed
+// <name>ImportFailed.xml, the same as when a plug-in imports it, so neither the
+// plug-in nor this tool reads it again.
+//
+// Don't run this on a plug-in's files while the plug-in is running.
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Usage: SemanticDataConverter [--output <store.records>] <file.xml | directory>..." << std::endl
+                  << std::endl
+                  << "Converts SAFE xml data files into record stores. Directories are" << std::endl
+                  << "searched for xml files. Each file is converted to a .records file" << std::endl
+                  << "next to it unless an output store is given. Converted files are" << std::endl
+                  << "renamed so they aren't converted again." << std::endl;
+    }
+
+    void addXmlFiles (const String &argument, Array <File> &xmlFiles)
+    {
+        File file = File::getCurrentWorkingDirectory().getChildFile (argument);
+
+        if (file.isDirectory())
+        {
+            Array <File> childFiles;
+            file.findChildFiles (childFiles, File::findFiles, false, "*.xml");
+
+            // skip the files which have already been converted
+            for (int i = 0; i < childFiles.size(); ++i)
+            {
+                if (! SemanticDataStore::isMigratedXmlFile (childFiles.getReference (i)))
+                {
+                    xmlFiles.add (childFiles.getReference (i));
+                }
+            }
+        }
+        else
+        {
+            xmlFiles.add (file);
+        }
+    }
+
+    bool convertFile (const File &xmlFile, const File &storeFile)
+    {
+        if (! xmlFile.existsAsFile())
+        {
+            std::cerr << xmlFile.getFullPathName() << " doesn't exist" << std::endl;
+            return false;
+        }
+
+        SemanticDataStore store;
+
+        if (! store.open (storeFile))
+        {
+            std::cerr << "Couldn't open " << storeFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        // nothing else is using the store, the lock is only there for migrateXmlFile()
+        CriticalSection storeLock;
+
+        const double startTime = Time::getMillisecondCounterHiRes();
+        const int numRecords = store.migrateXmlFile (xmlFile, storeLock);
+
+        if (numRecords < 0)
+        {
+            std::cerr << "Couldn't convert " << xmlFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        std::cout << xmlFile.getFullPathName() << ": " << numRecords << " records added to "
+                  << storeFile.getFullPathName() << " in "
+                  << String ((Time::getMillisecondCounterHiRes() - startTime) / 1000.0, 2) << "s" << std::endl;
+
+        return true;
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    StringArray arguments (argv + 1, argc - 1);
+
+    File outputFile;
+    Array <File> xmlFiles;
+
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        if (arguments [i] == "--help" || arguments [i] == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (arguments [i] == "--output" || arguments [i] == "-o")
+        {
+            if (++i == arguments.size())
+            {
+                printUsage();
+                return 1;
+            }
+
+            outputFile = File::getCurrentWorkingDirectory().getChildFile (arguments [i]);
+        }
+        else
+        {
+            addXmlFiles (arguments [i], xmlFiles);
+        }
+    }
+
+    if (xmlFiles.size() == 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    int numFailed = 0;
+
+    for (int i = 0; i < xmlFiles.size(); ++i)
+    {
+        const File &xmlFile = xmlFiles.getReference (i);
+        File storeFile = outputFile != File::nonexistent ? outputFile : xmlFile.withFileExtension ("records");
+
+        if (! convertFile (xmlFile, storeFile))
+        {
+            ++numFailed;
+        }
+    }
+
+    return numFailed > 0 ? 1 : 0;
+}